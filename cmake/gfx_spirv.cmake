@@ -0,0 +1,51 @@
+# offline shader compilation, glslangValidator turns the glsl into SPIR-V for OpenGL, spirv-val validates the
+# module and spirv-opt optimizes it. the last two steps are skipped when the tools aren't installed
+find_program(GLSLANG_VALIDATOR glslangValidator HINTS $ENV{VULKAN_SDK}/bin)
+find_program(SPIRV_VAL spirv-val HINTS $ENV{VULKAN_SDK}/bin)
+find_program(SPIRV_OPT spirv-opt HINTS $ENV{VULKAN_SDK}/bin)
+
+# gfx_compile_spirv(<target> OUTPUT_DIR <dir> SOURCES <files>...)
+# adds a target building <dir>/<file name>.spv from every source, the stage comes from the extension
+# (.vert, .geom, .frag...), the target does nothing without glslangValidator so apps need a glsl fallback
+function(gfx_compile_spirv TARGET)
+	cmake_parse_arguments(ARG "" "OUTPUT_DIR" "SOURCES" ${ARGN})
+
+	if (NOT GLSLANG_VALIDATOR)
+		message(STATUS "glslangValidator not found, ${TARGET} doesn't build SPIR-V modules")
+		add_custom_target(${TARGET})
+		return()
+	endif ()
+
+	set(OUTPUTS)
+	foreach (SOURCE ${ARG_SOURCES})
+		get_filename_component(NAME ${SOURCE} NAME)
+		set(OUTPUT ${ARG_OUTPUT_DIR}/${NAME}.spv)
+		set(UNOPTIMIZED ${ARG_OUTPUT_DIR}/${NAME}.unopt.spv)
+
+		set(COMMANDS
+			COMMAND ${CMAKE_COMMAND} -E make_directory ${ARG_OUTPUT_DIR}
+			COMMAND ${GLSLANG_VALIDATOR} -G -o ${UNOPTIMIZED} ${SOURCE}
+		)
+
+		if (SPIRV_VAL)
+			list(APPEND COMMANDS COMMAND ${SPIRV_VAL} --target-env opengl4.5 ${UNOPTIMIZED})
+		endif ()
+
+		if (SPIRV_OPT)
+			list(APPEND COMMANDS COMMAND ${SPIRV_OPT} -O ${UNOPTIMIZED} -o ${OUTPUT})
+		else ()
+			list(APPEND COMMANDS COMMAND ${CMAKE_COMMAND} -E copy ${UNOPTIMIZED} ${OUTPUT})
+		endif ()
+
+		add_custom_command(
+			OUTPUT ${OUTPUT}
+			${COMMANDS}
+			DEPENDS ${SOURCE}
+			COMMENT "Compiling ${NAME} to SPIR-V"
+			VERBATIM
+		)
+		list(APPEND OUTPUTS ${OUTPUT})
+	endforeach ()
+
+	add_custom_target(${TARGET} ALL DEPENDS ${OUTPUTS})
+endfunction ()
\ No newline at end of file
@@ -89,9 +89,10 @@ init()
 
 	// clang-format on
 
-	auto image = std::make_shared<gfx::Image>(textureData, 8, 4);
+	// the texture is uploaded straight from the array, no image copy is needed
+	gfx::ImageView image(textureData, 8, 1, 4);
 	texture1d_id = gfx_backend->createTexture1D(
-		image.get(),
+		image,
 		gfx::Wrapping_Mode::REPEAT,
 		gfx::Filtering_Mode::NEAREST,
 		gfx::Filtering_Mode::NEAREST);
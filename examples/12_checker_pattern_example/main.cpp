@@ -3,6 +3,7 @@
 #include <iostream>
 
 #include "gfx.h"
+#include "gfx_shader_preprocessor.h"
 
 #include <imgui.h>
 
@@ -112,24 +113,11 @@ const char* fragmentShader =
 		uniform vec3 color1; // white
 		uniform vec3 color2; // black
 
+		#include "gfx/checker.glsl"
+
 		void main()
 		{
-			// Scale the checker pattern
-			vec2 pos = TexCoord * scale;
-
-			// Create a checker pattern
-			float checker = step(0.5, mod(floor(pos.x) + floor(pos.y), 2.0));
-
-			// Calculate the distance to the edges
-			float distToEdgeX = abs(fract(pos.x));
-			float distToEdgeY = abs(fract(pos.y));
-			float edgeDistance = min(distToEdgeX, distToEdgeY);
-
-			// Smooth the transition with a simple step function
-			float smoothing = smoothstep(0.0, 0.01, edgeDistance); // Adjust the second parameter for more or less smoothing
-
-			// Mix colors based on the checker pattern and smoothing
-			FragColor = vec4(mix(color1, color2, mix(checker, 1.0 - checker, smoothing)), 1.0);
+			FragColor = checker(TexCoord, scale, color1, color2);
 		})";
 
 	float vertices[] = {
@@ -229,8 +217,10 @@ init()
 
 	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, index_buffer_id, attributes);
 
-	// build and compile our shader program
-	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
+	// build and compile our shader program, the checker pattern comes from the shader library
+	gfx::ShaderPreprocessor preprocessor;
+	auto& fs = preprocessor.process(fragmentShader, {}, "checker_pattern.frag");
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fs.c_str());
 
 	// initialize projection matrix
 	projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 10000.0f);
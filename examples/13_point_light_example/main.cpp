@@ -1,4 +1,7 @@
 #include "gfx.h"
+#include "gfx_shader_preprocessor.h"
+#include "gfx_parameter_block.h"
+#include "gfx_shader_variants.h"
 
 #include <imgui.h>
 #include <iostream>
@@ -18,6 +21,11 @@ glm::vec3 cameraTarget(0, 7.3f, 0);
 
 uint32_t gpu_program;
 
+// the checker pattern is compiled in or out instead of branching on a uniform
+gfx::ShaderPreprocessor shader_preprocessor;
+std::shared_ptr<gfx::ShaderVariants> shader_variants;
+uint32_t checker_variant;
+
 glm::vec3 point_light_pos(20, 50, 9);
 float point_light_power = 1000;
 
@@ -61,39 +69,23 @@ const char* fragmentShader =
 		uniform vec3 lightColor;   // Color of the light
 		uniform float lightPower;  // Power of the light
 
-		uniform bool use_checker_texture;
-		uniform float scale; // Adjust this value for larger/smaller squares
-		uniform vec3 color1; // white
-		uniform vec3 color2; // black
-
-		vec4 checker(vec2 _TexCoord, float _scale, vec3 _color1, vec3 _color2)
+		// static per material, uploaded once by a ParameterBlock
+		layout(std140, binding = 0) uniform Material
 		{
-			// Scale the checker pattern
-			vec2 pos = _TexCoord * _scale;
-
-			// Create a checker pattern
-			float checker = step(0.5, mod(floor(pos.x) + floor(pos.y), 2.0));
-
-			// Calculate the distance to the edges
-			float distToEdgeX = abs(fract(pos.x));
-			float distToEdgeY = abs(fract(pos.y));
-			float edgeDistance = min(distToEdgeX, distToEdgeY);
-
-			// Smooth the transition with a simple step function
-			float smoothing = smoothstep(0.0, 0.01, edgeDistance); // Adjust the second parameter for more or less smoothing
+			vec3 color1;
+			float scale; // Adjust this value for larger/smaller squares
+			vec3 color2;
+		};
 
-			// Mix colors based on the checker pattern and smoothing
-			return vec4(mix(_color1, _color2, mix(checker, 1.0 - checker, smoothing)), 1.0);
-		}
+		#include "gfx/checker.glsl"
 
 		void main()
 		{
 			vec4 final_col = vec4(1.0,1.0,1.0,1.0);
 
-			if(use_checker_texture)
-			{
+			#ifdef USE_CHECKER_TEXTURE
 				final_col = checker(TexCoord, scale, color1, color2);
-			}
+			#endif
 	
 				// Normalize the normal vector
 				vec3 norm = normalize(fragNormal);
@@ -135,6 +127,22 @@ const char* fragmentShader =
 
 // clang-format on
 
+// binds the variant for the next draw, the uniforms shared by every draw go to each variant
+inline static void
+_bind_variant(uint32_t variant)
+{
+	gpu_program = shader_variants->getProgram(variant);
+	gfx_backend->bindGPUProgram(gpu_program);
+
+	gfx_backend->setGPUProgramMat4(gpu_program, "view", view);
+	gfx_backend->setGPUProgramMat4(gpu_program, "projection", projection);
+
+	gfx_backend->setGPUProgramVec3(gpu_program, "lightPos", point_light_pos);
+	gfx_backend->setGPUProgramVec3(gpu_program, "viewPos", cameraPosition);
+	gfx_backend->setGPUProgramVec3(gpu_program, "lightColor", glm::vec3(1, 1, 1));
+	gfx_backend->setGPUProgramFloat(gpu_program, "lightPower", point_light_power);
+}
+
 class Cyclorama
 {
 public:
@@ -304,6 +312,12 @@ public:
 		scale_val = 40.0f;
 		color1 = glm::vec3(1.0f, 1.0f, 1.0f);
 		color2 = glm::vec3(0.8f, 0.8f, 0.8f);
+
+		// the material never changes, apply uploads it once and only binds its buffer afterwards
+		material = std::make_shared<gfx::ParameterBlock>(shader_variants->getProgram(checker_variant), "Material");
+		material->setFloat("scale", scale_val);
+		material->setVec3("color1", color1);
+		material->setVec3("color2", color2);
 	}
 
 	~Cyclorama() {}
@@ -311,12 +325,10 @@ public:
 	void
 	draw()
 	{
+		_bind_variant(checker_variant);
 		gfx_backend->setGPUProgramMat4(gpu_program, "model", model);
 
-		gfx_backend->setGPUProgramInt(gpu_program, "use_checker_texture", 1);
-		gfx_backend->setGPUProgramFloat(gpu_program, "scale", scale_val);
-		gfx_backend->setGPUProgramVec3(gpu_program, "color1", color1);
-		gfx_backend->setGPUProgramVec3(gpu_program, "color2", color2);
+		material->apply();
 
 		gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, gpu_mesh_id, vertices.size() / 8);
 	}
@@ -326,6 +338,7 @@ private:
 	float scale_val;
 	glm::vec3 color1;
 	glm::vec3 color2;
+	std::shared_ptr<gfx::ParameterBlock> material;
 	std::vector<float> vertices;
 	uint32_t vertex_buffer_id, gpu_mesh_id;
 };
@@ -509,8 +522,8 @@ public:
 	void
 	draw()
 	{
+		_bind_variant(0);
 		gfx_backend->setGPUProgramMat4(gpu_program, "model", model);
-		gfx_backend->setGPUProgramInt(gpu_program, "use_checker_texture", 0);
 		gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, gpu_mesh_id, vertices.size() / 8);
 	}
 
@@ -529,8 +542,16 @@ std::shared_ptr<Sphere> sphere;
 void
 init()
 {
-	// build and compile our shader program
-	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
+	// build and compile our shader programs, the checker pattern comes from the shader library
+	shader_variants = std::make_shared<gfx::ShaderVariants>(
+		vertexShader,
+		fragmentShader,
+		std::vector<std::string>{"USE_CHECKER_TEXTURE"},
+		nullptr,
+		&shader_preprocessor);
+
+	checker_variant = shader_variants->getMask({"USE_CHECKER_TEXTURE"});
+	shader_variants->warmUp({checker_variant, 0});
 
 	scene_cyclorama = std::make_shared<Cyclorama>();
 	sphere = std::make_shared<Sphere>();
@@ -548,16 +569,6 @@ render()
 
 	ImGui::SliderFloat("light power", &point_light_power, 100.0f, 2000.0f);
 
-	gfx_backend->bindGPUProgram(gpu_program);
-
-	gfx_backend->setGPUProgramMat4(gpu_program, "view", view);
-	gfx_backend->setGPUProgramMat4(gpu_program, "projection", projection);
-
-	gfx_backend->setGPUProgramVec3(gpu_program, "lightPos", point_light_pos);
-	gfx_backend->setGPUProgramVec3(gpu_program, "viewPos", cameraPosition);
-	gfx_backend->setGPUProgramVec3(gpu_program, "lightColor", glm::vec3(1, 1, 1));
-	gfx_backend->setGPUProgramFloat(gpu_program, "lightPower", point_light_power);
-
 	scene_cyclorama->draw();
 	sphere->draw();
 }
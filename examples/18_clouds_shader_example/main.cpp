@@ -1,5 +1,7 @@
 #include "gfx.h"
 #include "gfx_fbo.h"
+#include "gfx_noise.h"
+#include "gfx_program_compiler.h"
 
 #include <imgui.h>
 #include <iostream>
@@ -70,9 +72,13 @@ auto gfx_backend = std::make_shared<gfx::GFX>();
 int scrn_width = 800;
 int scrn_height = 600;
 
-uint32_t vertex_buffer_id, gpu_mesh_id, gpu_program;
+uint32_t vertex_buffer_id, gpu_mesh_id, gpu_program, cloud_volume_id;
 uint32_t grid_vertex_buffer_id, grid_gpu_mesh_id, grid_gpu_program;
 
+// the programs compile in the background, draws are skipped until they are linked
+std::shared_ptr<gfx::ProgramCompiler> program_compiler;
+uint32_t gpu_program_handle, grid_gpu_program_handle;
+
 // create transformations
 glm::mat4 model = glm::mat4(1.0f);
 glm::mat4 view = glm::mat4(1.0f);
@@ -138,34 +144,22 @@ const char* fragmentShader =R"(
 
 		out vec4 FragColor;
 
-		float hash(float n)
-		{
-			return fract(sin(n) * 43758.5453123);
-		}
+		// baked on the cpu, r holds perlin-worley fbm and gba worley fbm at increasing frequencies
+		// the volume tiles so it's sampled with repeat wrapping
+		uniform sampler3D cloud_volume;
 
-		float noise(vec3 x)
+		float remap(float v, float lo, float hi, float new_lo, float new_hi)
 		{
-			vec3 f = fract(x);
-			float n = dot(floor(x), vec3(1.0, 157.0, 113.0));
-			return mix(mix(mix(hash(n +   0.0), hash(n +   1.0), f.x),
-							mix(hash(n + 157.0), hash(n + 158.0), f.x), f.y),
-						mix(mix(hash(n + 113.0), hash(n + 114.0), f.x),
-							mix(hash(n + 270.0), hash(n + 271.0), f.x), f.y), f.z);
+			return new_lo + (v - lo) * (new_hi - new_lo) / (hi - lo);
 		}
 
-		const mat3 m = mat3(0.0, 1.60,  1.20, -1.6, 0.72, -0.96, -1.2, -0.96, 1.28);
 		float fbm(vec3 p)
 		{
-			float f = 0.0;
-			f += noise(p) / 2; p = m * p * 1.1;
-			f += noise(p) / 4; p = m * p * 1.2;
-			f += noise(p) / 6; p = m * p * 1.3;
-			f += noise(p) / 12; p = m * p * 1.4;
-			f += noise(p) / 24;
-			return f;
+			vec4 n = texture(cloud_volume, p / 4.0);
+			float detail = dot(n.gba, vec3(0.625, 0.25, 0.125));
+			return clamp(remap(n.r, detail - 1.0, 1.0, 0.0, 1.0), 0.0, 1.0);
 		}
 
-
 		vec3 skyColor( in vec3 rd )
 		{
 			vec3 sundir = normalize( lightPos );
@@ -251,12 +245,16 @@ _init_grid()
 	grid_gpu_mesh_id = gfx_backend->createGPUMesh(grid_vertex_buffer_id, attributes);
 
 	// build and compile our shader program
-	grid_gpu_program = gfx_backend->createGPUProgram(grid_vertexShader, grid_fragmentShader);
+	grid_gpu_program_handle = program_compiler->submit(grid_vertexShader, grid_fragmentShader);
 }
 
 inline static void
 _draw_grid()
 {
+	grid_gpu_program = program_compiler->getProgram(grid_gpu_program_handle);
+	if (grid_gpu_program == 0)
+		return;
+
 	gfx_backend->bindGPUProgram(grid_gpu_program);
 
 	view = camera.getViewMatrix();
@@ -288,8 +286,32 @@ init()
 
 	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
 
-	// build and compile our shader program
-	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
+	// build and compile our shader program, the driver works on it while the noise below is baked
+	program_compiler = std::make_shared<gfx::ProgramCompiler>();
+	gpu_program_handle = program_compiler->submit(vertexShader, fragmentShader);
+	std::cout << "parallel shader compile: " << (program_compiler->isParallel() ? "yes" : "no") << std::endl;
+
+	// bake the cloud noise once instead of evaluating it for every pixel every frame
+	// the four noises share one RGBA8 volume so the shader gets all of them with a single fetch
+	gfx::Image3D cloud_volume(128, 128, 128, gfx::Texture_Format::RGBA8);
+
+	gfx::noise::Noise_Settings perlin_settings;
+	gfx::noise::Noise_Settings worley_settings;
+	worley_settings.octaves = 3;
+	gfx::noise::bakePerlinWorley(&cloud_volume, perlin_settings, worley_settings, 0);
+
+	for (int channel = 1; channel < 4; ++channel)
+	{
+		worley_settings.frequency = 4 << (channel - 1);
+		gfx::noise::bakeWorley(&cloud_volume, worley_settings, channel);
+	}
+
+	cloud_volume_id = gfx_backend->createTexture3D(
+		&cloud_volume,
+		gfx::Wrapping_Mode::REPEAT,
+		gfx::Filtering_Mode::LINEAR_MIPMAP_LINEAR,
+		gfx::Filtering_Mode::LINEAR,
+		true);
 
 	projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 1000.0f);
 
@@ -302,16 +324,21 @@ render()
 	gfx_backend->setClearColor(glm::vec4(0.0f, 0.67f, 0.9f, 1.0f));
 	gfx_backend->clearBuffer();
 
-	gfx_backend->bindGPUProgram(gpu_program);
+	gpu_program = program_compiler->getProgram(gpu_program_handle);
+	if (gpu_program != 0)
+	{
+		gfx_backend->bindTexture3D(cloud_volume_id);
+		gfx_backend->bindGPUProgram(gpu_program);
 
-	view = camera.getViewMatrix();
-	gfx_backend->setGPUProgramMat4(gpu_program, "inv_view", glm::inverse(view));
-	gfx_backend->setGPUProgramVec2(gpu_program, "resolution", glm::vec2(scrn_width, scrn_height));
-	gfx_backend->setGPUProgramVec3(gpu_program, "lightPos", glm::vec3(50));
+		view = camera.getViewMatrix();
+		gfx_backend->setGPUProgramMat4(gpu_program, "inv_view", glm::inverse(view));
+		gfx_backend->setGPUProgramVec2(gpu_program, "resolution", glm::vec2(scrn_width, scrn_height));
+		gfx_backend->setGPUProgramVec3(gpu_program, "lightPos", glm::vec3(50));
 
-	glDisable(GL_DEPTH_TEST);
-	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
-	glEnable(GL_DEPTH_TEST);
+		glDisable(GL_DEPTH_TEST);
+		gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+		glEnable(GL_DEPTH_TEST);
+	}
 
 	_draw_grid();
 }
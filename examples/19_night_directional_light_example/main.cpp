@@ -1,7 +1,15 @@
 #include "gfx.h"
-#include "gfx_fbo.h"
+#include "gfx_noise.h"
+#include "gfx_parameter_block.h"
+#include "gfx_program.h"
+#include "gfx_program_cache.h"
+#include "gfx_render_graph.h"
+#include "gfx_shader_preprocessor.h"
+#include "gfx_shader_variants.h"
 
 #include <imgui.h>
+
+#include <filesystem>
 #include <iostream>
 
 // global
@@ -316,14 +324,33 @@ OrbitalCamera camera(68.0f, -0.1f, 25.0f);
 int scrn_width = 800;
 int scrn_height = 600;
 
+// a multiple of the render target pool granularity so the shadow map texture is exactly this size
 int shadow_width = 2048;
 int shadow_height = 2048;
 
-uint32_t sky_vertex_buffer_id, sky_gpu_mesh_id, sky_gpu_program;
+uint32_t sky_vertex_buffer_id, sky_gpu_mesh_id, sky_gpu_program, sky_volume_id;
 uint32_t scene_vertex_buffer_id, scene_gpu_mesh_id, scene_gpu_program;
 
+// the plane compiles the checker pattern in, the sphere leaves it out
+std::shared_ptr<gfx::ShaderVariants> scene_variants;
+uint32_t checker_variant;
+
+// the plane material never changes, apply uploads it once and only binds its buffer afterwards
+std::shared_ptr<gfx::ParameterBlock> plane_material;
+
 uint32_t depth_gpu_program, quad_vertex_buffer_id, quad_index_buffer_id, quad_gpu_mesh_id;
-std::shared_ptr<gfx::Framebuffer> depth_frame_buffer;
+uint32_t shadow_preview_gpu_program, preview_frame_gpu_program;
+
+// the shadow map is a transient target of the graph, the preview pass only runs while it's shown
+std::shared_ptr<gfx::RenderTargetPool> render_target_pool;
+std::shared_ptr<gfx::RenderGraph> render_graph;
+bool show_shadow_map = false;
+
+// the second run loads the linked programs instead of compiling them
+std::shared_ptr<gfx::ProgramCache> program_cache;
+
+// resolves the shader library includes, the cache keys on the expanded sources
+gfx::ShaderPreprocessor shader_preprocessor;
 
 float near_plane = 0.1f, far_plane = 200.0f;
 
@@ -366,6 +393,55 @@ _init_scene()
 			gl_FragDepth = gl_FragCoord.z;
 		})";
 
+	const char* shadow_preview_vertexShader =
+		R"(
+		#version 450 core
+		layout (location = 0) in vec3 aPos;
+		layout (location = 1) in vec2 aTexCoord;
+
+		out vec2 TexCoord;
+
+		void main()
+		{
+			TexCoord = aTexCoord;
+			gl_Position = vec4(aPos, 1.0);
+		})";
+
+	// the preview is written with image stores, the frame is drawn over it afterwards
+	const char* shadow_preview_computeShader =
+		R"(
+		#version 450 core
+		layout(local_size_x = 8, local_size_y = 8) in;
+		layout(binding = 0) uniform sampler2D shadowMap;
+		layout(binding = 0, rgba8) uniform writeonly image2D preview;
+
+		uniform int size;
+
+		void main()
+		{
+			ivec2 pixel = ivec2(gl_GlobalInvocationID.xy);
+			if (any(greaterThanEqual(pixel, ivec2(size))))
+				return;
+
+			float depth = texture(shadowMap, (vec2(pixel) + 0.5) / vec2(size)).r;
+			imageStore(preview, pixel, vec4(vec3(depth), 1.0));
+		})";
+
+	const char* preview_frame_fragmentShader =
+		R"(
+		#version 450 core
+		in vec2 TexCoord;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			vec2 border = min(TexCoord, 1.0 - TexCoord);
+			if (min(border.x, border.y) > 0.02)
+				discard;
+			FragColor = vec4(1.0, 0.6, 0.2, 1.0);
+		})";
+
 	const char* vertexShader =
 		R"(
 		#version 450 core
@@ -405,97 +481,38 @@ _init_scene()
 
 		uniform vec3 lightPos;     // Position of the point light
 
-		uniform bool use_checker_texture;
-		uniform float scale; // Adjust this value for larger/smaller squares
-		uniform vec3 color1; // white
-		uniform vec3 color2; // black
+		// static per material, uploaded once by a ParameterBlock
+		layout(std140, binding = 0) uniform Material
+		{
+			vec3 color1;
+			float scale; // Adjust this value for larger/smaller squares
+			vec3 color2;
+		};
 
 		uniform float gamma;
 
 		uniform sampler2D shadowMap;
 
-		float ShadowCalculation(vec4 fragPosLightSpace) {
-			// perform perspective divide
-			vec3 projCoords = fragPosLightSpace.xyz / fragPosLightSpace.w;
-
-			// transform to [0,1] range
-			projCoords = projCoords * 0.5 + 0.5;
-
-			// get closest depth value from light's perspective (using [0,1] range fragPosLight as coords)
-			float closestDepth = texture(shadowMap, projCoords.xy).r; 
-
-			// get depth of current fragment from light's perspective
-			float currentDepth = projCoords.z;
+		#include "gfx/shadow.glsl"
 
+		float ShadowCalculation(vec4 fragPosLightSpace) {
 			// calculate bias (based on depth map resolution and slope)
 			vec3 normal = normalize(fragNormal);
 			vec3 lightDir = normalize(lightPos - fragPos);
-			float bias = max(0.1 * (1.0 - dot(normal, lightDir)), 0.01);
-
-			float shadow = 0.0;
-			vec2 texelSize = 1.0 / textureSize(shadowMap, 0);
-			for(int x = -1; x <= 1; ++x)
-			{
-				for(int y = -1; y <= 1; ++y)
-				{
-					float pcfDepth = texture(shadowMap, projCoords.xy + vec2(x, y) * texelSize).r; 
-					shadow += currentDepth - bias > pcfDepth  ? 1.0 : 0.0;
-				}    
-			}
-			shadow /= 9.0;
-
-			// keep the shadow at 0.0 when outside the far_plane region of the light's frustum.
-			if(projCoords.z > 1.0)
-				shadow = 0.0;
-
-			return shadow;
+			return shadowPCF(shadowMap, fragPosLightSpace, shadowBias(normal, lightDir, 0.1, 0.01));
 		}
 
-		vec4 checker(vec2 _TexCoord, float _scale, vec3 _color1, vec3 _color2)
-		{
-			// Scale the checker pattern
-			vec2 pos = _TexCoord * _scale;
-
-			// Create a checker pattern
-			float checker = step(0.5, mod(floor(pos.x) + floor(pos.y), 2.0));
-
-			// Calculate the distance to the edges
-			float distToEdgeX = abs(fract(pos.x));
-			float distToEdgeY = abs(fract(pos.y));
-			float edgeDistance = min(distToEdgeX, distToEdgeY);
+		#include "gfx/checker.glsl"
 
-			// Smooth the transition with a simple step function
-			float smoothing = smoothstep(0.0, 0.01, edgeDistance); // Adjust the second parameter for more or less smoothing
-
-			// Mix colors based on the checker pattern and smoothing
-			return vec4(mix(_color1, _color2, mix(checker, 1.0 - checker, smoothing)), 1.0);
-		}
-
-		vec3 Uncharted2ToneMapping(vec3 color)
-		{
-			float A = 0.15;
-			float B = 0.50;
-			float C = 0.10;
-			float D = 0.20;
-			float E = 0.02;
-			float F = 0.30;
-			float W = 11.2;
-			float exposure = 2.;
-			color *= exposure;
-			color = ((color * (A * color + C * B) + D * E) / (color * (A * color + B) + D * F)) - E / F;
-			float white = ((W * (A * W + C * B) + D * E) / (W * (A * W + B) + D * F)) - E / F;
-			color /= white;
-			return color;
-		}
+		#include "gfx/tonemapping.glsl"
 
 		void main()
 		{
 			vec4 final_col = vec4(1.0,1.0,1.0,1.0);
 
-			if(use_checker_texture)
-			{
+			#ifdef USE_CHECKER_TEXTURE
 				final_col = checker(TexCoord, scale, color1, color2);
-			}
+			#endif
 	
 			// Normalize the normal vector
 			vec3 norm = normalize(fragNormal);
@@ -540,12 +557,28 @@ _init_scene()
 	// clang-format on
 
 	// build and compile our shader program
-	scene_gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
-	depth_gpu_program = gfx_backend->createGPUProgram(depth_vertexShader, depth_fragmentShader);
+	scene_variants = std::make_shared<gfx::ShaderVariants>(
+		vertexShader,
+		fragmentShader,
+		std::vector<std::string>{"USE_CHECKER_TEXTURE"},
+		program_cache.get());
+
+	checker_variant = scene_variants->getMask({"USE_CHECKER_TEXTURE"});
+	scene_variants->warmUp({checker_variant, 0});
+	depth_gpu_program = program_cache->createGPUProgram(depth_vertexShader, depth_fragmentShader);
+	shadow_preview_gpu_program =
+		gfx::linkProgram({gfx::compileShader(GL_COMPUTE_SHADER, shadow_preview_computeShader)});
+	preview_frame_gpu_program =
+		program_cache->createGPUProgram(shadow_preview_vertexShader, preview_frame_fragmentShader);
 
 	scene_plane = std::make_shared<Plane>();
 	sphere = std::make_shared<Sphere>();
 
+	plane_material = std::make_shared<gfx::ParameterBlock>(scene_variants->getProgram(checker_variant), "Material");
+	plane_material->setFloat("scale", scene_plane->scale_val);
+	plane_material->setVec3("color1", scene_plane->color1);
+	plane_material->setVec3("color2", scene_plane->color2);
+
 	light_view = glm::lookAt(light_pos, camera.target, glm::vec3(0, 1, 0));
 	light_projection = glm::ortho(-100.0f, 100.0f, -100.0f, 100.0f, near_plane, far_plane);
 
@@ -574,18 +607,13 @@ _init_scene()
 
 	quad_gpu_mesh_id = gfx_backend->createGPUMesh(quad_vertex_buffer_id, quad_index_buffer_id, attributes);
 
-	// create another render buffer to render on it.
-	depth_frame_buffer =
-		std::make_shared<gfx::Framebuffer>(shadow_width, shadow_height, gfx::FrameBuffer_Mode::DepthBuffer);
+	render_target_pool = std::make_shared<gfx::RenderTargetPool>();
+	render_graph = std::make_shared<gfx::RenderGraph>(render_target_pool.get());
 }
 
 void
 render_depthmap()
 {
-
-	depth_frame_buffer->Bind();
-	gfx_backend->clearBuffer();
-
 	gfx_backend->bindGPUProgram(depth_gpu_program);
 	gfx_backend->setGPUProgramMat4(depth_gpu_program, "view", light_view);
 	gfx_backend->setGPUProgramMat4(depth_gpu_program, "projection", light_projection);
@@ -595,37 +623,35 @@ render_depthmap()
 
 	gfx_backend->setGPUProgramMat4(depth_gpu_program, "model", sphere->model);
 	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, sphere->gpu_mesh_id, sphere->vertices.size() / 8);
-
-	depth_frame_buffer->Unbind();
 }
 
+// the uniforms shared by every draw go to each variant
 inline static void
-_draw_scene()
+_bind_scene_variant(uint32_t variant)
 {
-	gfx_backend->updateViewport(shadow_width, shadow_height);
-	render_depthmap();
-
-	gfx_backend->updateViewport(scrn_width, scrn_height);
-
+	scene_gpu_program = scene_variants->getProgram(variant);
 	gfx_backend->bindGPUProgram(scene_gpu_program);
-	gfx_backend->bindTexture2D(depth_frame_buffer->GetTexture());
 
 	gfx_backend->setGPUProgramMat4(scene_gpu_program, "view", view);
 	gfx_backend->setGPUProgramMat4(scene_gpu_program, "projection", projection);
 	gfx_backend->setGPUProgramMat4(scene_gpu_program, "lightSpaceMatrix", light_projection * light_view);
 	gfx_backend->setGPUProgramVec3(scene_gpu_program, "lightPos", light_pos);
+}
+
+inline static void
+_draw_scene(uint32_t shadow_map)
+{
+	gfx_backend->bindTexture2D(render_graph->getTexture(shadow_map));
 
 	// render cyclorama
+	_bind_scene_variant(checker_variant);
 	gfx_backend->setGPUProgramMat4(scene_gpu_program, "model", scene_plane->model);
-	gfx_backend->setGPUProgramInt(scene_gpu_program, "use_checker_texture", 1);
-	gfx_backend->setGPUProgramFloat(scene_gpu_program, "scale", scene_plane->scale_val);
-	gfx_backend->setGPUProgramVec3(scene_gpu_program, "color1", scene_plane->color1);
-	gfx_backend->setGPUProgramVec3(scene_gpu_program, "color2", scene_plane->color2);
+	plane_material->apply();
 	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, scene_plane->gpu_mesh_id, scene_plane->vertices.size() / 8);
 
 	// render sphere
+	_bind_scene_variant(0);
 	gfx_backend->setGPUProgramMat4(scene_gpu_program, "model", sphere->model);
-	gfx_backend->setGPUProgramInt(scene_gpu_program, "use_checker_texture", 0);
 	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, sphere->gpu_mesh_id, sphere->vertices.size() / 8);
 }
 
@@ -659,34 +685,16 @@ init()
 
 		out vec4 FragColor;
 
-		// random/hash function
-		float hash(float n)
-		{
-			return fract(sin(n) * 43758.5453123);
-		}
-
-		float noise(vec3 x)
-		{
-			vec3 f = fract(x);
-			float n = dot(floor(x), vec3(1.0, 157.0, 113.0));
-			return mix(mix(mix(hash(n +   0.0), hash(n +   1.0), f.x),
-							mix(hash(n + 157.0), hash(n + 158.0), f.x), f.y),
-						mix(mix(hash(n + 113.0), hash(n + 114.0), f.x),
-							mix(hash(n + 270.0), hash(n + 271.0), f.x), f.y), f.z);
-		}
+		#include "gfx/noise.glsl"
 
-		mat3 m = mat3( 0.00,  1.60,  1.20, -1.60,  0.72, -0.96, -1.20, -0.96,  1.28 );
+		// perlin fbm baked on the cpu, the stars keep the cheap library noise above since they need a much higher
+		// frequency than the volume holds
+		uniform sampler3D sky_volume;
 
 		// Fractional Brownian motion
 		float fbm( vec3 p )
 		{
-			float f = 0.0;
-			f += noise(p) / 2; p = m * p * 1.1;
-			f += noise(p) / 4; p = m * p * 1.2;
-			f += noise(p) / 6; p = m * p * 1.3;
-			f += noise(p) / 12; p = m * p * 1.4;
-			f += noise(p) / 24;
-			return f;
+			return texture(sky_volume, p / 4.0).r;
 		}
 
 		vec3 skyColor( in vec3 rd )
@@ -736,22 +744,38 @@ init()
 	sky_gpu_mesh_id = gfx_backend->createGPUMesh(sky_vertex_buffer_id, attributes);
 
 	// build and compile our shader program
-	sky_gpu_program = gfx_backend->createGPUProgram(sky_vertexShader, sky_fragmentShader);
+	program_cache = std::make_shared<gfx::ProgramCache>(
+		(std::filesystem::temp_directory_path() / "gfx_program_cache").string());
+	program_cache->setPreprocessor(&shader_preprocessor);
+	sky_gpu_program = program_cache->createGPUProgram(sky_vertexShader, sky_fragmentShader);
+
+	gfx::Image3D sky_volume(64, 64, 64, gfx::Texture_Format::R8);
+	gfx::noise::bakePerlin(&sky_volume, gfx::noise::Noise_Settings{});
+
+	sky_volume_id = gfx_backend->createTexture3D(
+		&sky_volume,
+		gfx::Wrapping_Mode::REPEAT,
+		gfx::Filtering_Mode::LINEAR,
+		gfx::Filtering_Mode::LINEAR,
+		false);
 
 	projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 1000.0f);
 
 	_init_scene();
+
+	std::cout << "program cache hits: " << program_cache->getHits() << ", misses: " << program_cache->getMisses()
+			  << std::endl;
 }
 
-void
-render()
+inline static void
+_draw_sky()
 {
 	gfx_backend->setClearColor(glm::vec4(0.0f, 0.67f, 0.9f, 1.0f));
 	gfx_backend->clearBuffer();
 
+	gfx_backend->bindTexture3D(sky_volume_id);
 	gfx_backend->bindGPUProgram(sky_gpu_program);
 
-	view = camera.getViewMatrix();
 	gfx_backend->setGPUProgramMat4(sky_gpu_program, "inv_view", glm::inverse(view));
 	gfx_backend->setGPUProgramVec2(sky_gpu_program, "resolution", glm::vec2(scrn_width, scrn_height));
 	gfx_backend->setGPUProgramVec3(sky_gpu_program, "lightPos", light_pos);
@@ -760,8 +784,69 @@ render()
 	gfx_backend->disableSetting(gfx::GFX_Settings::DEPTH_TEST);
 	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, sky_gpu_mesh_id, 4);
 	gfx_backend->enableSetting(gfx::GFX_Settings::DEPTH_TEST);
+}
+
+void
+render()
+{
+	view = camera.getViewMatrix();
+
+	ImGui::Checkbox("show shadow map", &show_shadow_map);
+
+	// the graph binds the targets, sets the viewports and clears the shadow map, the passes only draw
+	render_graph->reset();
+
+	auto window = render_graph->importWindow(scrn_width, scrn_height);
+	auto shadow_map = render_graph->createTarget(
+		"shadow map",
+		gfx::Render_Target_Desc{gfx::Texture_Format::RGBA8, shadow_width, shadow_height, 1, gfx::DEPTH24});
+	auto shadow_preview =
+		render_graph->createTarget("shadow preview", gfx::Render_Target_Desc{gfx::Texture_Format::RGBA8, 256, 256});
+
+	auto pass = render_graph->addPass("shadow", render_depthmap);
+	render_graph->write(pass, shadow_map);
+
+	pass = render_graph->addPass("sky", _draw_sky);
+	render_graph->write(pass, window);
+
+	pass = render_graph->addPass("scene", [shadow_map] { _draw_scene(shadow_map); });
+	render_graph->read(pass, shadow_map);
+	render_graph->write(pass, window);
+
+	// a compute pass writes the preview and a raster pass draws the frame over it, the graph clears the preview
+	// only on an attachment first write so the frame doesn't wipe what the compute pass wrote
+	pass = render_graph->addPass("shadow preview", [shadow_map, shadow_preview] {
+		auto& preview = render_graph->getTarget(shadow_preview);
+		gfx_backend->bindTextureUnit(render_graph->getTexture(shadow_map), 0);
+		glBindImageTexture(0, preview.texture, 0, GL_FALSE, 0, GL_WRITE_ONLY, GL_RGBA8);
+
+		gfx_backend->bindGPUProgram(shadow_preview_gpu_program);
+		gfx_backend->setGPUProgramInt(shadow_preview_gpu_program, "size", 256);
+		glDispatchCompute(256 / 8, 256 / 8, 1);
+	});
+	render_graph->read(pass, shadow_map);
+	render_graph->write(pass, shadow_preview, gfx::ACCESS_STORAGE_WRITE);
+
+	pass = render_graph->addPass("preview frame", [] {
+		gfx_backend->bindGPUProgram(preview_frame_gpu_program);
+		gfx_backend->draw_indexed(gfx::GFX_Primitive::TRIANGLES, quad_gpu_mesh_id, 6);
+	});
+	render_graph->write(pass, shadow_preview);
+
+	if (show_shadow_map)
+		render_graph->keep(shadow_preview);
+
+	render_graph->execute();
+
+	if (show_shadow_map)
+	{
+		auto& preview = render_graph->getTarget(shadow_preview);
+		auto uv_scale = preview.getUVScale();
+		auto texture = (ImTextureID)(intptr_t)preview.texture;
+		ImGui::Image(texture, ImVec2(256, 256), ImVec2(0, uv_scale.y), ImVec2(uv_scale.x, 0));
+	}
 
-	_draw_scene();
+	ImGui::Text("passes: %u, culled: %u", render_graph->getPassCount(), render_graph->getCulledPassCount());
 }
 
 void
@@ -0,0 +1,186 @@
+#include "gfx.h"
+#include "gfx_atlas.h"
+
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+uint32_t vertex_buffer_id, index_buffer_id, instance_buffer_id, gpu_mesh_id, gpu_program, texture_array_id;
+
+const int grid_size = 8;
+
+std::vector<std::shared_ptr<gfx::Image>> tiles;
+std::shared_ptr<gfx::TextureAtlas> atlas;
+
+// per instance data, the atlas region is placed right after the quad offset
+struct Instance
+{
+	glm::vec2 offset;
+	gfx::Atlas_Region region;
+};
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout(location = 0) in vec2 aPos;
+		layout(location = 1) in vec2 aTexCoord;
+
+		// per instance
+		layout(location = 2) in vec2 aOffset;
+		layout(location = 3) in vec4 aUVTransform;
+		layout(location = 4) in float aLayer;
+
+		out vec3 TexCoord;
+
+		void main()
+		{
+			gl_Position = vec4(aPos + aOffset, 0.0, 1.0);
+			TexCoord = vec3(aTexCoord * aUVTransform.xy + aUVTransform.zw, aLayer);
+		})";
+
+const char* fragmentShader = R"(
+		#version 450 core
+		out vec4 FragColor;
+		in vec3 TexCoord;
+
+		uniform sampler2DArray atlas;
+
+		void main()
+		{
+			FragColor = texture(atlas, TexCoord);
+		})";
+
+inline static std::shared_ptr<gfx::Image>
+_make_tile(int width, int height, glm::vec3 color1, glm::vec3 color2, int cells)
+{
+	auto img = std::make_shared<gfx::Image>(width, height, 4);
+
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			bool odd = ((x * cells / width) + (y * cells / height)) % 2;
+			auto color = odd ? color1 : color2;
+
+			auto pixel = img->getData() + (size_t(y) * width + x) * 4;
+			pixel[0] = (unsigned char)(color.r * 255);
+			pixel[1] = (unsigned char)(color.g * 255);
+			pixel[2] = (unsigned char)(color.b * 255);
+			pixel[3] = 255;
+		}
+	}
+
+	return img;
+}
+
+void
+init()
+{
+	// clang-format off
+
+	float vertices[] = {
+		// positions      // texture coords
+		 0.1f,  0.1f,     1.0f, 1.0f, // top right
+		 0.1f, -0.1f,     1.0f, 0.0f, // bottom right
+		-0.1f, -0.1f,     0.0f, 0.0f, // bottom left
+		-0.1f,  0.1f,     0.0f, 1.0f  // top left
+	};
+
+	unsigned int indices[] = {
+		0, 1, 3, // first triangle
+		1, 2, 3  // second triangle
+	};
+
+	// clang-format on
+
+	// generate a bunch of small textures with different sizes
+	for (int i = 0; i < 12; ++i)
+	{
+		float t = i / 12.0f;
+		tiles.push_back(_make_tile(
+			32 + (i % 4) * 32,
+			32 + (i % 3) * 32,
+			glm::vec3(t, 1.0f - t, 0.5f),
+			glm::vec3(1.0f, 1.0f, 1.0f),
+			2 + i % 5));
+	}
+
+	// small pages to show more than one layer in use
+	atlas = std::make_shared<gfx::TextureAtlas>(256, 256, 4);
+	for (auto& tile : tiles)
+		atlas->add(tile.get());
+	atlas->build();
+
+	std::cout << "atlas pages: " << atlas->getPageCount() << std::endl;
+
+	texture_array_id = gfx_backend->createTexture2DArray(
+		atlas->getPages(),
+		gfx::Wrapping_Mode::CLAMP_TO_EDGE,
+		gfx::Filtering_Mode::LINEAR,
+		gfx::Filtering_Mode::LINEAR,
+		false);
+
+	std::vector<Instance> instances;
+	for (int y = 0; y < grid_size; ++y)
+	{
+		for (int x = 0; x < grid_size; ++x)
+		{
+			Instance instance;
+			instance.offset = glm::vec2(-0.875f + x * 0.25f, -0.875f + y * 0.25f);
+			instance.region = atlas->getRegion((y * grid_size + x) % tiles.size());
+			instances.push_back(instance);
+		}
+	}
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+	index_buffer_id = gfx_backend->createIndexBuffer(indices, sizeof(indices), gfx::BUFFER_USAGE::STATIC);
+	instance_buffer_id = gfx_backend->createVertexBuffer(
+		instances.data(),
+		sizeof(instances[0]) * instances.size(),
+		gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC2, "POSITION"));
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC2, "TEXCOORD"));
+
+	gfx::Attributes instance_attributes;
+	instance_attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC2, "OFFSET"));
+	instance_attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC4, "UV_TRANSFORM"));
+	instance_attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::FLOAT, "LAYER"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(
+		vertex_buffer_id,
+		index_buffer_id,
+		attributes,
+		instance_buffer_id,
+		instance_attributes);
+
+	// build and compile our shader program
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.67f, 0.9f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	gfx_backend->bindTexture2DArray(texture_array_id);
+	gfx_backend->bindGPUProgram(gpu_program);
+
+	// every quad samples a different texture in a single draw call
+	gfx_backend->draw_indexed_instanced(gfx::GFX_Primitive::TRIANGLES, gpu_mesh_id, 6, grid_size * grid_size);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx texture atlas", 800, 800);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->start();
+
+	return 0;
+}
@@ -0,0 +1,186 @@
+#include "gfx.h"
+#include "gfx_material_table.h"
+
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+uint32_t vertex_buffer_id, index_buffer_id, instance_buffer_id, indirect_buffer_id, gpu_mesh_id, gpu_program;
+
+const int grid_size = 8;
+
+std::vector<std::shared_ptr<gfx::Image>> tiles;
+std::shared_ptr<gfx::MaterialTable> materials;
+
+// per draw data, fetched through the base instance of each indirect command
+struct Instance
+{
+	glm::vec2 offset;
+	float material;
+};
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout(location = 0) in vec2 aPos;
+		layout(location = 1) in vec2 aTexCoord;
+
+		// per draw
+		layout(location = 2) in vec2 aOffset;
+		layout(location = 3) in float aMaterial;
+
+		out vec2 TexCoord;
+		flat out uint Material;
+
+		void main()
+		{
+			gl_Position = vec4(aPos + aOffset, 0.0, 1.0);
+			TexCoord = aTexCoord * 2.0;
+			Material = uint(aMaterial + 0.5);
+		})";
+
+const char* fragmentShader = R"(
+		#version 450 core
+		out vec4 FragColor;
+		in vec2 TexCoord;
+		flat in uint Material;
+
+		void main()
+		{
+			FragColor = gfx_sampleMaterial(Material, TexCoord);
+		})";
+
+inline static std::shared_ptr<gfx::Image>
+_make_tile(int width, int height, glm::vec3 color1, glm::vec3 color2, int cells)
+{
+	auto img = std::make_shared<gfx::Image>(width, height, 4);
+
+	for (int y = 0; y < height; ++y)
+	{
+		for (int x = 0; x < width; ++x)
+		{
+			bool odd = ((x * cells / width) + (y * cells / height)) % 2;
+			auto color = odd ? color1 : color2;
+
+			auto pixel = img->getData() + (size_t(y) * width + x) * 4;
+			pixel[0] = (unsigned char)(color.r * 255);
+			pixel[1] = (unsigned char)(color.g * 255);
+			pixel[2] = (unsigned char)(color.b * 255);
+			pixel[3] = 255;
+		}
+	}
+
+	return img;
+}
+
+void
+init()
+{
+	// clang-format off
+
+	float vertices[] = {
+		// positions      // texture coords
+		 0.1f,  0.1f,     1.0f, 1.0f, // top right
+		 0.1f, -0.1f,     1.0f, 0.0f, // bottom right
+		-0.1f, -0.1f,     0.0f, 0.0f, // bottom left
+		-0.1f,  0.1f,     0.0f, 1.0f  // top left
+	};
+
+	unsigned int indices[] = {
+		0, 1, 3, // first triangle
+		1, 2, 3  // second triangle
+	};
+
+	// clang-format on
+
+	materials = std::make_shared<gfx::MaterialTable>();
+
+	for (int i = 0; i < 16; ++i)
+	{
+		float t = i / 16.0f;
+		tiles.push_back(_make_tile(64, 64, glm::vec3(t, 0.3f, 1.0f - t), glm::vec3(1.0f, 1.0f, 1.0f), 2 + i % 6));
+		materials->add(tiles.back().get());
+	}
+
+	materials->build(gfx_backend.get());
+
+	std::cout << "material table: " << (materials->isBindless() ? "bindless" : "texture array") << std::endl;
+
+	// one command per quad, the base instance selects the per draw data
+	std::vector<Instance> instances;
+	std::vector<gfx::Draw_Elements_Command> commands;
+	for (int y = 0; y < grid_size; ++y)
+	{
+		for (int x = 0; x < grid_size; ++x)
+		{
+			Instance instance;
+			instance.offset = glm::vec2(-0.875f + x * 0.25f, -0.875f + y * 0.25f);
+			instance.material = float((y * grid_size + x) % materials->getMaterialCount());
+
+			gfx::Draw_Elements_Command command = {6, 1, 0, 0, (uint32_t)instances.size()};
+
+			instances.push_back(instance);
+			commands.push_back(command);
+		}
+	}
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+	index_buffer_id = gfx_backend->createIndexBuffer(indices, sizeof(indices), gfx::BUFFER_USAGE::STATIC);
+	instance_buffer_id = gfx_backend->createVertexBuffer(
+		instances.data(),
+		sizeof(instances[0]) * instances.size(),
+		gfx::BUFFER_USAGE::STATIC);
+	indirect_buffer_id = gfx_backend->createIndirectBuffer(
+		commands.data(),
+		sizeof(commands[0]) * commands.size(),
+		gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC2, "POSITION"));
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC2, "TEXCOORD"));
+
+	gfx::Attributes instance_attributes;
+	instance_attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC2, "OFFSET"));
+	instance_attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::FLOAT, "MATERIAL"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(
+		vertex_buffer_id,
+		index_buffer_id,
+		attributes,
+		instance_buffer_id,
+		instance_attributes);
+
+	// build and compile our shader program
+	auto fragment_source = materials->injectShaderHeader(fragmentShader);
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragment_source.c_str());
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.67f, 0.9f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	gfx_backend->bindGPUProgram(gpu_program);
+	materials->bind(gfx_backend.get());
+
+	// the whole grid in one call without any texture bind in between
+	gfx_backend->draw_indexed_multi_indirect(
+		gfx::GFX_Primitive::TRIANGLES,
+		gpu_mesh_id,
+		indirect_buffer_id,
+		grid_size * grid_size);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx material table", 800, 800);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->start();
+
+	return 0;
+}
@@ -0,0 +1,198 @@
+#include "gfx.h"
+#include "gfx_noise.h"
+#include "gfx_volume_file.h"
+
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+uint32_t vertex_buffer_id, gpu_mesh_id, gpu_program, volume_id;
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 uv;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+// walks through the z slices and tiles the volume twice to show that it wraps without seams
+const char* fragmentShader = R"(
+		#version 450 core
+		uniform sampler3D volume;
+		uniform float time;
+
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			float value = texture(volume, vec3(uv * 2.0, time * 0.05)).r;
+			FragColor = vec4(vec3(value), 1.0);
+		})";
+
+enum Noise_Kind
+{
+	PERLIN,
+	WORLEY,
+	PERLIN_WORLEY
+};
+
+inline static const char*
+_noise_name(Noise_Kind kind)
+{
+	switch (kind)
+	{
+	case PERLIN:
+		return "perlin";
+	case WORLEY:
+		return "worley";
+	default:
+		return "perlin-worley";
+	}
+}
+
+inline static void
+_bake(gfx::Image3D* img, Noise_Kind kind, bool allow_simd)
+{
+	gfx::noise::Noise_Settings perlin_settings;
+	perlin_settings.allow_simd = allow_simd;
+
+	gfx::noise::Noise_Settings worley_settings = perlin_settings;
+	worley_settings.octaves = 3;
+
+	switch (kind)
+	{
+	case PERLIN:
+		gfx::noise::bakePerlin(img, perlin_settings);
+		break;
+	case WORLEY:
+		gfx::noise::bakeWorley(img, worley_settings);
+		break;
+	default:
+		gfx::noise::bakePerlinWorley(img, perlin_settings, worley_settings);
+		break;
+	}
+}
+
+// prints the baking throughput in millions of voxels per second
+inline static void
+_benchmark(int size)
+{
+	gfx::Image3D img(size, size, size);
+	double voxels = double(img.getSize());
+
+	for (auto kind : {PERLIN, WORLEY, PERLIN_WORLEY})
+	{
+		for (bool allow_simd : {false, true})
+		{
+			if (allow_simd && gfx::noise::hasAVX2() == false)
+				continue;
+
+			auto start = std::chrono::steady_clock::now();
+			_bake(&img, kind, allow_simd);
+			auto end = std::chrono::steady_clock::now();
+
+			double seconds = std::chrono::duration<double>(end - start).count();
+			std::cout << size << "^3 " << _noise_name(kind) << (allow_simd ? " avx2: " : " scalar: ")
+					  << seconds * 1000.0 << " ms, " << voxels / seconds / 1e6 << " Mvoxels/s" << std::endl;
+		}
+	}
+}
+
+// saves the volume compressed and replaces it with the decoded file, prints the compression ratio and the
+// decoding throughput
+inline static void
+_save_and_load(gfx::Image3D* volume)
+{
+	auto path = (std::filesystem::temp_directory_path() / "gfx_noise_volume.gfxv").string();
+	if (!volume->save(path.c_str(), 16))
+		return;
+
+	gfx::VolumeFile file(path.c_str());
+
+	auto start = std::chrono::steady_clock::now();
+	auto loaded = file.read();
+	auto end = std::chrono::steady_clock::now();
+
+	double seconds = std::chrono::duration<double>(end - start).count();
+	std::cout << "volume file: " << file.getFileSize() / 1024 << " KB, ratio "
+			  << double(volume->getSizeInBytes()) / double(file.getFileSize()) << ", decode " << seconds * 1000.0
+			  << " ms, " << double(volume->getSizeInBytes()) / seconds / 1e6 << " MB/s" << std::endl;
+
+	if (loaded.hasData())
+		*volume = std::move(loaded);
+}
+
+void
+init()
+{
+	std::cout << "avx2 kernels: " << (gfx::noise::hasAVX2() ? "yes" : "no") << std::endl;
+	_benchmark(128);
+	_benchmark(256);
+
+	// half floats keep the precision of the bake at half the memory
+	gfx::Image3D volume(128, 128, 128, gfx::Texture_Format::R16F);
+	_bake(&volume, PERLIN_WORLEY, true);
+	_save_and_load(&volume);
+
+	volume_id = gfx_backend->createTexture3D(
+		&volume,
+		gfx::Wrapping_Mode::REPEAT,
+		gfx::Filtering_Mode::LINEAR,
+		gfx::Filtering_Mode::LINEAR,
+		false);
+
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+
+	// build and compile our shader program
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	gfx_backend->bindTexture3D(volume_id);
+	gfx_backend->bindGPUProgram(gpu_program);
+	gfx_backend->setGPUProgramFloat(gpu_program, "time", (float)glfwGetTime());
+
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx noise volume", 800, 800);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,218 @@
+#include "gfx.h"
+#include "gfx_bricked_volume.h"
+#include "gfx_noise.h"
+
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 800;
+int scrn_height = 800;
+
+uint32_t vertex_buffer_id, gpu_mesh_id, gpu_program;
+
+std::shared_ptr<gfx::BrickedVolume> bricked_volume;
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 v;
+
+		void main()
+		{
+			v = Position.xy;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+// the volume fills the [-1, 1] box, rays jump over every occupancy cell that holds nothing
+const char* fragmentShader = R"(
+		#version 450 core
+		uniform mat4 inv_view_proj;
+		uniform vec3 camera_pos;
+
+		in vec2 v;
+
+		out vec4 FragColor;
+
+		vec2 intersectBox(vec3 ro, vec3 rd)
+		{
+			vec3 inv = 1.0 / rd;
+			vec3 t0 = (vec3(0.0) - ro) * inv;
+			vec3 t1 = (vec3(1.0) - ro) * inv;
+			vec3 tmin = min(t0, t1);
+			vec3 tmax = max(t0, t1);
+			return vec2(max(max(tmin.x, tmin.y), tmin.z), min(min(tmax.x, tmax.y), tmax.z));
+		}
+
+		void main()
+		{
+			vec4 target = inv_view_proj * vec4(v, 1.0, 1.0);
+			vec3 rd = normalize(target.xyz / target.w - camera_pos) * 0.5;
+			vec3 ro = camera_pos * 0.5 + 0.5;
+
+			vec3 background = vec3(0.1, 0.1, 0.15);
+			vec2 t = intersectBox(ro, rd);
+			if (t.x > t.y || t.y < 0.0)
+			{
+				FragColor = vec4(background, 1.0);
+				return;
+			}
+
+			float step_size = 1.0 / max(max(gfx_volume_size.x, gfx_volume_size.y), gfx_volume_size.z);
+			vec4 acc = vec4(0.0);
+			int samples = 0;
+
+			for (float s = max(t.x, 0.0); s < t.y && acc.a < 0.99 && samples < 1024; ++samples)
+			{
+				vec3 uvw = ro + rd * s;
+
+				// find the coarsest empty cell around the sample and jump to its far side
+				int empty_level = -1;
+				for (int level = gfx_brick_occupancy_levels - 1; level >= 0; --level)
+				{
+					if (gfx_brickOccupancy(uvw, level).y <= gfx_brick_empty_threshold)
+					{
+						empty_level = level;
+						break;
+					}
+				}
+
+				if (empty_level >= 0)
+				{
+					s += gfx_brickExit(uvw, rd, empty_level) + step_size * 0.01;
+					continue;
+				}
+
+				float density = gfx_sampleBrickedVolume(uvw).r;
+				float alpha = 1.0 - exp(-density * step_size * 60.0);
+				acc.rgb += (1.0 - acc.a) * alpha * mix(vec3(0.9, 0.5, 0.2), vec3(1.0), density);
+				acc.a += (1.0 - acc.a) * alpha;
+
+				s += step_size;
+			}
+
+			FragColor = vec4(acc.rgb + (1.0 - acc.a) * background, 1.0);
+		})";
+
+// a noise volume that is only kept inside a few small spheres, the rest stays empty
+inline static gfx::Image3D
+_make_volume(int size)
+{
+	gfx::Image3D volume(size, size, size, gfx::Texture_Format::R8);
+
+	gfx::noise::Noise_Settings perlin_settings;
+	gfx::noise::Noise_Settings worley_settings;
+	worley_settings.octaves = 3;
+	gfx::noise::bakePerlinWorley(&volume, perlin_settings, worley_settings);
+
+	const glm::vec4 spheres[] = {
+		glm::vec4(0.3f, 0.3f, 0.3f, 0.15f),
+		glm::vec4(0.7f, 0.6f, 0.4f, 0.2f),
+		glm::vec4(0.4f, 0.7f, 0.75f, 0.12f),
+	};
+
+	std::vector<float> row(size);
+	for (int z = 0; z < size; ++z)
+	{
+		for (int y = 0; y < size; ++y)
+		{
+			volume.readRow(y, z, row.data());
+			for (int x = 0; x < size; ++x)
+			{
+				auto p = (glm::vec3(x, y, z) + 0.5f) / float(size);
+
+				float mask = 0.0f;
+				for (auto& sphere : spheres)
+					mask = glm::max(mask, 1.0f - glm::length(p - glm::vec3(sphere)) / sphere.w);
+
+				row[x] = mask > 0.0f ? row[x] * glm::min(mask * 3.0f, 1.0f) : 0.0f;
+			}
+			volume.setRow(y, z, row.data());
+		}
+	}
+
+	return volume;
+}
+
+void
+init()
+{
+	auto volume = _make_volume(128);
+
+	bricked_volume = std::make_shared<gfx::BrickedVolume>(8);
+	bricked_volume->build(&volume);
+	bricked_volume->upload(gfx_backend.get());
+
+	auto brick_count = bricked_volume->getBrickCount();
+	std::cout << "occupied bricks: " << bricked_volume->getOccupiedBrickCount() << " / "
+			  << brick_count.x * brick_count.y * brick_count.z << std::endl;
+	std::cout << "memory: " << bricked_volume->getMemorySize() / 1024 << " KB, dense: "
+			  << bricked_volume->getDenseMemorySize() / 1024 << " KB" << std::endl;
+	std::cout << "sparse texture: " << (bricked_volume->isSparse() ? "yes" : "no") << std::endl;
+
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+
+	// build and compile our shader program
+	auto fs = bricked_volume->injectShaderHeader(fragmentShader);
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fs.c_str());
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	float angle = (float)glfwGetTime() * 0.3f;
+	glm::vec3 camera_pos(3.0f * sin(angle), 1.2f, 3.0f * cos(angle));
+
+	auto view = glm::lookAt(camera_pos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	auto projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 100.0f);
+
+	bricked_volume->bind(gfx_backend.get());
+	gfx_backend->bindGPUProgram(gpu_program);
+	gfx_backend->setGPUProgramMat4(gpu_program, "inv_view_proj", glm::inverse(projection * view));
+	gfx_backend->setGPUProgramVec3(gpu_program, "camera_pos", camera_pos);
+
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx bricked volume", scrn_width, scrn_height);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+#include "gfx.h"
+#include "gfx_noise.h"
+#include "gfx_volume_streamer.h"
+
+#include <imgui.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+uint32_t vertex_buffer_id, gpu_mesh_id, gpu_program, volume_id;
+
+const int volume_size = 256;
+
+std::shared_ptr<gfx::VolumeStreamer> streamer;
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 uv;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+// slices that are not streamed in yet show up black
+const char* fragmentShader = R"(
+		#version 450 core
+		uniform sampler3D volume;
+		uniform float time;
+
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			float value = texture(volume, vec3(uv, fract(time * 0.05))).r;
+			FragColor = vec4(vec3(value), 1.0);
+		})";
+
+// writes the raw voxels once, later runs stream the file left in the temp directory
+inline static std::string
+_make_volume_file()
+{
+	auto path = (std::filesystem::temp_directory_path() / "gfx_streaming_volume.raw").string();
+
+	if (std::filesystem::exists(path) &&
+		std::filesystem::file_size(path) == size_t(volume_size) * volume_size * volume_size)
+		return path;
+
+	gfx::Image3D volume(volume_size, volume_size, volume_size, gfx::Texture_Format::R8);
+	gfx::noise::bakePerlin(&volume, gfx::noise::Noise_Settings{});
+
+	std::ofstream file(path, std::ios::binary);
+	auto voxels = volume.getVoxels();
+	file.write((const char*)voxels.data, voxels.size);
+
+	return path;
+}
+
+void
+init()
+{
+	auto path = _make_volume_file();
+
+	// 16 slices of 256x256 per slab, at most 4 slabs a frame
+	streamer = std::make_shared<gfx::VolumeStreamer>(16, 3);
+	streamer->open(path.c_str(), volume_size, volume_size, volume_size, gfx::Texture_Format::R8);
+
+	volume_id = streamer->createTexture(
+		gfx::Wrapping_Mode::REPEAT,
+		gfx::Filtering_Mode::LINEAR,
+		gfx::Filtering_Mode::LINEAR,
+		false);
+
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+
+	// build and compile our shader program
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fragmentShader);
+}
+
+void
+render()
+{
+	auto progress = streamer->update(4);
+
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	gfx_backend->bindTexture3D(volume_id);
+	gfx_backend->bindGPUProgram(gpu_program);
+	gfx_backend->setGPUProgramFloat(gpu_program, "time", (float)glfwGetTime());
+
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+
+	ImGui::ProgressBar(progress);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx volume streaming", 800, 800);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
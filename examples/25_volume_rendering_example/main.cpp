@@ -0,0 +1,206 @@
+#include "gfx.h"
+#include "gfx_fbo.h"
+#include "gfx_noise.h"
+#include "gfx_volume_renderer.h"
+
+#include <imgui.h>
+
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 800;
+int scrn_height = 800;
+
+uint32_t box_vertex_buffer_id, box_gpu_mesh_id, box_gpu_program, depth_gpu_program, volume_id;
+
+std::shared_ptr<gfx::VolumeRenderer> volume_renderer;
+std::shared_ptr<gfx::Framebuffer> depth_frame_buffer;
+
+const char* boxVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		uniform mat4 model;
+		uniform mat4 view;
+		uniform mat4 projection;
+
+		out vec3 world_pos;
+
+		void main()
+		{
+			world_pos = (model * vec4(Position, 1.0)).xyz;
+			gl_Position = projection * view * vec4(world_pos, 1.0);
+		})";
+
+// flat shading from the screen space derivatives, the box has no normals
+const char* boxFragmentShader = R"(
+		#version 450 core
+		in vec3 world_pos;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			vec3 normal = normalize(cross(dFdx(world_pos), dFdy(world_pos)));
+			float light = max(dot(normal, normalize(vec3(0.5, 1.0, 0.3))), 0.0) * 0.8 + 0.2;
+			FragColor = vec4(vec3(0.6, 0.3, 0.2) * light, 1.0);
+		})";
+
+const char* depthFragmentShader = R"(
+		#version 450 core
+		void main()
+		{
+		})";
+
+// a cloud made of perlin-worley noise faded out towards the faces of the volume
+inline static gfx::Image3D
+_make_volume(int size)
+{
+	gfx::Image3D volume(size, size, size, gfx::Texture_Format::R8);
+
+	gfx::noise::Noise_Settings perlin_settings;
+	gfx::noise::Noise_Settings worley_settings;
+	worley_settings.octaves = 3;
+	gfx::noise::bakePerlinWorley(&volume, perlin_settings, worley_settings);
+
+	std::vector<float> row(size);
+	for (int z = 0; z < size; ++z)
+	{
+		for (int y = 0; y < size; ++y)
+		{
+			volume.readRow(y, z, row.data());
+			for (int x = 0; x < size; ++x)
+			{
+				auto p = (glm::vec3(x, y, z) + 0.5f) / float(size) * 2.0f - 1.0f;
+				float fade = glm::clamp(1.0f - glm::length(p), 0.0f, 1.0f);
+				row[x] = glm::clamp((row[x] - 0.45f) * 4.0f * fade, 0.0f, 1.0f);
+			}
+			volume.setRow(y, z, row.data());
+		}
+	}
+
+	return volume;
+}
+
+void
+init()
+{
+	auto volume = _make_volume(128);
+
+	volume_id = gfx_backend->createTexture3D(
+		&volume,
+		gfx::Wrapping_Mode::CLAMP_TO_EDGE,
+		gfx::Filtering_Mode::LINEAR,
+		gfx::Filtering_Mode::LINEAR,
+		false);
+
+	volume_renderer = std::make_shared<gfx::VolumeRenderer>(scrn_width, scrn_height);
+	volume_renderer->init(gfx_backend.get());
+	volume_renderer->setVolume(volume_id, &volume);
+
+	depth_frame_buffer = std::make_shared<gfx::Framebuffer>(scrn_width, scrn_height, gfx::DepthBuffer);
+
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, -1.0f,   1.0f,  1.0f, -1.0f,   1.0f, -1.0f, -1.0f,
+		 1.0f,  1.0f, -1.0f,  -1.0f, -1.0f, -1.0f,  -1.0f,  1.0f, -1.0f,
+		-1.0f, -1.0f,  1.0f,   1.0f, -1.0f,  1.0f,   1.0f,  1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,  -1.0f,  1.0f,  1.0f,  -1.0f, -1.0f,  1.0f,
+		-1.0f,  1.0f,  1.0f,  -1.0f,  1.0f, -1.0f,  -1.0f, -1.0f, -1.0f,
+		-1.0f, -1.0f, -1.0f,  -1.0f, -1.0f,  1.0f,  -1.0f,  1.0f,  1.0f,
+		 1.0f,  1.0f,  1.0f,   1.0f, -1.0f, -1.0f,   1.0f,  1.0f, -1.0f,
+		 1.0f, -1.0f, -1.0f,   1.0f,  1.0f,  1.0f,   1.0f, -1.0f,  1.0f,
+		-1.0f, -1.0f, -1.0f,   1.0f, -1.0f, -1.0f,   1.0f, -1.0f,  1.0f,
+		 1.0f, -1.0f,  1.0f,  -1.0f, -1.0f,  1.0f,  -1.0f, -1.0f, -1.0f,
+		-1.0f,  1.0f, -1.0f,   1.0f,  1.0f,  1.0f,   1.0f,  1.0f, -1.0f,
+		 1.0f,  1.0f,  1.0f,  -1.0f,  1.0f, -1.0f,  -1.0f,  1.0f,  1.0f
+	};
+	// clang-format on
+
+	box_vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	box_gpu_mesh_id = gfx_backend->createGPUMesh(box_vertex_buffer_id, attributes);
+
+	// build and compile our shader programs
+	box_gpu_program = gfx_backend->createGPUProgram(boxVertexShader, boxFragmentShader);
+	depth_gpu_program = gfx_backend->createGPUProgram(boxVertexShader, depthFragmentShader);
+
+	gfx_backend->enableSetting(gfx::GFX_Settings::DEPTH_TEST);
+}
+
+inline static void
+_draw_box(uint32_t gpu_program, const glm::mat4& model, const glm::mat4& view, const glm::mat4& projection)
+{
+	gfx_backend->bindGPUProgram(gpu_program);
+	gfx_backend->setGPUProgramMat4(gpu_program, "model", model);
+	gfx_backend->setGPUProgramMat4(gpu_program, "view", view);
+	gfx_backend->setGPUProgramMat4(gpu_program, "projection", projection);
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, box_gpu_mesh_id, 36);
+}
+
+void
+render()
+{
+	float angle = (float)glfwGetTime() * 0.2f;
+	glm::vec3 camera_pos(3.0f * sin(angle), 1.0f, 3.0f * cos(angle));
+
+	auto view = glm::lookAt(camera_pos, glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	auto projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 100.0f);
+
+	// the pillar goes through the cloud, the volume maps its unit box to [-1, 1]
+	auto box_model = glm::scale(glm::mat4(1.0f), glm::vec3(0.15f, 1.5f, 0.15f));
+	auto volume_model = glm::scale(glm::translate(glm::mat4(1.0f), glm::vec3(-1.0f)), glm::vec3(2.0f));
+
+	// the volume stops at the scene depth
+	depth_frame_buffer->Bind();
+	gfx_backend->clearBuffer();
+	_draw_box(depth_gpu_program, box_model, view, projection);
+	depth_frame_buffer->Unbind();
+
+	gfx_backend->setClearColor(glm::vec4(0.1f, 0.1f, 0.15f, 1.0f));
+	gfx_backend->clearBuffer();
+	_draw_box(box_gpu_program, box_model, view, projection);
+
+	volume_renderer->render(gfx_backend.get(), volume_model, view, projection, depth_frame_buffer->GetTexture());
+
+	auto settings = volume_renderer->getSettings();
+	ImGui::SliderFloat("resolution scale", &settings.resolution_scale, 0.25f, 1.0f);
+	ImGui::SliderFloat("step size", &settings.step_size, 0.25f, 2.0f);
+	ImGui::SliderFloat("max step scale", &settings.max_step_scale, 1.0f, 8.0f);
+	ImGui::SliderFloat("density", &settings.density_scale, 1.0f, 200.0f);
+	ImGui::SliderFloat("depth tolerance", &settings.depth_tolerance, 0.01f, 1.0f);
+	ImGui::Checkbox("blue noise jitter", &settings.jitter);
+	volume_renderer->setSettings(settings);
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+
+	depth_frame_buffer->Resize(width, height);
+	volume_renderer->resize(width, height);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx volume rendering", scrn_width, scrn_height);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
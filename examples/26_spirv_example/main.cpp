@@ -0,0 +1,116 @@
+#include "gfx.h"
+#include "gfx_program.h"
+#include "gfx_spirv.h"
+
+#include <imgui.h>
+
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+uint32_t vertex_buffer_id, gpu_mesh_id;
+
+// the same modules specialized twice, with and without the checker pattern
+uint32_t checker_program, plain_program;
+bool use_checker = true;
+
+// both paths get the same scale, as a specialization constant or as a define
+const float checker_scale = 12.0f;
+
+inline static std::string
+_read_file(const std::string& path)
+{
+	std::ifstream file(path);
+	std::stringstream buffer;
+	buffer << file.rdbuf();
+	return buffer.str();
+}
+
+// the driver compiles the glsl when the modules weren't built or ARB_gl_spirv is missing
+inline static uint32_t
+_create_glsl_program(bool checker)
+{
+	auto vs = _read_file(SHADER_DIR "checker.vert");
+	auto fs = _read_file(SHADER_DIR "checker.frag");
+	fs = gfx::injectDefines(
+		fs.c_str(),
+		{checker ? "USE_CHECKER true" : "USE_CHECKER false", "CHECKER_SCALE " + std::to_string(checker_scale)});
+	return gfx_backend->createGPUProgram(vs.c_str(), fs.c_str());
+}
+
+void
+init()
+{
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+
+	std::vector<uint32_t> vs, fs;
+	if (gfx::isSpirvSupported())
+	{
+		vs = gfx::loadSpirv(SPIRV_DIR "checker.vert.spv");
+		fs = gfx::loadSpirv(SPIRV_DIR "checker.frag.spv");
+	}
+
+	if (vs.empty() || fs.empty())
+	{
+		std::cout << "SPIR-V path unavailable, compiling the glsl sources" << std::endl;
+		checker_program = _create_glsl_program(true);
+		plain_program = _create_glsl_program(false);
+		return;
+	}
+
+	// constant 0 is USE_CHECKER, constant 1 the checker scale passed by its float bits
+	uint32_t scale_bits;
+	memcpy(&scale_bits, &checker_scale, sizeof(checker_scale));
+
+	checker_program = gfx_backend->createGPUProgramSPIRV(vs, fs, {{0, 1}, {1, scale_bits}});
+	plain_program = gfx_backend->createGPUProgramSPIRV(vs, fs, {{0, 0}});
+	std::cout << "loaded SPIR-V modules" << std::endl;
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	ImGui::Checkbox("checker", &use_checker);
+
+	auto program = use_checker ? checker_program : plain_program;
+	gfx_backend->bindGPUProgram(program);
+
+	// the uniform is set by location, the modules don't keep its name
+	glProgramUniform1f(program, 0, (float)glfwGetTime());
+
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx spirv", 800, 800);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
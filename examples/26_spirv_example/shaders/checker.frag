@@ -0,0 +1,36 @@
+#version 450 core
+
+// the toggles are specialization constants in the SPIR-V build, GL_SPIRV is only defined there,
+// the glsl fallback gets them as defines
+#ifdef GL_SPIRV
+layout(constant_id = 0) const bool USE_CHECKER = true;
+layout(constant_id = 1) const float CHECKER_SCALE = 8.0;
+#else
+#ifndef USE_CHECKER
+#define USE_CHECKER true
+#endif
+#ifndef CHECKER_SCALE
+#define CHECKER_SCALE 8.0
+#endif
+#endif
+
+layout(location = 0) in vec2 uv;
+
+layout(location = 0) out vec4 FragColor;
+
+// spir-v drops the uniform names, the location is used instead
+layout(location = 0) uniform float time;
+
+void main()
+{
+	vec3 color = vec3(0.5 + 0.5 * cos(time + uv.xyx * 3.0 + vec3(0.0, 2.0, 4.0)));
+
+	// a constant condition, the branch is gone once the module is specialized
+	if (USE_CHECKER)
+	{
+		vec2 pos = uv * CHECKER_SCALE;
+		color *= mix(0.4, 1.0, mod(floor(pos.x) + floor(pos.y), 2.0));
+	}
+
+	FragColor = vec4(color, 1.0);
+}
\ No newline at end of file
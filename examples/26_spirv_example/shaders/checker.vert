@@ -0,0 +1,11 @@
+#version 450 core
+
+layout(location = 0) in vec3 Position;
+
+layout(location = 0) out vec2 uv;
+
+void main()
+{
+	uv = Position.xy * 0.5 + 0.5;
+	gl_Position = vec4(Position, 1.0);
+}
\ No newline at end of file
@@ -0,0 +1,162 @@
+#include "gfx.h"
+#include "gfx_program_pipeline.h"
+
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+uint32_t vertex_buffer_id, gpu_mesh_id;
+
+std::shared_ptr<gfx::ProgramPipelines> pipelines;
+
+// 2 vertex stages x 3 fragment stages, drawn in a grid of 6 cells from 5 compiled stages
+uint32_t vertex_stages[2], fragment_stages[3];
+
+// stages meant for a pipeline redeclare the gl_PerVertex block they write
+const char* flatVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out gl_PerVertex { vec4 gl_Position; };
+		layout (location = 0) out vec2 uv;
+
+		uniform vec2 offset;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			gl_Position = vec4(Position.xy * 0.3 + offset, 0.0, 1.0);
+		})";
+
+const char* waveVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out gl_PerVertex { vec4 gl_Position; };
+		layout (location = 0) out vec2 uv;
+
+		uniform vec2 offset;
+		uniform float time;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			float angle = time + offset.x;
+			mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+			gl_Position = vec4(rotation * Position.xy * 0.25 + offset, 0.0, 1.0);
+		})";
+
+const char* solidFragmentShader = R"(
+		#version 450 core
+		layout (location = 0) in vec2 uv;
+
+		out vec4 FragColor;
+
+		uniform vec3 color;
+
+		void main()
+		{
+			FragColor = vec4(color, 1.0);
+		})";
+
+const char* gradientFragmentShader = R"(
+		#version 450 core
+		layout (location = 0) in vec2 uv;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			FragColor = vec4(uv, 1.0 - uv.x, 1.0);
+		})";
+
+const char* checkerFragmentShader = R"(
+		#version 450 core
+		layout (location = 0) in vec2 uv;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			ivec2 cell = ivec2(floor(uv * 8.0));
+			float c = float((cell.x + cell.y) & 1);
+			FragColor = vec4(mix(vec3(0.1), vec3(0.9), c), 1.0);
+		})";
+
+void
+init()
+{
+	pipelines = std::make_shared<gfx::ProgramPipelines>();
+
+	vertex_stages[0] = pipelines->createStage(GL_VERTEX_SHADER, flatVertexShader);
+	vertex_stages[1] = pipelines->createStage(GL_VERTEX_SHADER, waveVertexShader);
+	fragment_stages[0] = pipelines->createStage(GL_FRAGMENT_SHADER, solidFragmentShader);
+	fragment_stages[1] = pipelines->createStage(GL_FRAGMENT_SHADER, gradientFragmentShader);
+	fragment_stages[2] = pipelines->createStage(GL_FRAGMENT_SHADER, checkerFragmentShader);
+
+	// uniforms belong to the stage declaring them, they're set once for every pipeline using the stage
+	gfx_backend->setGPUProgramVec3(fragment_stages[0], "color", glm::vec3(0.9f, 0.4f, 0.2f));
+
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.1f, 0.1f, 0.15f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	gfx_backend->setGPUProgramFloat(vertex_stages[1], "time", (float)glfwGetTime());
+
+	for (int row = 0; row < 2; ++row)
+	{
+		for (int column = 0; column < 3; ++column)
+		{
+			auto vs = vertex_stages[row];
+			auto fs = fragment_stages[column];
+			if (vs == 0 || fs == 0)
+				continue;
+
+			gfx_backend->setGPUProgramVec2(vs, "offset", glm::vec2(-0.66f + 0.66f * column, 0.4f - 0.8f * row));
+
+			pipelines->bind(pipelines->getPipeline(vs, fs));
+			gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+		}
+	}
+
+	static bool printed = false;
+	if (!printed)
+	{
+		std::cout << "stages: " << pipelines->getStageCount() << ", pipelines: " << pipelines->getPipelineCount()
+				  << std::endl;
+		printed = true;
+	}
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx separable pipelines", 800, 800);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
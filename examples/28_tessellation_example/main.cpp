@@ -0,0 +1,221 @@
+#include "gfx.h"
+#include "gfx_shader_preprocessor.h"
+#include "gfx_tessellation.h"
+
+#include <imgui.h>
+
+#include <iostream>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 1024;
+int scrn_height = 768;
+
+uint32_t vertex_buffer_id, index_buffer_id, gpu_mesh_id, gpu_program;
+
+gfx::ShaderPreprocessor shader_preprocessor;
+gfx::Tessellation_Settings tessellation_settings;
+
+glm::mat4 projection;
+
+// spheres lined up away from the camera, they are all refined from the same 12 vertices icosahedron
+const int sphere_count = 6;
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec3 control_pos;
+
+		void main()
+		{
+			control_pos = Position;
+		})";
+
+// every outer level comes from the edge it belongs to, the inner level follows the largest of them
+const char* tessControlShader = R"(
+		#version 450 core
+		#include "gfx/tessellation.glsl"
+
+		layout (vertices = 3) out;
+
+		in vec3 control_pos[];
+		out vec3 patch_pos[];
+
+		uniform mat4 model;
+		uniform mat4 view;
+		uniform mat4 projection;
+		uniform float viewport_height;
+		uniform float edge_pixels;
+		uniform float max_level;
+
+		void main()
+		{
+			patch_pos[gl_InvocationID] = control_pos[gl_InvocationID];
+
+			if (gl_InvocationID == 0)
+			{
+				vec3 p[3];
+				for (int i = 0; i < 3; ++i)
+					p[i] = (view * model * vec4(control_pos[i], 1.0)).xyz;
+
+				// outer level i is the edge facing vertex i
+				gl_TessLevelOuter[0] = edgeTessLevel(p[1], p[2], projection, viewport_height, edge_pixels, max_level);
+				gl_TessLevelOuter[1] = edgeTessLevel(p[2], p[0], projection, viewport_height, edge_pixels, max_level);
+				gl_TessLevelOuter[2] = edgeTessLevel(p[0], p[1], projection, viewport_height, edge_pixels, max_level);
+				gl_TessLevelInner[0] = max(max(gl_TessLevelOuter[0], gl_TessLevelOuter[1]), gl_TessLevelOuter[2]);
+			}
+		})";
+
+// the generated vertices are pushed back onto the unit sphere
+const char* tessEvaluationShader = R"(
+		#version 450 core
+		layout (triangles, equal_spacing, ccw) in;
+
+		in vec3 patch_pos[];
+
+		out vec3 normal;
+
+		uniform mat4 model;
+		uniform mat4 view;
+		uniform mat4 projection;
+
+		void main()
+		{
+			vec3 p = gl_TessCoord.x * patch_pos[0] + gl_TessCoord.y * patch_pos[1] + gl_TessCoord.z * patch_pos[2];
+			vec3 n = normalize(p);
+
+			normal = mat3(model) * n;
+			gl_Position = projection * view * model * vec4(n, 1.0);
+		})";
+
+const char* fragmentShader = R"(
+		#version 450 core
+		in vec3 normal;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			vec3 light_dir = normalize(vec3(0.5, 1.0, 0.8));
+			float diffuse = max(dot(normalize(normal), light_dir), 0.0);
+			FragColor = vec4(vec3(0.9, 0.6, 0.3) * (0.15 + 0.85 * diffuse), 1.0);
+		})";
+
+void
+init()
+{
+	// clang-format off
+	const float t = 1.618034f;
+	float vertices[] = {
+		-1.0f,  t,  0.0f,   1.0f,  t,  0.0f,  -1.0f, -t,  0.0f,   1.0f, -t,  0.0f,
+		 0.0f, -1.0f,  t,   0.0f,  1.0f,  t,   0.0f, -1.0f, -t,   0.0f,  1.0f, -t,
+		 t,  0.0f, -1.0f,   t,  0.0f,  1.0f,  -t,  0.0f, -1.0f,  -t,  0.0f,  1.0f
+	};
+
+	uint32_t indices[] = {
+		0, 11, 5,   0, 5, 1,    0, 1, 7,    0, 7, 10,   0, 10, 11,
+		1, 5, 9,    5, 11, 4,   11, 10, 2,  10, 7, 6,   7, 1, 8,
+		3, 9, 4,    3, 4, 2,    3, 2, 6,    3, 6, 8,    3, 8, 9,
+		4, 9, 5,    2, 4, 11,   6, 2, 10,   8, 6, 7,    9, 8, 1
+	};
+	// clang-format on
+
+	// the control points go on the unit sphere
+	for (int i = 0; i < 36; i += 3)
+	{
+		auto p = glm::normalize(glm::vec3(vertices[i], vertices[i + 1], vertices[i + 2]));
+		vertices[i] = p.x;
+		vertices[i + 1] = p.y;
+		vertices[i + 2] = p.z;
+	}
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+	index_buffer_id = gfx_backend->createIndexBuffer(indices, sizeof(indices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, index_buffer_id, attributes);
+
+	// build and compile our shader program
+	auto tcs = shader_preprocessor.process(tessControlShader);
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, tcs.c_str(), tessEvaluationShader, fragmentShader);
+
+	tessellation_settings.max_level = (float)gfx::maxTessellationLevel();
+
+	std::cout << "control mesh: 12 vertices, 20 patches (a 150x150 sphere takes 22801 vertices)" << std::endl;
+
+	projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 1000.0f);
+
+	gfx_backend->enableSetting(gfx::DEPTH_TEST);
+	gfx_backend->enableSetting(gfx::CULLING);
+}
+
+void
+render()
+{
+	gfx_backend->setClearColor(glm::vec4(0.1f, 0.1f, 0.15f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	ImGui::SliderFloat("edge pixels", &tessellation_settings.edge_pixels, 2.0f, 64.0f);
+
+	float distance = 6.0f + 4.0f * sin((float)glfwGetTime() * 0.5f);
+	auto camera_pos = glm::vec3(0.0f, 1.5f, distance);
+	auto view = glm::lookAt(camera_pos, glm::vec3(0.0f, 0.0f, -20.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+
+	gfx_backend->bindGPUProgram(gpu_program);
+	gfx_backend->setGPUProgramMat4(gpu_program, "view", view);
+	gfx_backend->setGPUProgramMat4(gpu_program, "projection", projection);
+	gfx_backend->setGPUProgramFloat(gpu_program, "viewport_height", (float)scrn_height);
+	gfx_backend->setGPUProgramFloat(gpu_program, "edge_pixels", tessellation_settings.edge_pixels);
+	gfx_backend->setGPUProgramFloat(gpu_program, "max_level", tessellation_settings.max_level);
+	gfx_backend->setPatchVertices(3);
+
+	// the icosahedron edges are 1.05 long on the unit sphere
+	const float control_edge = 1.05f;
+
+	for (int i = 0; i < sphere_count; ++i)
+	{
+		auto center = glm::vec3((i % 2 == 0 ? -1.5f : 1.5f), 0.0f, -6.0f * i);
+		auto model = glm::translate(glm::mat4(1.0f), center);
+		gfx_backend->setGPUProgramMat4(gpu_program, "model", model);
+		gfx_backend->draw_indexed(gfx::GFX_Primitive::PATCHES, gpu_mesh_id, 60);
+
+		auto level = gfx::objectTessellationLevel(
+			center,
+			1.0f,
+			control_edge,
+			view,
+			projection,
+			(float)scrn_height,
+			tessellation_settings);
+		ImGui::Text("sphere %d: level %.1f", i, level);
+	}
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+	projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 1000.0f);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx tessellation", scrn_width, scrn_height);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "gfx.h"
+#include "gfx_render_target_pool.h"
+
+#include <imgui.h>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 1024;
+int scrn_height = 768;
+
+uint32_t vertex_buffer_id, gpu_mesh_id;
+uint32_t scene_program, threshold_program, blur_program, composite_program;
+
+std::shared_ptr<gfx::RenderTargetPool> render_target_pool;
+
+const int blur_iterations = 2;
+
+// every pass draws a fullscreen quad, sources are read through their uv scale since pooled textures can be
+// larger than the viewport rendered to
+const char* vertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 uv;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+const char* sceneFragmentShader = R"(
+		#version 450 core
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		uniform float time;
+		uniform float aspect;
+
+		void main()
+		{
+			vec2 p = (uv - 0.5) * vec2(aspect, 1.0);
+			vec3 color = vec3(0.02, 0.02, 0.05);
+			for (int i = 0; i < 5; ++i)
+			{
+				float angle = time * (0.3 + 0.1 * i) + i * 1.2566;
+				vec2 center = vec2(cos(angle), sin(angle)) * 0.3;
+				float glow = smoothstep(0.05, 0.04, length(p - center));
+				color += glow * vec3(0.5 + 0.5 * cos(i + vec3(0.0, 2.0, 4.0))) * 4.0;
+			}
+			FragColor = vec4(color, 1.0);
+		})";
+
+const char* thresholdFragmentShader = R"(
+		#version 450 core
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		uniform sampler2D source;
+		uniform vec2 source_uv_scale;
+
+		void main()
+		{
+			vec3 color = texture(source, uv * source_uv_scale).rgb;
+			float brightness = max(max(color.r, color.g), color.b);
+			FragColor = vec4(brightness > 1.0 ? color : vec3(0.0), 1.0);
+		})";
+
+const char* blurFragmentShader = R"(
+		#version 450 core
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		uniform sampler2D source;
+		uniform vec2 source_uv_scale;
+		uniform vec2 direction;
+
+		void main()
+		{
+			const float weights[5] = float[](0.227027, 0.1945946, 0.1216216, 0.054054, 0.016216);
+
+			vec2 texel = direction / vec2(textureSize(source, 0));
+			vec2 limit = source_uv_scale - 0.5 / vec2(textureSize(source, 0));
+			vec3 color = texture(source, uv * source_uv_scale).rgb * weights[0];
+			for (int i = 1; i < 5; ++i)
+			{
+				color += texture(source, min(uv * source_uv_scale + texel * i, limit)).rgb * weights[i];
+				color += texture(source, uv * source_uv_scale - texel * i).rgb * weights[i];
+			}
+			FragColor = vec4(color, 1.0);
+		})";
+
+const char* compositeFragmentShader = R"(
+		#version 450 core
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		layout (binding = 0) uniform sampler2D scene;
+		layout (binding = 1) uniform sampler2D bloom;
+		uniform vec2 scene_uv_scale;
+		uniform vec2 bloom_uv_scale;
+
+		void main()
+		{
+			vec3 color = texture(scene, uv * scene_uv_scale).rgb + texture(bloom, uv * bloom_uv_scale).rgb;
+			FragColor = vec4(color / (color + 1.0), 1.0);
+		})";
+
+void
+init()
+{
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+
+	// build and compile our shader programs
+	scene_program = gfx_backend->createGPUProgram(vertexShader, sceneFragmentShader);
+	threshold_program = gfx_backend->createGPUProgram(vertexShader, thresholdFragmentShader);
+	blur_program = gfx_backend->createGPUProgram(vertexShader, blurFragmentShader);
+	composite_program = gfx_backend->createGPUProgram(vertexShader, compositeFragmentShader);
+
+	render_target_pool = std::make_shared<gfx::RenderTargetPool>();
+}
+
+inline static void
+_draw_pass(uint32_t program, const gfx::Render_Target& target, const gfx::Render_Target* source)
+{
+	render_target_pool->bind(target);
+	gfx_backend->bindGPUProgram(program);
+
+	if (source)
+	{
+		gfx_backend->bindTextureUnit(source->texture, 0);
+		gfx_backend->setGPUProgramVec2(program, "source_uv_scale", source->getUVScale());
+	}
+
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+}
+
+void
+render()
+{
+	render_target_pool->beginFrame();
+
+	gfx::Render_Target_Desc full_desc{gfx::Texture_Format::RGBA16F, scrn_width, scrn_height};
+	gfx::Render_Target_Desc half_desc{gfx::Texture_Format::RGBA16F, scrn_width / 2, scrn_height / 2};
+
+	auto scene = render_target_pool->acquire(full_desc);
+	gfx_backend->setGPUProgramFloat(scene_program, "time", (float)glfwGetTime());
+	gfx_backend->setGPUProgramFloat(scene_program, "aspect", (float)scrn_width / (float)scrn_height);
+	_draw_pass(scene_program, scene, nullptr);
+
+	auto bloom = render_target_pool->acquire(half_desc);
+	_draw_pass(threshold_program, bloom, &scene);
+
+	// each pass releases its source as soon as it's read, the next pass gets the same texture back
+	for (int i = 0; i < blur_iterations * 2; ++i)
+	{
+		auto blurred = render_target_pool->acquire(half_desc);
+		auto direction = i % 2 == 0 ? glm::vec2(1.0f, 0.0f) : glm::vec2(0.0f, 1.0f);
+		gfx_backend->setGPUProgramVec2(blur_program, "direction", direction);
+		_draw_pass(blur_program, blurred, &bloom);
+
+		render_target_pool->release(bloom);
+		bloom = blurred;
+	}
+
+	render_target_pool->unbind(scrn_width, scrn_height);
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	gfx_backend->bindGPUProgram(composite_program);
+	gfx_backend->bindTextureUnit(scene.texture, 0);
+	gfx_backend->bindTextureUnit(bloom.texture, 1);
+	gfx_backend->setGPUProgramVec2(composite_program, "scene_uv_scale", scene.getUVScale());
+	gfx_backend->setGPUProgramVec2(composite_program, "bloom_uv_scale", bloom.getUVScale());
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+
+	// 6 passes write to 3 textures, resizing the window only allocates past the size granularity
+	ImGui::Text("pooled textures: %u", render_target_pool->getTextureCount());
+	ImGui::Text("allocations: %u", render_target_pool->getAllocationCount());
+	ImGui::Text("memory: %zu KB", render_target_pool->getMemorySize() / 1024);
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx render target pool", scrn_width, scrn_height);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
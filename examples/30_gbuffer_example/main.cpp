@@ -0,0 +1,257 @@
+#include "gfx.h"
+#include "gfx_fbo.h"
+
+#include <vector>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 1024;
+int scrn_height = 768;
+
+uint32_t cube_buffer_id, cube_mesh_id, quad_buffer_id, quad_mesh_id;
+uint32_t gbuffer_program, display_program;
+
+// the smallest format that holds each attribute: 8 bit albedo, 2x16 bit octahedral normal, 32 bit object id
+std::shared_ptr<gfx::Framebuffer> gbuffer;
+
+const int cube_count = 16;
+
+const char* gbufferVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec3 world_pos;
+		flat out uint object_id;
+
+		uniform mat4 view;
+		uniform mat4 projection;
+		uniform float time;
+
+		void main()
+		{
+			float angle = time * 0.5 + gl_InstanceID * 0.7;
+			vec3 offset = vec3((gl_InstanceID % 4) - 1.5, (gl_InstanceID / 4) - 1.5, 0.0) * 1.6;
+			mat3 rotation = mat3(cos(angle), 0.0, -sin(angle), 0.0, 1.0, 0.0, sin(angle), 0.0, cos(angle));
+
+			world_pos = rotation * Position + offset;
+			object_id = uint(gl_InstanceID + 1);
+			gl_Position = projection * view * vec4(world_pos, 1.0);
+		})";
+
+const char* gbufferFragmentShader = R"(
+		#version 450 core
+		in vec3 world_pos;
+		flat in uint object_id;
+
+		layout (location = 0) out vec4 albedo;
+		layout (location = 1) out vec2 normal;
+		layout (location = 2) out uint id;
+
+		vec2 octahedralEncode(vec3 n)
+		{
+			n /= abs(n.x) + abs(n.y) + abs(n.z);
+			vec2 e = n.z >= 0.0 ? n.xy : (1.0 - abs(n.yx)) * sign(n.xy);
+			return e * 0.5 + 0.5;
+		}
+
+		void main()
+		{
+			vec3 n = normalize(cross(dFdx(world_pos), dFdy(world_pos)));
+			albedo = vec4(0.5 + 0.5 * cos(float(object_id) + vec3(0.0, 2.0, 4.0)), 1.0);
+			normal = octahedralEncode(n);
+			id = object_id;
+		})";
+
+const char* displayVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 uv;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+// the four attachments side by side, top left albedo, top right normal, bottom left id, bottom right depth
+const char* displayFragmentShader = R"(
+		#version 450 core
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		layout (binding = 0) uniform sampler2D albedo;
+		layout (binding = 1) uniform sampler2D normal;
+		layout (binding = 2) uniform usampler2D id;
+		layout (binding = 3) uniform sampler2D depth;
+
+		vec3 octahedralDecode(vec2 e)
+		{
+			e = e * 2.0 - 1.0;
+			vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+			if (n.z < 0.0)
+				n.xy = (1.0 - abs(n.yx)) * sign(n.xy);
+			return normalize(n);
+		}
+
+		void main()
+		{
+			vec2 tile_uv = fract(uv * 2.0);
+			int tile = int(uv.x >= 0.5) + 2 * int(uv.y < 0.5);
+
+			vec3 color;
+			if (tile == 0)
+				color = texture(albedo, tile_uv).rgb;
+			else if (tile == 1)
+				color = octahedralDecode(texture(normal, tile_uv).rg) * 0.5 + 0.5;
+			else if (tile == 2)
+			{
+				uint object_id = texelFetch(id, ivec2(tile_uv * textureSize(id, 0)), 0).r;
+				color = object_id == 0u ? vec3(0.0) : fract(vec3(object_id) * vec3(0.13, 0.37, 0.71));
+			}
+			else
+				color = vec3(pow(texture(depth, tile_uv).r, 32.0));
+
+			FragColor = vec4(color, 1.0);
+		})";
+
+inline static std::vector<float>
+_make_cube()
+{
+	std::vector<float> vertices;
+
+	// two triangles for each side, wound counter clockwise seen from outside
+	for (int axis = 0; axis < 3; ++axis)
+	{
+		for (float side : {-0.5f, 0.5f})
+		{
+			glm::vec3 corners[4];
+			for (int i = 0; i < 4; ++i)
+			{
+				glm::vec3 p;
+				p[axis] = side;
+				p[(axis + 1) % 3] = (i == 1 || i == 2) ? 0.5f : -0.5f;
+				p[(axis + 2) % 3] = (i >= 2) ? 0.5f : -0.5f;
+				corners[i] = p;
+			}
+
+			int order[6] = {0, 1, 2, 0, 2, 3};
+			if (side < 0.0f)
+			{
+				std::swap(order[1], order[2]);
+				std::swap(order[4], order[5]);
+			}
+
+			for (int index : order)
+				vertices.insert(vertices.end(), {corners[index].x, corners[index].y, corners[index].z});
+		}
+	}
+
+	return vertices;
+}
+
+inline static void
+_make_gbuffer()
+{
+	gfx::Framebuffer_Desc desc;
+	desc.width = scrn_width;
+	desc.height = scrn_height;
+	desc.color_formats = {gfx::Texture_Format::RGBA8, gfx::Texture_Format::RG16, gfx::Texture_Format::R32UI};
+	desc.depth_format = gfx::Depth_Format::DEPTH32F;
+	desc.sampleable_depth = true;
+
+	gbuffer = std::make_shared<gfx::Framebuffer>(desc);
+}
+
+void
+init()
+{
+	auto cube = _make_cube();
+	cube_buffer_id = gfx_backend->createVertexBuffer(
+		cube.data(),
+		uint32_t(cube.size() * sizeof(float)),
+		gfx::BUFFER_USAGE::STATIC);
+
+	// clang-format off
+	float quad[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	quad_buffer_id = gfx_backend->createVertexBuffer(quad, sizeof(quad), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	cube_mesh_id = gfx_backend->createGPUMesh(cube_buffer_id, attributes);
+	quad_mesh_id = gfx_backend->createGPUMesh(quad_buffer_id, attributes);
+
+	// build and compile our shader programs
+	gbuffer_program = gfx_backend->createGPUProgram(gbufferVertexShader, gbufferFragmentShader);
+	display_program = gfx_backend->createGPUProgram(displayVertexShader, displayFragmentShader);
+
+	_make_gbuffer();
+}
+
+void
+render()
+{
+	auto view = glm::lookAt(glm::vec3(0.0f, 0.0f, 8.0f), glm::vec3(0.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+	auto projection = glm::perspective(glm::radians(45.0f), (float)scrn_width / (float)scrn_height, 0.1f, 100.0f);
+
+	// geometry pass, every attachment is written at once
+	gbuffer->Bind();
+	gbuffer->Clear(glm::vec4(0.0f));
+
+	gfx_backend->enableSetting(gfx::DEPTH_TEST);
+	gfx_backend->enableSetting(gfx::CULLING);
+	gfx_backend->bindGPUProgram(gbuffer_program);
+	gfx_backend->setGPUProgramMat4(gbuffer_program, "view", view);
+	gfx_backend->setGPUProgramMat4(gbuffer_program, "projection", projection);
+	gfx_backend->setGPUProgramFloat(gbuffer_program, "time", (float)glfwGetTime());
+	gfx_backend->draw_instanced(gfx::GFX_Primitive::TRIANGLES, cube_mesh_id, 36, cube_count);
+
+	gbuffer->Unbind();
+	gfx_backend->disableSetting(gfx::DEPTH_TEST);
+	gfx_backend->disableSetting(gfx::CULLING);
+
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	for (int i = 0; i < gbuffer->GetColorCount(); ++i)
+		gfx_backend->bindTextureUnit(gbuffer->GetColorTexture(i), i);
+	gfx_backend->bindTextureUnit(gbuffer->GetDepthTexture(), 3);
+
+	gfx_backend->bindGPUProgram(display_program);
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, quad_mesh_id, 4);
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+	gbuffer->Resize(width, height);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx g-buffer", scrn_width, scrn_height);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
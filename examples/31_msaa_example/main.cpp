@@ -0,0 +1,246 @@
+#include "gfx.h"
+#include "gfx_fbo.h"
+#include "gfx_shader_preprocessor.h"
+
+#include <imgui.h>
+
+#include <vector>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 1024;
+int scrn_height = 768;
+
+uint32_t star_buffer_id, star_mesh_id, quad_buffer_id, quad_mesh_id;
+uint32_t scene_program, tonemap_program, resolve_program;
+uint32_t star_vertices_count;
+
+gfx::ShaderPreprocessor shader_preprocessor;
+
+// the scene goes to a multisampled hdr target, resolved with a blit into a single sampled one or straight to
+// the window by the hdr resolve shader
+std::shared_ptr<gfx::Framebuffer> msaa_buffer, resolved_buffer;
+
+const int sample_counts[] = {1, 2, 4, 8};
+int sample_count_index = 2;
+bool shader_resolve = true;
+
+const char* sceneVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out float intensity;
+
+		uniform float time;
+		uniform float aspect;
+
+		void main()
+		{
+			float angle = time * 0.2;
+			mat2 rotation = mat2(cos(angle), sin(angle), -sin(angle), cos(angle));
+			intensity = Position.z;
+			gl_Position = vec4(rotation * Position.xy * vec2(1.0 / aspect, 1.0), 0.0, 1.0);
+		})";
+
+// the spikes get brighter toward the tips, well past 1
+const char* sceneFragmentShader = R"(
+		#version 450 core
+		in float intensity;
+
+		out vec4 FragColor;
+
+		void main()
+		{
+			FragColor = vec4(vec3(1.0, 0.7, 0.3) * intensity, 1.0);
+		})";
+
+const char* quadVertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 uv;
+
+		void main()
+		{
+			uv = Position.xy * 0.5 + 0.5;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+const char* tonemapFragmentShader = R"(
+		#version 450 core
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		uniform sampler2D color;
+
+		void main()
+		{
+			vec3 hdr = texture(color, uv).rgb;
+			FragColor = vec4(hdr / (hdr + 1.0), 1.0);
+		})";
+
+const char* resolveFragmentShader = R"(
+		#version 450 core
+		#include "gfx/msaa.glsl"
+
+		out vec4 FragColor;
+
+		uniform sampler2DMS color;
+		uniform int samples;
+
+		void main()
+		{
+			vec3 hdr = resolveHDR(color, ivec2(gl_FragCoord.xy), samples).rgb;
+			FragColor = vec4(hdr / (hdr + 1.0), 1.0);
+		})";
+
+inline static std::vector<float>
+_make_star(int spikes)
+{
+	std::vector<float> vertices;
+
+	// thin triangles from the center, z carries the brightness
+	for (int i = 0; i < spikes; ++i)
+	{
+		float angle = glm::two_pi<float>() * i / spikes;
+		float width = 0.01f;
+		float length = 0.3f + 0.6f * float((i * 7) % 5) / 4.0f;
+
+		auto left = glm::vec2(glm::cos(angle - width), glm::sin(angle - width)) * 0.1f;
+		auto right = glm::vec2(glm::cos(angle + width), glm::sin(angle + width)) * 0.1f;
+		auto tip = glm::vec2(glm::cos(angle), glm::sin(angle)) * length;
+
+		vertices.insert(vertices.end(), {0.0f, 0.0f, 0.5f, left.x, left.y, 1.0f, tip.x, tip.y, 16.0f});
+		vertices.insert(vertices.end(), {0.0f, 0.0f, 0.5f, tip.x, tip.y, 16.0f, right.x, right.y, 1.0f});
+	}
+
+	return vertices;
+}
+
+inline static void
+_make_framebuffers()
+{
+	gfx::Framebuffer_Desc desc;
+	desc.width = scrn_width;
+	desc.height = scrn_height;
+	desc.color_formats = {gfx::Texture_Format::RGBA16F};
+	desc.depth_format = gfx::Depth_Format::DEPTH24;
+	desc.samples = sample_counts[sample_count_index];
+	msaa_buffer = std::make_shared<gfx::Framebuffer>(desc);
+
+	// only the color is sampled afterwards, the resolved target needs no depth
+	desc.depth_format = gfx::Depth_Format::NO_DEPTH;
+	desc.samples = 1;
+	resolved_buffer = std::make_shared<gfx::Framebuffer>(desc);
+}
+
+void
+init()
+{
+	auto star = _make_star(48);
+	star_vertices_count = uint32_t(star.size() / 3);
+	star_buffer_id = gfx_backend->createVertexBuffer(
+		star.data(),
+		uint32_t(star.size() * sizeof(float)),
+		gfx::BUFFER_USAGE::STATIC);
+
+	// clang-format off
+	float quad[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	quad_buffer_id = gfx_backend->createVertexBuffer(quad, sizeof(quad), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	star_mesh_id = gfx_backend->createGPUMesh(star_buffer_id, attributes);
+	quad_mesh_id = gfx_backend->createGPUMesh(quad_buffer_id, attributes);
+
+	// build and compile our shader programs
+	scene_program = gfx_backend->createGPUProgram(sceneVertexShader, sceneFragmentShader);
+	tonemap_program = gfx_backend->createGPUProgram(quadVertexShader, tonemapFragmentShader);
+	auto resolve = shader_preprocessor.process(resolveFragmentShader);
+	resolve_program = gfx_backend->createGPUProgram(quadVertexShader, resolve.c_str());
+
+	_make_framebuffers();
+}
+
+void
+render()
+{
+	const char* sample_names[] = {"off", "2x", "4x", "8x"};
+	if (ImGui::Combo("msaa", &sample_count_index, sample_names, 4))
+		_make_framebuffers();
+	ImGui::Checkbox("hdr shader resolve", &shader_resolve);
+
+	auto samples = msaa_buffer->GetDesc().samples;
+
+	msaa_buffer->Bind();
+	msaa_buffer->Clear(glm::vec4(0.02f, 0.02f, 0.05f, 1.0f));
+
+	gfx_backend->bindGPUProgram(scene_program);
+	gfx_backend->setGPUProgramFloat(scene_program, "time", (float)glfwGetTime());
+	gfx_backend->setGPUProgramFloat(scene_program, "aspect", (float)scrn_width / (float)scrn_height);
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES, star_mesh_id, star_vertices_count);
+
+	msaa_buffer->Unbind();
+
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+
+	if (samples > 1 && shader_resolve)
+	{
+		// tonemapping weighted samples in one pass, nothing else is written
+		gfx_backend->bindTextureUnit(msaa_buffer->GetTexture(), 0);
+		gfx_backend->bindGPUProgram(resolve_program);
+		gfx_backend->setGPUProgramInt(resolve_program, "samples", samples);
+	}
+	else
+	{
+		auto texture = msaa_buffer->GetTexture();
+		if (samples > 1)
+		{
+			msaa_buffer->Resolve(resolved_buffer.get());
+			texture = resolved_buffer->GetTexture();
+		}
+
+		gfx_backend->bindTextureUnit(texture, 0);
+		gfx_backend->bindGPUProgram(tonemap_program);
+	}
+
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, quad_mesh_id, 4);
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+	msaa_buffer->Resize(width, height);
+	resolved_buffer->Resize(width, height);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	// the window itself is single sampled, antialiasing is only paid for in the offscreen target
+	gfx_backend->init("gfx msaa", scrn_width, scrn_height, 0);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
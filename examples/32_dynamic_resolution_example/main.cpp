@@ -0,0 +1,192 @@
+#include "gfx.h"
+#include "gfx_dynamic_resolution.h"
+#include "gfx_shader_preprocessor.h"
+
+#include <imgui.h>
+
+// global
+auto gfx_backend = std::make_shared<gfx::GFX>();
+
+int scrn_width = 1280;
+int scrn_height = 720;
+
+uint32_t vertex_buffer_id, gpu_mesh_id, gpu_program;
+
+// the displacement noise comes from the shader library
+gfx::ShaderPreprocessor shader_preprocessor;
+
+// the scene renders at whatever fraction of the window keeps it near the target gpu time, the ui stays native
+std::shared_ptr<gfx::DynamicResolution> dynamic_resolution;
+
+// extra work per pixel, raise it to watch the scale drop
+int load = 4;
+
+const char* vertexShader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 v;
+
+		void main()
+		{
+			v = Position.xy;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+// a field of displaced spheres marched with a fixed step budget, load repeats the displacement noise
+const char* fragmentShader = R"(
+		#version 450 core
+		uniform float time;
+		uniform float aspect;
+		uniform int load;
+
+		in vec2 v;
+
+		out vec4 FragColor;
+
+		#include "gfx/noise.glsl"
+
+		float scene(vec3 p)
+		{
+			vec3 cell = vec3(mod(p.xz + 2.0, 4.0) - 2.0, p.y).xzy;
+			float d = length(cell - vec3(0.0, 1.0, 0.0)) - 1.0;
+
+			float displacement = 0.0;
+			for (int i = 0; i < load; ++i)
+				displacement += noise(p * 4.0 * float(i + 1) + time) / float(i + 1);
+
+			return min(d + displacement * 0.08, p.y);
+		}
+
+		vec3 normal(vec3 p)
+		{
+			vec2 e = vec2(0.002, 0.0);
+			return normalize(vec3(
+				scene(p + e.xyy) - scene(p - e.xyy),
+				scene(p + e.yxy) - scene(p - e.yxy),
+				scene(p + e.yyx) - scene(p - e.yyx)));
+		}
+
+		void main()
+		{
+			vec3 ro = vec3(time * 0.5, 2.5, time * 0.3);
+			vec3 rd = normalize(vec3(v.x * aspect, v.y - 0.4, 1.5));
+
+			vec3 sky = mix(vec3(0.6, 0.7, 0.9), vec3(0.2, 0.3, 0.6), clamp(rd.y, 0.0, 1.0));
+
+			float t = 0.0;
+			for (int i = 0; i < 128 && t < 40.0; ++i)
+			{
+				float d = scene(ro + rd * t);
+				if (d < 0.001 * t)
+					break;
+				t += d * 0.8;
+			}
+
+			if (t >= 40.0)
+			{
+				FragColor = vec4(sky, 1.0);
+				return;
+			}
+
+			vec3 p = ro + rd * t;
+			vec3 n = normal(p);
+			vec3 light = normalize(vec3(0.5, 0.8, 0.3));
+			vec3 albedo = p.y < 0.01 ? vec3(0.3 + 0.2 * mod(floor(p.x) + floor(p.z), 2.0)) : vec3(0.9, 0.5, 0.3);
+			vec3 color = albedo * (max(dot(n, light), 0.0) + 0.15);
+
+			FragColor = vec4(mix(color, sky, 1.0 - exp(-t * 0.04)), 1.0);
+		})";
+
+void
+init()
+{
+	gfx::Dynamic_Resolution_Settings settings;
+	settings.target_ms = 8.0f;
+
+	dynamic_resolution = std::make_shared<gfx::DynamicResolution>(
+		scrn_width,
+		scrn_height,
+		gfx::Texture_Format::RGBA8,
+		gfx::Depth_Format::NO_DEPTH,
+		settings);
+	dynamic_resolution->init(gfx_backend.get());
+
+	// clang-format off
+	float vertices[] = {
+		-1.0f, -1.0f, 0.0f,
+		 1.0f, -1.0f, 0.0f,
+		-1.0f,  1.0f, 0.0f,
+		 1.0f,  1.0f, 0.0f
+	};
+	// clang-format on
+
+	vertex_buffer_id = gfx_backend->createVertexBuffer(vertices, sizeof(vertices), gfx::BUFFER_USAGE::STATIC);
+
+	gfx::Attributes attributes;
+	attributes.append(gfx::GPU_Attribute(gfx::GPU_Attribute::VEC3, "POSITION"));
+
+	gpu_mesh_id = gfx_backend->createGPUMesh(vertex_buffer_id, attributes);
+
+	// build and compile our shader program
+	auto fs = shader_preprocessor.process(fragmentShader);
+	gpu_program = gfx_backend->createGPUProgram(vertexShader, fs.c_str());
+}
+
+void
+render()
+{
+	dynamic_resolution->begin();
+
+	gfx_backend->bindGPUProgram(gpu_program);
+	gfx_backend->setGPUProgramFloat(gpu_program, "time", (float)glfwGetTime());
+	gfx_backend->setGPUProgramFloat(gpu_program, "aspect", (float)scrn_width / (float)scrn_height);
+	gfx_backend->setGPUProgramInt(gpu_program, "load", load);
+	gfx_backend->draw(gfx::GFX_Primitive::TRIANGLES_STRIP, gpu_mesh_id, 4);
+
+	dynamic_resolution->end();
+
+	gfx_backend->setClearColor(glm::vec4(0.0f, 0.0f, 0.0f, 1.0f));
+	gfx_backend->clearBuffer();
+	dynamic_resolution->upscale(gfx_backend.get());
+
+	auto settings = dynamic_resolution->getSettings();
+	auto size = dynamic_resolution->getRenderSize();
+
+	ImGui::Text("gpu: %.2f ms", dynamic_resolution->getGPUTime());
+	ImGui::Text("scale: %.2f (%d x %d)", dynamic_resolution->getScale(), size.x, size.y);
+	ImGui::SliderInt("load", &load, 0, 16);
+
+	bool changed = false;
+	changed |= ImGui::SliderFloat("target ms", &settings.target_ms, 2.0f, 33.0f);
+	changed |= ImGui::SliderFloat("min scale", &settings.min_scale, 0.25f, 1.0f);
+	changed |= ImGui::SliderFloat("max scale", &settings.max_scale, 0.25f, 1.0f);
+	changed |= ImGui::SliderFloat("sharpness", &settings.sharpness, 0.0f, 1.0f);
+	if (changed)
+		dynamic_resolution->setSettings(settings);
+}
+
+void
+resize(int width, int height)
+{
+	if (width == 0 || height == 0)
+		return;
+
+	scrn_width = width;
+	scrn_height = height;
+	dynamic_resolution->resize(width, height);
+}
+
+int
+main()
+{
+	// initialize gfx
+	// ---------------------------------------
+	gfx_backend->init("gfx dynamic resolution", scrn_width, scrn_height);
+	gfx_backend->on_Init(init);
+	gfx_backend->on_Render(render);
+	gfx_backend->on_Resize(resize);
+	gfx_backend->start();
+
+	return 0;
+}
\ No newline at end of file
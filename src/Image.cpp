@@ -1,60 +1,228 @@
 #include "Image.h"
+#include "gfx_formats.h"
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb_image.h>
 
+#include <cstring>
+#include <utility>
+
 namespace gfx
 {
+	// view
+	ImageView::ImageView() : data(nullptr), width(0), height(0), ncomponents(0), type(PIXEL_UNSIGNED_BYTE), row_pitch(0)
+	{
+	}
+
+	ImageView::ImageView(
+		const void* data,
+		uint32_t width,
+		uint32_t height,
+		uint32_t ncomponents,
+		Pixel_Type type,
+		uint32_t row_pitch)
+		: data((const unsigned char*)data),
+		  width(width),
+		  height(height),
+		  ncomponents(ncomponents),
+		  type(type),
+		  row_pitch(row_pitch)
+	{
+		if (this->row_pitch == 0)
+			this->row_pitch = width * stride();
+	}
+
+	ImageView
+	ImageView::subView(uint32_t x, uint32_t y, uint32_t sub_width, uint32_t sub_height) const
+	{
+		return ImageView(pixel(x, y), sub_width, sub_height, ncomponents, type, row_pitch);
+	}
+
+	const unsigned char*
+	ImageView::pixel(uint32_t x, uint32_t y) const
+	{
+		return data + size_t(y) * row_pitch + size_t(x) * stride();
+	}
+
+	const unsigned char*
+	ImageView::row(uint32_t y) const
+	{
+		return data + size_t(y) * row_pitch;
+	}
+
+	uint32_t
+	ImageView::stride() const
+	{
+		return ncomponents * pixelTypeSize(type);
+	}
+
+	bool
+	ImageView::isContiguous() const
+	{
+		return row_pitch == width * stride();
+	}
+
+	// image
 	Image::Image()
 	{
 		m_width = 0;
 		m_height = 0;
 		m_ncomponents = 0;
 		m_data = nullptr;
+		m_type = PIXEL_UNSIGNED_BYTE;
+		m_allocator = ImageAllocator::heap();
 	}
 
-	Image::Image(const char* file_name) : m_width(0), m_height(0), m_ncomponents(0), m_data(nullptr)
+	Image::Image(const char* file_name) : Image(file_name, PIXEL_UNSIGNED_BYTE) {}
+
+	Image::Image(const char* file_name, Pixel_Type type) : Image()
 	{
-		m_data = stbi_load(file_name, &m_width, &m_height, &m_ncomponents, 0);
+		m_type = type;
+
+		// stb_image allocates with malloc, which is what the heap allocator releases with
+		switch (type)
+		{
+		case PIXEL_UNSIGNED_BYTE:
+			m_data = stbi_load(file_name, &m_width, &m_height, &m_ncomponents, 0);
+			break;
+		case PIXEL_UNSIGNED_SHORT:
+			m_data = (unsigned char*)stbi_load_16(file_name, &m_width, &m_height, &m_ncomponents, 0);
+			break;
+		case PIXEL_FLOAT:
+			m_data = (unsigned char*)stbi_loadf(file_name, &m_width, &m_height, &m_ncomponents, 0);
+			break;
+		}
 	}
 
-	Image::Image(unsigned char* data, int width, int ncomponents) : m_height(0)
+	Image::Image(unsigned char* data, int width, int ncomponents) : Image(width, 1, ncomponents)
+	{
+		if (m_data)
+			memcpy(m_data, data, getSize());
+	}
+
+	Image::Image(int width, int height, int ncomponents, Pixel_Type type, ImageAllocator* allocator) : Image()
 	{
 		m_width = width;
+		m_height = height;
 		m_ncomponents = ncomponents;
+		m_type = type;
+		m_allocator = allocator;
+
+		m_data = (unsigned char*)m_allocator->allocate(getSize());
+		if (m_data)
+			memset(m_data, 0, getSize());
+	}
 
-		size_t totoal_size = m_width * m_ncomponents;
-		m_data = new unsigned char[totoal_size];
-		memcpy(m_data, data, totoal_size);
+	Image::Image(
+		unsigned char* data,
+		int width,
+		int height,
+		int ncomponents,
+		Pixel_Type type,
+		ImageAllocator* allocator)
+		: Image()
+	{
+		m_data = data;
+		m_width = width;
+		m_height = height;
+		m_ncomponents = ncomponents;
+		m_type = type;
+		m_allocator = allocator;
+	}
+
+	Image::Image(Image&& other) noexcept : Image()
+	{
+		*this = std::move(other);
+	}
+
+	Image&
+	Image::operator=(Image&& other) noexcept
+	{
+		if (this != &other)
+		{
+			reset();
+
+			std::swap(m_data, other.m_data);
+			std::swap(m_width, other.m_width);
+			std::swap(m_height, other.m_height);
+			std::swap(m_ncomponents, other.m_ncomponents);
+			std::swap(m_type, other.m_type);
+			std::swap(m_allocator, other.m_allocator);
+		}
+
+		return *this;
 	}
 
 	Image::~Image()
 	{
-		if (m_data)
-			stbi_image_free(m_data);
+		reset();
 	}
 
 	unsigned char*
-	Image::getData()
+	Image::getData() const
 	{
 		return m_data;
 	}
 
 	uint32_t
-	Image::getWidth()
+	Image::getWidth() const
 	{
 		return m_width;
 	}
 
 	uint32_t
-	Image::getHeight()
+	Image::getHeight() const
 	{
 		return m_height;
 	}
 
 	uint32_t
-	Image::get_NCompnents()
+	Image::get_NCompnents() const
 	{
 		return m_ncomponents;
 	}
-} // namespace gfx
\ No newline at end of file
+
+	Pixel_Type
+	Image::get_PixelType() const
+	{
+		return m_type;
+	}
+
+	size_t
+	Image::getSize() const
+	{
+		return size_t(m_width) * m_height * m_ncomponents * pixelTypeSize(m_type);
+	}
+
+	ImageView
+	Image::view() const
+	{
+		return ImageView(m_data, m_width, m_height, m_ncomponents, m_type);
+	}
+
+	unsigned char*
+	Image::release()
+	{
+		auto res = m_data;
+		m_data = nullptr;
+		return res;
+	}
+
+	ImageAllocator*
+	Image::getAllocator() const
+	{
+		return m_allocator;
+	}
+
+	void
+	Image::reset()
+	{
+		if (m_data && m_allocator)
+			m_allocator->deallocate(m_data, getSize());
+
+		m_data = nullptr;
+		m_width = 0;
+		m_height = 0;
+		m_ncomponents = 0;
+	}
+} // namespace gfx
@@ -1,36 +1,133 @@
 #pragma once
 
+#include "ImageAllocator.h"
+#include "enums.h"
+
 #include <memory>
 
 namespace gfx
 {
+	// non-owning view of image pixels, rows can be part of a bigger image
+	struct ImageView
+	{
+		ImageView();
+
+		// row_pitch of 0 means tightly packed rows
+		ImageView(
+			const void* data,
+			uint32_t width,
+			uint32_t height,
+			uint32_t ncomponents,
+			Pixel_Type type = PIXEL_UNSIGNED_BYTE,
+			uint32_t row_pitch = 0);
+
+		// view of a rectangle inside this view, no pixels are copied
+		ImageView
+		subView(uint32_t x, uint32_t y, uint32_t sub_width, uint32_t sub_height) const;
 
+		const unsigned char*
+		pixel(uint32_t x, uint32_t y) const;
+
+		const unsigned char*
+		row(uint32_t y) const;
+
+		// bytes between two consecutive pixels
+		uint32_t
+		stride() const;
+
+		bool
+		isContiguous() const;
+
+		const unsigned char* data;
+		uint32_t width, height, ncomponents;
+		Pixel_Type type;
+
+		// bytes between two consecutive rows
+		uint32_t row_pitch;
+	};
+
+	// move-only owner of image pixels
 	class Image
 	{
 	public:
 		Image();
 
+		// loads 8-bit pixels with stb_image
 		Image(const char* file_name);
 
+		// loads 8-bit, 16-bit (stbi_load_16) or float (stbi_loadf) pixels
+		Image(const char* file_name, Pixel_Type type);
+
+		// copies a single row of pixels
 		Image(unsigned char* data, int width, int ncomponents);
 
+		// allocates a zero filled width x height image from the allocator
+		Image(
+			int width,
+			int height,
+			int ncomponents,
+			Pixel_Type type = PIXEL_UNSIGNED_BYTE,
+			ImageAllocator* allocator = ImageAllocator::heap());
+
+		// uses data without copying, it is released through the allocator or left to the caller when allocator is null
+		Image(
+			unsigned char* data,
+			int width,
+			int height,
+			int ncomponents,
+			Pixel_Type type,
+			ImageAllocator* allocator);
+
+		Image(const Image&) = delete;
+
+		Image&
+		operator=(const Image&) = delete;
+
+		Image(Image&& other) noexcept;
+
+		Image&
+		operator=(Image&& other) noexcept;
+
 		~Image();
 
 		unsigned char*
-		getData();
+		getData() const;
 
 		uint32_t
-		getWidth();
+		getWidth() const;
 
 		uint32_t
-		getHeight();
+		getHeight() const;
 
 		uint32_t
-		get_NCompnents();
+		get_NCompnents() const;
+
+		Pixel_Type
+		get_PixelType() const;
 
+		// size of the pixels in bytes
+		size_t
+		getSize() const;
+
+		ImageView
+		view() const;
+
+		// gives up ownership of the pixels, the caller releases them through getAllocator()
+		unsigned char*
+		release();
+
+		ImageAllocator*
+		getAllocator() const;
+
+	private:
 		// pointer to image pixels
 		unsigned char* m_data;
 		int m_width, m_height, m_ncomponents;
+		Pixel_Type m_type;
+		ImageAllocator* m_allocator;
+
+		void
+		reset();
 	};
 
-} // namespace gfx
\ No newline at end of file
+} // namespace gfx
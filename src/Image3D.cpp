@@ -1,23 +1,112 @@
 #include "Image3D.h"
+#include "ImageAllocator.h"
+#include "gfx_formats.h"
+#include "gfx_half.h"
+#include "gfx_volume_file.h"
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <utility>
 
 namespace gfx
 {
-	Image3D::Image3D(int width, int height, int depth) : width(width), height(height), depth(depth)
+	// cache line alignment keeps slices friendly to simd loops
+	constexpr size_t IMAGE3D_ALIGNMENT = 64;
+
+	// halfs going to an interleaved channel are converted through a small stack buffer
+	constexpr size_t IMAGE3D_CONVERT_BLOCK = 256;
+
+	inline static float
+	_read_component(const uint8_t* component, size_t component_size)
 	{
-		// Initialize the 3D vector with zero values
-		data.resize(depth, std::vector<std::vector<float>>(height, std::vector<float>(width, 0)));
+		float value = 0.0f;
+		switch (component_size)
+		{
+		case 1:
+			value = *component / 255.0f;
+			break;
+		case 2:
+		{
+			uint16_t half;
+			memcpy(&half, component, sizeof(half));
+			value = halfToFloat(half);
+			break;
+		}
+		default:
+			memcpy(&value, component, sizeof(value));
+			break;
+		}
+
+		return value;
 	}
 
-	Image3D::~Image3D() {}
+	Image3D::Image3D() : width(0), height(0), depth(0), format(Texture_Format::R32F), data(nullptr) {}
+
+	Image3D::Image3D(int width, int height, int depth, Texture_Format format)
+		: width(width), height(height), depth(depth), format(format), data(nullptr)
+	{
+		if (width <= 0 || height <= 0 || depth <= 0)
+		{
+			this->width = this->height = this->depth = 0;
+			return;
+		}
+
+		if (!isSupportedFormat(format))
+		{
+			std::cout << "Unsupported Image3D format" << std::endl;
+			this->width = this->height = this->depth = 0;
+			return;
+		}
+
+		// Initialize the voxels with zero values
+		data = (uint8_t*)alignedAlloc(getSizeInBytes(), IMAGE3D_ALIGNMENT);
+		if (data == nullptr)
+		{
+			std::cout << "Cannot allocate Image3D voxels" << std::endl;
+			this->width = this->height = this->depth = 0;
+			return;
+		}
+
+		memset(data, 0, getSizeInBytes());
+	}
+
+	Image3D::Image3D(Image3D&& other) noexcept : Image3D()
+	{
+		*this = std::move(other);
+	}
+
+	Image3D&
+	Image3D::operator=(Image3D&& other) noexcept
+	{
+		if (this != &other)
+		{
+			alignedFree(data);
+			data = nullptr;
+			width = height = depth = 0;
+
+			std::swap(width, other.width);
+			std::swap(height, other.height);
+			std::swap(depth, other.depth);
+			std::swap(format, other.format);
+			std::swap(data, other.data);
+		}
+
+		return *this;
+	}
+
+	Image3D::~Image3D()
+	{
+		alignedFree(data);
+	}
 
 	void
-	Image3D::setPixel(int x, int y, int z, float value)
+	Image3D::setPixel(int x, int y, int z, float value, int channel)
 	{
-		if (isValidPixel(x, y, z))
+		if (isValidPixel(x, y, z) && channel >= 0 && channel < getChannels())
 		{
-			data[z][y][x] = value;
+			auto component_size = getVoxelSize() / getChannels();
+			convertValues(&value, data + index(x, y, z) * getVoxelSize() + channel * component_size, 1, 0);
 		}
 		else
 		{
@@ -26,52 +115,133 @@ namespace gfx
 	}
 
 	float
-	Image3D::getPixel(int x, int y, int z)
+	Image3D::getPixel(int x, int y, int z, int channel)
 	{
-		if (isValidPixel(x, y, z))
-		{
-			return data[z][y][x];
-		}
-		else
+		if (!isValidPixel(x, y, z) || channel < 0 || channel >= getChannels())
 		{
 			std::cout << "Pixel coordinates out of bounds!" << std::endl;
 			return -1;
 		}
+
+		auto component_size = getVoxelSize() / getChannels();
+		return _read_component(data + index(x, y, z) * getVoxelSize() + channel * component_size, component_size);
 	}
 
-	std::vector<float>
+	uint8_t*
 	Image3D::getData()
 	{
-		std::vector<float> res;
+		return data;
+	}
+
+	const uint8_t*
+	Image3D::getData() const
+	{
+		return data;
+	}
+
+	Voxel_Span<uint8_t>
+	Image3D::getVoxels()
+	{
+		return Voxel_Span<uint8_t>{data, getSizeInBytes()};
+	}
+
+	Voxel_Span<const uint8_t>
+	Image3D::getVoxels() const
+	{
+		return Voxel_Span<const uint8_t>{data, getSizeInBytes()};
+	}
+
+	size_t
+	Image3D::getSize() const
+	{
+		return size_t(width) * height * depth;
+	}
 
-		for (int z = 0; z < depth; ++z)
+	size_t
+	Image3D::getSizeInBytes() const
+	{
+		return getSize() * getVoxelSize();
+	}
+
+	Voxel_Span<uint8_t>
+	Image3D::getSlice(int z)
+	{
+		return Voxel_Span<uint8_t>{data + index(0, 0, z) * getVoxelSize(), size_t(width) * height * getVoxelSize()};
+	}
+
+	Voxel_Span<const uint8_t>
+	Image3D::getSlice(int z) const
+	{
+		return Voxel_Span<const uint8_t>{
+			data + index(0, 0, z) * getVoxelSize(),
+			size_t(width) * height * getVoxelSize()};
+	}
+
+	Voxel_Span<uint8_t>
+	Image3D::getRow(int y, int z)
+	{
+		return Voxel_Span<uint8_t>{data + index(0, y, z) * getVoxelSize(), size_t(width) * getVoxelSize()};
+	}
+
+	Voxel_Span<const uint8_t>
+	Image3D::getRow(int y, int z) const
+	{
+		return Voxel_Span<const uint8_t>{data + index(0, y, z) * getVoxelSize(), size_t(width) * getVoxelSize()};
+	}
+
+	void
+	Image3D::setRow(int y, int z, const float* values, int channel)
+	{
+		setSpan(0, y, z, width, values, channel);
+	}
+
+	void
+	Image3D::readRow(int y, int z, float* values, int channel)
+	{
+		readSpan(0, y, z, width, values, channel);
+	}
+
+	void
+	Image3D::setSpan(int x, int y, int z, int count, const float* values, int channel)
+	{
+		if (!isValidPixel(x, y, z) || count < 0 || count > width - x || channel < 0 || channel >= getChannels())
 		{
-			for (int y = 0; y < height; ++y)
-			{
-				for (int x = 0; x < width; ++x)
-				{
-					res.push_back(data[z][y][x]);
-				}
-			}
+			std::cout << "Pixel coordinates out of bounds!" << std::endl;
+			return;
 		}
 
-		return res;
+		auto component_size = getVoxelSize() / getChannels();
+		convertValues(values, data + index(x, y, z) * getVoxelSize() + channel * component_size, count, getVoxelSize());
 	}
 
 	void
-	Image3D::setData(std::vector<float>& in_data)
+	Image3D::readSpan(int x, int y, int z, int count, float* values, int channel)
 	{
-		int index = 0;
-		for (int z = 0; z < depth; ++z)
+		if (!isValidPixel(x, y, z) || count < 0 || count > width - x || channel < 0 || channel >= getChannels())
 		{
-			for (int y = 0; y < height; ++y)
-			{
-				for (int x = 0; x < width; ++x)
-				{
-					data[z][y][x] = in_data[index++];
-				}
-			}
+			std::cout << "Pixel coordinates out of bounds!" << std::endl;
+			return;
 		}
+
+		auto voxel_size = getVoxelSize();
+		auto component_size = voxel_size / getChannels();
+		auto span = data + index(x, y, z) * voxel_size + channel * component_size;
+
+		for (int i = 0; i < count; ++i)
+			values[i] = _read_component(span + i * voxel_size, component_size);
+	}
+
+	void
+	Image3D::setData(const float* in_data, size_t count)
+	{
+		auto component_size = getVoxelSize() / std::max(getChannels(), 1);
+		convertValues(in_data, data, std::min(count, getSize() * getChannels()), component_size);
+	}
+
+	void
+	Image3D::setData(std::vector<float>& in_data)
+	{
+		setData(in_data.data(), in_data.size());
 	}
 
 	bool
@@ -101,9 +271,110 @@ namespace gfx
 		return depth;
 	}
 
+	Texture_Format
+	Image3D::getFormat() const
+	{
+		return format;
+	}
+
+	int
+	Image3D::getChannels() const
+	{
+		return int(textureFormatComponents(format));
+	}
+
+	size_t
+	Image3D::getVoxelSize() const
+	{
+		return textureFormatPixelSize(format);
+	}
+
+	bool
+	Image3D::save(const char* file_name, int quantization_bits)
+	{
+		return VolumeFile::write(file_name, this, quantization_bits);
+	}
+
+	bool
+	Image3D::load(const char* file_name)
+	{
+		VolumeFile file(file_name);
+		if (!file.isOpen())
+			return false;
+
+		*this = file.read();
+		return hasData();
+	}
+
+	bool
+	Image3D::isSupportedFormat(Texture_Format format)
+	{
+		switch (format)
+		{
+		case R8:
+		case R16F:
+		case R32F:
+		case RG16F:
+		case RGBA8:
+		case RGBA16F:
+			return true;
+		default:
+			return false;
+		}
+	}
+
 	bool
 	Image3D::isValidPixel(int x, int y, int z)
 	{
 		return (x >= 0 && x < width) && (y >= 0 && y < height) && (z >= 0 && z < depth);
 	}
+
+	size_t
+	Image3D::index(int x, int y, int z) const
+	{
+		return (size_t(z) * height + y) * width + x;
+	}
+
+	void
+	Image3D::convertValues(const float* in, uint8_t* out, size_t count, size_t out_stride)
+	{
+		auto component_size = getVoxelSize() / getChannels();
+
+		switch (component_size)
+		{
+		case 1:
+			for (size_t i = 0; i < count; ++i)
+				out[i * out_stride] = uint8_t(std::clamp(in[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+			break;
+
+		case 2:
+			if (out_stride == 2 || count == 1)
+			{
+				floatToHalf(in, (uint16_t*)out, count);
+				break;
+			}
+
+			for (size_t start = 0; start < count; start += IMAGE3D_CONVERT_BLOCK)
+			{
+				uint16_t block[IMAGE3D_CONVERT_BLOCK];
+				auto block_count = std::min(IMAGE3D_CONVERT_BLOCK, count - start);
+				floatToHalf(in + start, block, block_count);
+
+				for (size_t i = 0; i < block_count; ++i)
+					memcpy(out + (start + i) * out_stride, &block[i], sizeof(uint16_t));
+			}
+			break;
+
+		default:
+			if (out_stride == sizeof(float) || count == 1)
+			{
+				memcpy(out, in, count * sizeof(float));
+				break;
+			}
+
+			for (size_t i = 0; i < count; ++i)
+				memcpy(out + i * out_stride, &in[i], sizeof(float));
+			break;
+		}
+	}
 } // namespace gfx
\ No newline at end of file
@@ -1,25 +1,120 @@
 #pragma once
 
+#include "enums.h"
+
+#include <cstddef>
+#include <cstdint>
 #include <vector>
 
 namespace gfx
 {
+	// non-owning run of voxel bytes, size is in bytes
+	template <typename T>
+	struct Voxel_Span
+	{
+		T* data = nullptr;
+		size_t size = 0;
+
+		T*
+		begin() const
+		{
+			return data;
+		}
+
+		T*
+		end() const
+		{
+			return data + size;
+		}
+
+		bool
+		empty() const
+		{
+			return size == 0;
+		}
+	};
+
+	// move-only volume stored in one aligned block in its gpu format, x varies fastest then y then z
+	// supported formats are R8, R16F, R32F, RG16F, RGBA8 and RGBA16F, 8 bit channels hold values in [0, 1]
 	class Image3D
 	{
 	public:
-		Image3D(int width, int height, int depth);
+		Image3D();
+
+		Image3D(int width, int height, int depth, Texture_Format format = Texture_Format::R32F);
+
+		Image3D(const Image3D&) = delete;
+
+		Image3D&
+		operator=(const Image3D&) = delete;
+
+		Image3D(Image3D&& other) noexcept;
+
+		Image3D&
+		operator=(Image3D&& other) noexcept;
 
 		~Image3D();
 
+		// the value is converted to the voxel format
 		void
-		setPixel(int x, int y, int z, float value);
+		setPixel(int x, int y, int z, float value, int channel = 0);
 
 		float
-		getPixel(int x, int y, int z);
+		getPixel(int x, int y, int z, int channel = 0);
 
-		std::vector<float>
+		// all the voxels, ready to be uploaded as is
+		uint8_t*
 		getData();
 
+		const uint8_t*
+		getData() const;
+
+		Voxel_Span<uint8_t>
+		getVoxels();
+
+		Voxel_Span<const uint8_t>
+		getVoxels() const;
+
+		// number of voxels
+		size_t
+		getSize() const;
+
+		size_t
+		getSizeInBytes() const;
+
+		// the z slice, width * height voxels
+		Voxel_Span<uint8_t>
+		getSlice(int z);
+
+		Voxel_Span<const uint8_t>
+		getSlice(int z) const;
+
+		// the row y of the z slice, width voxels
+		Voxel_Span<uint8_t>
+		getRow(int y, int z);
+
+		Voxel_Span<const uint8_t>
+		getRow(int y, int z) const;
+
+		// converts width values into one channel of the row y in the z slice
+		void
+		setRow(int y, int z, const float* values, int channel = 0);
+
+		// converts one channel of the row y in the z slice back to width floats
+		void
+		readRow(int y, int z, float* values, int channel = 0);
+
+		// converts count values into one channel of the voxels starting at x in the row y of the z slice
+		void
+		setSpan(int x, int y, int z, int count, const float* values, int channel = 0);
+
+		void
+		readSpan(int x, int y, int z, int count, float* values, int channel = 0);
+
+		// converts count values with interleaved channels starting at the first voxel
+		void
+		setData(const float* in_data, size_t count);
+
 		void
 		setData(std::vector<float>& data);
 
@@ -35,11 +130,38 @@ namespace gfx
 		int
 		getDepth();
 
+		Texture_Format
+		getFormat() const;
+
+		int
+		getChannels() const;
+
+		// size in bytes of one voxel
+		size_t
+		getVoxelSize() const;
+
+		// compressed volume file, see VolumeFile, quantization_bits is 8 or 16
+		bool
+		save(const char* file_name, int quantization_bits = 8);
+
+		bool
+		load(const char* file_name);
+
+		static bool
+		isSupportedFormat(Texture_Format format);
+
 	private:
 		int width, height, depth;
-		std::vector<std::vector<std::vector<float>>> data;
+		Texture_Format format;
+		uint8_t* data;
 
 		bool
 		isValidPixel(int x, int y, int z);
+
+		size_t
+		index(int x, int y, int z) const;
+
+		void
+		convertValues(const float* in, uint8_t* out, size_t count, size_t out_stride);
 	};
 } // namespace gfx
\ No newline at end of file
@@ -0,0 +1,153 @@
+#include "ImageAllocator.h"
+
+#include <cstdlib>
+#include <iostream>
+
+namespace gfx
+{
+	void*
+	alignedAlloc(size_t size, size_t alignment)
+	{
+		// aligned_alloc requires the size to be a multiple of the alignment
+		size = (size + alignment - 1) & ~(alignment - 1);
+
+#ifdef _WIN32
+		return _aligned_malloc(size, alignment);
+#else
+		return aligned_alloc(alignment, size);
+#endif
+	}
+
+	void
+	alignedFree(void* ptr)
+	{
+#ifdef _WIN32
+		_aligned_free(ptr);
+#else
+		free(ptr);
+#endif
+	}
+
+	class HeapImageAllocator : public ImageAllocator
+	{
+	public:
+		void*
+		allocate(size_t size) override
+		{
+			return malloc(size);
+		}
+
+		void
+		deallocate(void* ptr, size_t) override
+		{
+			free(ptr);
+		}
+	};
+
+	ImageAllocator*
+	ImageAllocator::heap()
+	{
+		static HeapImageAllocator allocator;
+		return &allocator;
+	}
+
+	// arena
+	ArenaImageAllocator::ArenaImageAllocator(size_t block_size) : block_size(block_size), used(0) {}
+
+	ArenaImageAllocator::~ArenaImageAllocator()
+	{
+		for (auto& block : blocks)
+			alignedFree(block.data);
+	}
+
+	void*
+	ArenaImageAllocator::allocate(size_t size)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// keep allocations 64 bytes aligned for simd access
+		size = (size + 63) & ~size_t(63);
+
+		if (blocks.empty() || used + size > blocks.back().size)
+		{
+			auto new_size = size > block_size ? size : block_size;
+			auto data = (unsigned char*)alignedAlloc(new_size, 64);
+			if (data == nullptr)
+			{
+				std::cout << "Cannot allocate image arena block" << std::endl;
+				return nullptr;
+			}
+
+			blocks.push_back(Block{data, new_size});
+			used = 0;
+		}
+
+		auto res = blocks.back().data + used;
+		used += size;
+		return res;
+	}
+
+	void
+	ArenaImageAllocator::deallocate(void*, size_t)
+	{
+	}
+
+	void
+	ArenaImageAllocator::reset()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+
+		// keep the last block around to serve the next batch
+		for (size_t i = 0; i + 1 < blocks.size(); ++i)
+			alignedFree(blocks[i].data);
+
+		if (blocks.empty() == false)
+			blocks.erase(blocks.begin(), blocks.end() - 1);
+
+		used = 0;
+	}
+
+	// pool
+	PoolImageAllocator::PoolImageAllocator(size_t block_size) : block_size(block_size) {}
+
+	PoolImageAllocator::~PoolImageAllocator()
+	{
+		for (auto block : blocks)
+			free(block);
+	}
+
+	void*
+	PoolImageAllocator::allocate(size_t size)
+	{
+		if (size > block_size)
+		{
+			std::cout << "Image is larger than the pool block size" << std::endl;
+			return nullptr;
+		}
+
+		std::lock_guard<std::mutex> lock(mutex);
+
+		if (free_blocks.empty() == false)
+		{
+			auto res = free_blocks.back();
+			free_blocks.pop_back();
+			return res;
+		}
+
+		auto res = malloc(block_size);
+		if (res)
+			blocks.push_back(res);
+
+		return res;
+	}
+
+	void
+	PoolImageAllocator::deallocate(void* ptr, size_t)
+	{
+		if (ptr == nullptr)
+			return;
+
+		std::lock_guard<std::mutex> lock(mutex);
+		free_blocks.push_back(ptr);
+	}
+} // namespace gfx
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+namespace gfx
+{
+	// portable aligned allocation, alignment must be a power of two
+	void*
+	alignedAlloc(size_t size, size_t alignment);
+
+	void
+	alignedFree(void* ptr);
+
+	// memory source of image pixels
+	class ImageAllocator
+	{
+	public:
+		virtual ~ImageAllocator() = default;
+
+		virtual void*
+		allocate(size_t size) = 0;
+
+		virtual void
+		deallocate(void* ptr, size_t size) = 0;
+
+		// malloc/free allocator, also owns the pixels loaded by stb_image
+		static ImageAllocator*
+		heap();
+	};
+
+	// bump allocator for batches of images that die together, deallocate is a no-op until reset
+	class ArenaImageAllocator : public ImageAllocator
+	{
+	public:
+		ArenaImageAllocator(size_t block_size = 64 * 1024 * 1024);
+
+		~ArenaImageAllocator() override;
+
+		void*
+		allocate(size_t size) override;
+
+		void
+		deallocate(void* ptr, size_t size) override;
+
+		// releases every allocation at once, images allocated from the arena must be dead by now
+		void
+		reset();
+
+	private:
+		struct Block
+		{
+			unsigned char* data;
+			size_t size;
+		};
+
+		std::mutex mutex;
+		std::vector<Block> blocks;
+		size_t block_size, used;
+	};
+
+	// free list of fixed size blocks, suited for streams of same sized image tiles
+	class PoolImageAllocator : public ImageAllocator
+	{
+	public:
+		PoolImageAllocator(size_t block_size);
+
+		~PoolImageAllocator() override;
+
+		void*
+		allocate(size_t size) override;
+
+		void
+		deallocate(void* ptr, size_t size) override;
+
+	private:
+		std::mutex mutex;
+		std::vector<void*> free_blocks;
+		std::vector<void*> blocks;
+		size_t block_size;
+	};
+} // namespace gfx
@@ -14,7 +14,8 @@ namespace gfx
 		LINES,
 		LINE_STRIP,
 		TRIANGLES,
-		TRIANGLES_STRIP
+		TRIANGLES_STRIP,
+		PATCHES
 	};
 
 	enum GFX_Settings
@@ -42,11 +43,57 @@ namespace gfx
 		LINEAR_MIPMAP_LINEAR,
 	};
 
+	enum Pixel_Type
+	{
+		PIXEL_UNSIGNED_BYTE,
+		PIXEL_UNSIGNED_SHORT,
+		PIXEL_FLOAT,
+	};
+
+	enum Texture_Format
+	{
+		R8,
+		RG8,
+		RGB8,
+		RGBA8,
+		SRGB8,
+		SRGB8_ALPHA8,
+		R16,
+		RG16,
+		RGB16,
+		RGBA16,
+		R16F,
+		RG16F,
+		RGB16F,
+		RGBA16F,
+		R11G11B10F,
+		R32F,
+		RG32F,
+		RGBA32F,
+		BC4,
+		BC5,
+		BC7,
+		BC7_SRGB,
+		R32UI,
+	};
+
+	enum Depth_Format
+	{
+		NO_DEPTH,
+		DEPTH16,
+		DEPTH24,
+		DEPTH32F,
+		DEPTH24_STENCIL8,
+		DEPTH32F_STENCIL8,
+	};
+
 	enum FrameBuffer_Mode
 	{
 		RenderBuffer,
 		DepthBuffer,
 		DepthCubeMap,
+		// RenderBuffer with an RGBA16F color texture, for hdr and premultiplied alpha passes
+		HDRBuffer,
 	};
 
 } // namespace gfx
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "gfx.h"
+#include "gfx_formats.h"
+#include "gfx_program.h"
 
 #include <backends/imgui_impl_glfw.h>
 #include <backends/imgui_impl_opengl3.h>
@@ -9,64 +11,76 @@
 namespace gfx
 {
 	inline static GLenum
-	_wrapping_mode(Wrapping_Mode wrap_mode)
+	_primitive(GFX_Primitive type)
 	{
 		GLenum res = 0;
-		switch (wrap_mode)
+
+		switch (type)
 		{
-		case REPEAT:
-			res = GL_REPEAT;
+		case POINTS:
+			res = GL_POINTS;
+			break;
+
+		case LINES:
+			res = GL_LINES;
 			break;
 
-		case CLAMP_TO_EDGE:
-			res = GL_CLAMP_TO_EDGE;
+		case LINE_STRIP:
+			res = GL_LINE_STRIP;
 			break;
 
-		case CLAMP_TO_BORDER:
-			res = GL_CLAMP_TO_BORDER;
+		case TRIANGLES:
+			res = GL_TRIANGLES;
 			break;
 
-		case MIRRORED_REPEAT:
-			res = GL_MIRRORED_REPEAT;
+		case TRIANGLES_STRIP:
+			res = GL_TRIANGLE_STRIP;
+			break;
+
+		case PATCHES:
+			res = GL_PATCHES;
 			break;
 		}
 
 		return res;
 	}
 
-	inline static GLint
-	_filtering_mode(Filtering_Mode mode)
+	inline static bool
+	_valid_view(const ImageView& img)
 	{
-		GLint res = 0;
-
-		switch (mode)
+		if (!img.data)
 		{
-		case NEAREST:
-			res = GL_NEAREST;
-			break;
-
-		case LINEAR:
-			res = GL_LINEAR;
-			break;
+			std::cout << "Empty image check image file" << std::endl;
+			return false;
+		}
 
-		case NEAREST_MIPMAP_NEAREST:
-			res = GL_NEAREST_MIPMAP_NEAREST;
-			break;
+		if (img.ncomponents < 1 || img.ncomponents > 4)
+		{
+			std::cout << "Unsupported image components count" << std::endl;
+			return false;
+		}
 
-		case LINEAR_MIPMAP_NEAREST:
-			res = GL_LINEAR_MIPMAP_NEAREST;
-			break;
+		// opengl row length is counted in pixels
+		if (img.row_pitch % img.stride() != 0)
+		{
+			std::cout << "Image row pitch must be a multiple of the pixel size" << std::endl;
+			return false;
+		}
 
-		case NEAREST_MIPMAP_LINEAR:
-			res = GL_NEAREST_MIPMAP_LINEAR;
-			break;
+		return true;
+	}
 
-		case LINEAR_MIPMAP_LINEAR:
-			res = GL_LINEAR_MIPMAP_LINEAR;
-			break;
-		}
+	inline static void
+	_set_unpack_state(const ImageView& img)
+	{
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, img.row_pitch / img.stride());
+	}
 
-		return res;
+	inline static void
+	_reset_unpack_state()
+	{
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
 	}
 
 	// API
@@ -85,11 +99,11 @@ namespace gfx
 	}
 
 	bool
-	GFX::init(const char* window_title, int window_width, int window_height)
+	GFX::init(const char* window_title, int window_width, int window_height, int window_samples)
 	{
 		// glfw: initialize and configure
 		glfwInit();
-		glfwWindowHint(GLFW_SAMPLES, 8);
+		glfwWindowHint(GLFW_SAMPLES, window_samples);
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
 		glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 5);
 		glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
@@ -130,7 +144,8 @@ namespace gfx
 
 		// configure global opengl state
 		glEnable(GL_DEPTH_TEST);
-		glEnable(GL_MULTISAMPLE);
+		if (window_samples > 0)
+			glEnable(GL_MULTISAMPLE);
 		glEnable(GL_BLEND);
 
 		return true;
@@ -402,6 +417,80 @@ namespace gfx
 		return id;
 	}
 
+	uint32_t
+	GFX::createShaderStorageBuffer(void* data, uint32_t size, BUFFER_USAGE usage)
+	{
+		GLuint id = -1;
+		glGenBuffers(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate shader storage buffer" << std::endl;
+			return id;
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, id);
+
+		switch (usage)
+		{
+
+			// static
+		case BUFFER_USAGE::STATIC:
+			glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_STATIC_DRAW);
+			break;
+
+			// dynamic
+		case BUFFER_USAGE::DYNAMIC:
+			glBufferData(GL_SHADER_STORAGE_BUFFER, size, data, GL_DYNAMIC_DRAW);
+			break;
+
+		default:
+			return id;
+			break;
+		}
+
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, 0);
+
+		return id;
+	}
+
+	uint32_t
+	GFX::createIndirectBuffer(void* data, uint32_t size, BUFFER_USAGE usage)
+	{
+		GLuint id = -1;
+		glGenBuffers(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate indirect buffer" << std::endl;
+			return id;
+		}
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, id);
+
+		switch (usage)
+		{
+
+			// static
+		case BUFFER_USAGE::STATIC:
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, size, data, GL_STATIC_DRAW);
+			break;
+
+			// dynamic
+		case BUFFER_USAGE::DYNAMIC:
+			glBufferData(GL_DRAW_INDIRECT_BUFFER, size, data, GL_DYNAMIC_DRAW);
+			break;
+
+		default:
+			return id;
+			break;
+		}
+
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+
+		return id;
+	}
+
 	uint32_t
 	GFX::createGPUMesh(uint32_t vertex_buffer, const Attributes& attribs)
 	{
@@ -474,20 +563,88 @@ namespace gfx
 		return id;
 	}
 
+	uint32_t
+	GFX::createGPUMesh(
+		uint32_t vertex_buffer,
+		uint32_t index_buffer,
+		const Attributes& attribs,
+		uint32_t instance_buffer,
+		const Attributes& instance_attribs)
+	{
+		GLuint id = -1;
+		glGenVertexArrays(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate gpu mesh" << std::endl;
+			return id;
+		}
+
+		glBindVertexArray(id);
+
+		glBindBuffer(GL_ARRAY_BUFFER, vertex_buffer);
+
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, index_buffer);
+
+		for (int i = 0; i < attribs.getElementCount(); i++)
+		{
+			auto offset_val = static_cast<uintptr_t>(attribs.m_attributes[i].offset);
+
+			glEnableVertexAttribArray(i);
+			glVertexAttribPointer(
+				i,
+				attribs.m_attributes[i].components,
+				GL_FLOAT,
+				GL_FALSE,
+				attribs.getSize(),
+				reinterpret_cast<void*>(offset_val));
+		}
+
+		// per instance attributes continue after the vertex attributes locations
+		glBindBuffer(GL_ARRAY_BUFFER, instance_buffer);
+
+		for (int i = 0; i < instance_attribs.getElementCount(); i++)
+		{
+			auto offset_val = static_cast<uintptr_t>(instance_attribs.m_attributes[i].offset);
+			auto location = attribs.getElementCount() + i;
+
+			glEnableVertexAttribArray(location);
+			glVertexAttribPointer(
+				location,
+				instance_attribs.m_attributes[i].components,
+				GL_FLOAT,
+				GL_FALSE,
+				instance_attribs.getSize(),
+				reinterpret_cast<void*>(offset_val));
+			glVertexAttribDivisor(location, 1);
+		}
+
+		glBindVertexArray(0);
+
+		return id;
+	}
+
 	uint32_t
 	GFX::createTexture1D(
 		Image* img,
 		Wrapping_Mode wrap_mode,
 		Filtering_Mode minifying_mode,
 		Filtering_Mode magnifying_mode)
+	{
+		return createTexture1D(img->view(), wrap_mode, minifying_mode, magnifying_mode);
+	}
+
+	uint32_t
+	GFX::createTexture1D(
+		const ImageView& img,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode)
 	{
 		GLuint id = -1;
 
-		if (!img->getData())
-		{
-			std::cout << "Empty image check image file" << std::endl;
+		if (!_valid_view(img))
 			return id;
-		}
 
 		glGenTextures(1, &id);
 
@@ -499,18 +656,21 @@ namespace gfx
 
 		glBindTexture(GL_TEXTURE_1D, id);
 
-		if (img->get_NCompnents() == 3)
-			glTexImage1D(GL_TEXTURE_1D, 0, GL_RGB, img->getWidth(), 0, GL_RGB, GL_UNSIGNED_BYTE, img->getData());
-		else if (img->get_NCompnents() == 4)
-			glTexImage1D(GL_TEXTURE_1D, 0, GL_RGBA, img->getWidth(), 0, GL_RGBA, GL_UNSIGNED_BYTE, img->getData());
+		auto format = deduceTextureFormat(img.ncomponents, img.type);
+
+		glTexStorage1D(GL_TEXTURE_1D, 1, textureInternalFormat(format), img.width);
 
-		auto res = _wrapping_mode(wrap_mode);
+		_set_unpack_state(img);
+		glTexSubImage1D(GL_TEXTURE_1D, 0, 0, img.width, pixelFormat(img.ncomponents), pixelType(img.type), img.data);
+		_reset_unpack_state();
+
+		auto res = wrappingMode(wrap_mode);
 
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_S, res);
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_WRAP_T, res);
 
-		auto minifying = _filtering_mode(minifying_mode);
-		auto magnifying = _filtering_mode(magnifying_mode);
+		auto minifying = filteringMode(minifying_mode);
+		auto magnifying = filteringMode(magnifying_mode);
 
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MIN_FILTER, minifying);
 		glTexParameteri(GL_TEXTURE_1D, GL_TEXTURE_MAG_FILTER, magnifying);
@@ -527,14 +687,47 @@ namespace gfx
 		Filtering_Mode minifying_mode,
 		Filtering_Mode magnifying_mode,
 		bool enable_mipmaps)
+	{
+		return createTexture2D(img->view(), wrap_mode, minifying_mode, magnifying_mode, enable_mipmaps);
+	}
+
+	uint32_t
+	GFX::createTexture2D(
+		Image* img,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps,
+		Texture_Format format)
+	{
+		return createTexture2D(img->view(), wrap_mode, minifying_mode, magnifying_mode, enable_mipmaps, format);
+	}
+
+	uint32_t
+	GFX::createTexture2D(
+		const ImageView& img,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps)
+	{
+		auto format = deduceTextureFormat(img.ncomponents, img.type);
+		return createTexture2D(img, wrap_mode, minifying_mode, magnifying_mode, enable_mipmaps, format);
+	}
+
+	uint32_t
+	GFX::createTexture2D(
+		const ImageView& img,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps,
+		Texture_Format format)
 	{
 		GLuint id = -1;
 
-		if (!img->getData())
-		{
-			std::cout << "Empty image check image file" << std::endl;
+		if (!_valid_view(img))
 			return id;
-		}
 
 		glGenTextures(1, &id);
 
@@ -546,43 +739,34 @@ namespace gfx
 
 		glBindTexture(GL_TEXTURE_2D, id);
 
-		if (img->get_NCompnents() == 3)
-		{
-			glTexImage2D(
-				GL_TEXTURE_2D,
-				0,
-				GL_RGB,
-				img->getWidth(),
-				img->getHeight(),
-				0,
-				GL_RGB,
-				GL_UNSIGNED_BYTE,
-				img->getData());
-		}
-		else if (img->get_NCompnents() == 4)
-		{
-			glTexImage2D(
-				GL_TEXTURE_2D,
-				0,
-				GL_RGBA,
-				img->getWidth(),
-				img->getHeight(),
-				0,
-				GL_RGBA,
-				GL_UNSIGNED_BYTE,
-				img->getData());
-		}
+		// immutable storage with the whole mip chain allocated up front
+		auto levels = enable_mipmaps ? mipLevelsCount(img.width, img.height) : 1;
+
+		glTexStorage2D(GL_TEXTURE_2D, levels, textureInternalFormat(format), img.width, img.height);
+
+		_set_unpack_state(img);
+		glTexSubImage2D(
+			GL_TEXTURE_2D,
+			0,
+			0,
+			0,
+			img.width,
+			img.height,
+			pixelFormat(img.ncomponents),
+			pixelType(img.type),
+			img.data);
+		_reset_unpack_state();
 
 		if (enable_mipmaps)
 			glGenerateMipmap(GL_TEXTURE_2D);
 
-		auto res = _wrapping_mode(wrap_mode);
+		auto res = wrappingMode(wrap_mode);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, res);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, res);
 
-		auto minifying = _filtering_mode(minifying_mode);
-		auto magnifying = _filtering_mode(magnifying_mode);
+		auto minifying = filteringMode(minifying_mode);
+		auto magnifying = filteringMode(magnifying_mode);
 
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minifying);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magnifying);
@@ -592,6 +776,134 @@ namespace gfx
 		return id;
 	}
 
+	void
+	GFX::updateTexture2D(uint32_t texture2d, uint32_t x, uint32_t y, const ImageView& img)
+	{
+		if (!_valid_view(img))
+			return;
+
+		glBindTexture(GL_TEXTURE_2D, texture2d);
+
+		_set_unpack_state(img);
+		glTexSubImage2D(
+			GL_TEXTURE_2D,
+			0,
+			x,
+			y,
+			img.width,
+			img.height,
+			pixelFormat(img.ncomponents),
+			pixelType(img.type),
+			img.data);
+		_reset_unpack_state();
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	uint32_t
+	GFX::createTexture2DArray(
+		const std::vector<Image*>& layers,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps)
+	{
+		std::vector<ImageView> views;
+		for (auto layer : layers)
+			views.push_back(layer->view());
+
+		return createTexture2DArray(views, wrap_mode, minifying_mode, magnifying_mode, enable_mipmaps);
+	}
+
+	uint32_t
+	GFX::createTexture2DArray(
+		const std::vector<ImageView>& layers,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps)
+	{
+		GLuint id = -1;
+
+		if (layers.empty())
+		{
+			std::cout << "Empty layers list for Texture2DArray" << std::endl;
+			return id;
+		}
+
+		auto& first = layers[0];
+
+		for (auto& layer : layers)
+		{
+			if (!_valid_view(layer))
+				return id;
+
+			if (layer.width != first.width || layer.height != first.height ||
+				layer.ncomponents != first.ncomponents || layer.type != first.type)
+			{
+				std::cout << "Texture2DArray layers must have the same size and format" << std::endl;
+				return id;
+			}
+		}
+
+		glGenTextures(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate Texture2DArray" << std::endl;
+			return id;
+		}
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, id);
+
+		auto format = deduceTextureFormat(first.ncomponents, first.type);
+		auto levels = enable_mipmaps ? mipLevelsCount(first.width, first.height) : 1;
+
+		glTexStorage3D(
+			GL_TEXTURE_2D_ARRAY,
+			levels,
+			textureInternalFormat(format),
+			first.width,
+			first.height,
+			(GLsizei)layers.size());
+
+		for (size_t i = 0; i < layers.size(); ++i)
+		{
+			_set_unpack_state(layers[i]);
+			glTexSubImage3D(
+				GL_TEXTURE_2D_ARRAY,
+				0,
+				0,
+				0,
+				(GLint)i,
+				first.width,
+				first.height,
+				1,
+				pixelFormat(first.ncomponents),
+				pixelType(first.type),
+				layers[i].data);
+		}
+		_reset_unpack_state();
+
+		if (enable_mipmaps)
+			glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+		auto res = wrappingMode(wrap_mode);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, res);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, res);
+
+		auto minifying = filteringMode(minifying_mode);
+		auto magnifying = filteringMode(magnifying_mode);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, minifying);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, magnifying);
+
+		glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+		return id;
+	}
+
 	uint32_t
 	GFX::createTexture3D(
 		Image3D* img,
@@ -618,30 +930,43 @@ namespace gfx
 
 		glBindTexture(GL_TEXTURE_3D, id);
 
+		auto levels = enable_mipmaps ? mipLevelsCount(img->getWidth(), img->getHeight(), img->getDepth()) : 1;
+
+		// voxels are stored in the texture format so they're uploaded straight from the image without a staging copy
+		auto format = img->getFormat();
+		glTexStorage3D(
+			GL_TEXTURE_3D,
+			levels,
+			textureInternalFormat(format),
+			img->getWidth(),
+			img->getHeight(),
+			img->getDepth());
+
 		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-		glTexImage3D(
+		glTexSubImage3D(
 			GL_TEXTURE_3D,
 			0,
-			GL_R32F,
+			0,
+			0,
+			0,
 			img->getWidth(),
 			img->getHeight(),
 			img->getDepth(),
-			0,
-			GL_R32F,
-			GL_FLOAT,
-			img->getData().data());
+			pixelFormat(textureFormatComponents(format)),
+			textureTransferType(format),
+			img->getData());
 
 		if (enable_mipmaps)
 			glGenerateMipmap(GL_TEXTURE_3D);
 
-		auto res = _wrapping_mode(wrap_mode);
+		auto res = wrappingMode(wrap_mode);
 
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, res);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, res);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, res);
 
-		auto minifying = _filtering_mode(minifying_mode);
-		auto magnifying = _filtering_mode(magnifying_mode);
+		auto minifying = filteringMode(minifying_mode);
+		auto magnifying = filteringMode(magnifying_mode);
 
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, minifying);
 		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, magnifying);
@@ -654,112 +979,48 @@ namespace gfx
 	uint32_t
 	GFX::createGPUProgram(const char* vs, const char* fs)
 	{
-		// vertex shader
-		unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertexShader, 1, &vs, NULL);
-		glCompileShader(vertexShader);
-
-		// check for shader compile errors
-		int success;
-		char infoLog[512];
-		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
-
-		// fragment shader
-		unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragmentShader, 1, &fs, NULL);
-		glCompileShader(fragmentShader);
-		// check for shader compile errors
-		glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
-
-		// link shaders
-		uint32_t shaderProgram = glCreateProgram();
-		glAttachShader(shaderProgram, vertexShader);
-		glAttachShader(shaderProgram, fragmentShader);
-		glLinkProgram(shaderProgram);
-		// check for linking errors
-		glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-		}
-		glDeleteShader(vertexShader);
-		glDeleteShader(fragmentShader);
-
-		return shaderProgram;
+		return linkProgram({compileShader(GL_VERTEX_SHADER, vs), compileShader(GL_FRAGMENT_SHADER, fs)});
 	}
 
 	uint32_t
 	GFX::createGPUProgram(const char* vs, const char* gs, const char* fs)
 	{
-		// vertex shader
-		unsigned int vertexShader = glCreateShader(GL_VERTEX_SHADER);
-		glShaderSource(vertexShader, 1, &vs, NULL);
-		glCompileShader(vertexShader);
-
-		// check for shader compile errors
-		int success;
-		char infoLog[512];
-		glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(vertexShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
-
-		// geometry shader
-		unsigned int geometryShader = glCreateShader(GL_GEOMETRY_SHADER);
-		glShaderSource(geometryShader, 1, &gs, NULL);
-		glCompileShader(geometryShader);
-
-		// check for shader compile errors
-		glGetShaderiv(geometryShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(geometryShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::GEOMETRY::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
+		return linkProgram({
+			compileShader(GL_VERTEX_SHADER, vs),
+			compileShader(GL_GEOMETRY_SHADER, gs),
+			compileShader(GL_FRAGMENT_SHADER, fs),
+		});
+	}
 
-		// fragment shader
-		unsigned int fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-		glShaderSource(fragmentShader, 1, &fs, NULL);
-		glCompileShader(fragmentShader);
-		// check for shader compile errors
-		glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
-		if (!success)
-		{
-			glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
-		}
+	uint32_t
+	GFX::createGPUProgram(const char* vs, const char* tcs, const char* tes, const char* fs)
+	{
+		// without a control stage the levels come from GL_PATCH_DEFAULT_OUTER_LEVEL and GL_PATCH_DEFAULT_INNER_LEVEL
+		std::vector<uint32_t> shaders{compileShader(GL_VERTEX_SHADER, vs)};
+		if (tcs)
+			shaders.push_back(compileShader(GL_TESS_CONTROL_SHADER, tcs));
+		shaders.push_back(compileShader(GL_TESS_EVALUATION_SHADER, tes));
+		shaders.push_back(compileShader(GL_FRAGMENT_SHADER, fs));
+
+		return linkProgram(shaders);
+	}
 
-		// link shaders
-		uint32_t shaderProgram = glCreateProgram();
-		glAttachShader(shaderProgram, vertexShader);
-		glAttachShader(shaderProgram, geometryShader);
-		glAttachShader(shaderProgram, fragmentShader);
-		glLinkProgram(shaderProgram);
-		// check for linking errors
-		glGetProgramiv(shaderProgram, GL_LINK_STATUS, &success);
-		if (!success)
-		{
-			glGetProgramInfoLog(shaderProgram, 512, NULL, infoLog);
-			std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << infoLog << std::endl;
-		}
-		glDeleteShader(vertexShader);
-		glDeleteShader(geometryShader);
-		glDeleteShader(fragmentShader);
+	uint32_t
+	GFX::createGPUProgramSPIRV(
+		const std::vector<uint32_t>& vs,
+		const std::vector<uint32_t>& fs,
+		const std::vector<Specialization_Constant>& constants)
+	{
+		return linkProgram({
+			compileSpirvShader(GL_VERTEX_SHADER, vs, constants),
+			compileSpirvShader(GL_FRAGMENT_SHADER, fs, constants),
+		});
+	}
 
-		return shaderProgram;
+	void
+	GFX::setPatchVertices(int count)
+	{
+		glPatchParameteri(GL_PATCH_VERTICES, count);
 	}
 
 	void
@@ -771,31 +1032,42 @@ namespace gfx
 	void
 	GFX::setGPUProgramVec2(uint32_t gpu_program, const std::string& name, const glm::vec2& val)
 	{
-		glUniform2fv(glGetUniformLocation(gpu_program, name.c_str()), 1, glm::value_ptr(val));
+		glProgramUniform2fv(gpu_program, glGetUniformLocation(gpu_program, name.c_str()), 1, glm::value_ptr(val));
 	}
 
 	void
 	GFX::setGPUProgramVec3(uint32_t gpu_program, const std::string& name, const glm::vec3& val)
 	{
-		glUniform3fv(glGetUniformLocation(gpu_program, name.c_str()), 1, glm::value_ptr(val));
+		glProgramUniform3fv(gpu_program, glGetUniformLocation(gpu_program, name.c_str()), 1, glm::value_ptr(val));
 	}
 
 	void
 	GFX::setGPUProgramMat4(uint32_t gpu_program, const std::string& name, const glm::mat4& mat)
 	{
-		glUniformMatrix4fv(glGetUniformLocation(gpu_program, name.c_str()), 1, GL_FALSE, &mat[0][0]);
+		glProgramUniformMatrix4fv(
+			gpu_program,
+			glGetUniformLocation(gpu_program, name.c_str()),
+			1,
+			GL_FALSE,
+			&mat[0][0]);
 	}
 
 	void
 	GFX::setGPUProgramFloat(uint32_t gpu_program, const std::string& name, const float& val)
 	{
-		glUniform1f(glGetUniformLocation(gpu_program, name.c_str()), val);
+		glProgramUniform1f(gpu_program, glGetUniformLocation(gpu_program, name.c_str()), val);
 	}
 
 	void
 	GFX::setGPUProgramInt(uint32_t gpu_program, const std::string& name, const int& val)
 	{
-		glUniform1i(glGetUniformLocation(gpu_program, name.c_str()), val);
+		glProgramUniform1i(gpu_program, glGetUniformLocation(gpu_program, name.c_str()), val);
+	}
+
+	void
+	GFX::bindShaderStorageBuffer(uint32_t buffer, uint32_t binding)
+	{
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, binding, buffer);
 	}
 
 	void
@@ -810,42 +1082,76 @@ namespace gfx
 		glBindTexture(GL_TEXTURE_2D, texture2d);
 	}
 
+	void
+	GFX::bindTexture2DArray(uint32_t texture2d_array)
+	{
+		glBindTexture(GL_TEXTURE_2D_ARRAY, texture2d_array);
+	}
+
 	void
 	GFX::bindTexture3D(uint32_t texture3d)
 	{
 		glBindTexture(GL_TEXTURE_3D, texture3d);
 	}
 
+	void
+	GFX::bindTextureUnit(uint32_t texture, uint32_t unit)
+	{
+		glBindTextureUnit(unit, texture);
+	}
+
 	void
 	GFX::draw(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t vertices_count)
 	{
 		glBindVertexArray(gpu_mesh_id);
-
-		if (type == POINTS)
-			glDrawArrays(GL_POINTS, 0, vertices_count);
-		else if (type == LINES)
-			glDrawArrays(GL_LINES, 0, vertices_count);
-		else if (type == LINE_STRIP)
-			glDrawArrays(GL_LINE_STRIP, 0, vertices_count);
-		else if (type == TRIANGLES)
-			glDrawArrays(GL_TRIANGLES, 0, vertices_count);
-		else if (type == TRIANGLES_STRIP)
-			glDrawArrays(GL_TRIANGLE_STRIP, 0, vertices_count);
+		glDrawArrays(_primitive(type), 0, vertices_count);
 	}
 
 	void
 	GFX::draw_indexed(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t indices_count)
 	{
 		glBindVertexArray(gpu_mesh_id);
+		glDrawElements(_primitive(type), indices_count, GL_UNSIGNED_INT, (void*)0);
+	}
+
+	void
+	GFX::draw_instanced(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t vertices_count, uint32_t instance_count)
+	{
+		glBindVertexArray(gpu_mesh_id);
+		glDrawArraysInstanced(_primitive(type), 0, vertices_count, instance_count);
+	}
+
+	void
+	GFX::draw_indexed_instanced(
+		GFX_Primitive type,
+		uint32_t gpu_mesh_id,
+		uint32_t indices_count,
+		uint32_t instance_count)
+	{
+		glBindVertexArray(gpu_mesh_id);
+		glDrawElementsInstanced(_primitive(type), indices_count, GL_UNSIGNED_INT, (void*)0, instance_count);
+	}
+
+	void
+	GFX::draw_multi_indirect(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t indirect_buffer, uint32_t draw_count)
+	{
+		glBindVertexArray(gpu_mesh_id);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+		glMultiDrawArraysIndirect(_primitive(type), (void*)0, draw_count, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+	}
 
-		if (type == POINTS)
-			glDrawElements(GL_POINTS, indices_count, GL_UNSIGNED_INT, (void*)0);
-		else if (type == LINES)
-			glDrawElements(GL_LINES, indices_count, GL_UNSIGNED_INT, (void*)0);
-		else if (type == LINE_STRIP)
-			glDrawElements(GL_LINE_STRIP, indices_count, GL_UNSIGNED_INT, (void*)0);
-		else if (type == TRIANGLES)
-			glDrawElements(GL_TRIANGLES, indices_count, GL_UNSIGNED_INT, (void*)0);
+	void
+	GFX::draw_indexed_multi_indirect(
+		GFX_Primitive type,
+		uint32_t gpu_mesh_id,
+		uint32_t indirect_buffer,
+		uint32_t draw_count)
+	{
+		glBindVertexArray(gpu_mesh_id);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirect_buffer);
+		glMultiDrawElementsIndirect(_primitive(type), GL_UNSIGNED_INT, (void*)0, draw_count, 0);
+		glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
 	}
 
 } // namespace gfx
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "Image3D.h"
 #include "attributes.h"
 #include "enums.h"
+#include "gfx_spirv.h"
 #include "gpu_attribute.h"
 
 #include <GL/glew.h>
@@ -16,9 +17,29 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 
 namespace gfx
 {
+	// layout of glDrawArraysIndirect commands
+	struct Draw_Arrays_Command
+	{
+		uint32_t count;
+		uint32_t instance_count;
+		uint32_t first;
+		uint32_t base_instance;
+	};
+
+	// layout of glDrawElementsIndirect commands
+	struct Draw_Elements_Command
+	{
+		uint32_t count;
+		uint32_t instance_count;
+		uint32_t first_index;
+		int32_t base_vertex;
+		uint32_t base_instance;
+	};
+
 	class GFX
 	{
 	public:
@@ -26,8 +47,10 @@ namespace gfx
 
 		~GFX();
 
+		// window_samples is the msaa sample count of the window, 0 leaves it single sampled which is much cheaper
+		// on weak gpus and lets multisampled framebuffers be resolved into it
 		bool
-		init(const char* window_title, int window_width, int window_height);
+		init(const char* window_title, int window_width, int window_height, int window_samples = 8);
 
 		void
 		on_Init(std::function<void()> function);
@@ -74,12 +97,28 @@ namespace gfx
 		uint32_t
 		createIndexBuffer(void* data, uint32_t size, BUFFER_USAGE usage);
 
+		uint32_t
+		createShaderStorageBuffer(void* data, uint32_t size, BUFFER_USAGE usage);
+
+		// buffer of Draw_Arrays_Command or Draw_Elements_Command
+		uint32_t
+		createIndirectBuffer(void* data, uint32_t size, BUFFER_USAGE usage);
+
 		uint32_t
 		createGPUMesh(uint32_t vertex_buffer, const Attributes& attribs);
 
 		uint32_t
 		createGPUMesh(uint32_t vertex_buffer, uint32_t index_buffer, const Attributes& attribs);
 
+		// instance attributes are bound after the vertex attributes and advance once per instance
+		uint32_t
+		createGPUMesh(
+			uint32_t vertex_buffer,
+			uint32_t index_buffer,
+			const Attributes& attribs,
+			uint32_t instance_buffer,
+			const Attributes& instance_attribs);
+
 		uint32_t
 		createTexture1D(
 			Image* img,
@@ -87,6 +126,13 @@ namespace gfx
 			Filtering_Mode minifying_mode,
 			Filtering_Mode magnifying_mode);
 
+		uint32_t
+		createTexture1D(
+			const ImageView& img,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode);
+
 		uint32_t
 		createTexture2D(
 			Image* img,
@@ -95,6 +141,55 @@ namespace gfx
 			Filtering_Mode magnifying_mode,
 			bool enable_mipmaps);
 
+		// allocates the texture with the given internal format, use it for sRGB or to shrink the storage
+		uint32_t
+		createTexture2D(
+			Image* img,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps,
+			Texture_Format format);
+
+		// views are uploaded in place, strided rows included
+		uint32_t
+		createTexture2D(
+			const ImageView& img,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps);
+
+		uint32_t
+		createTexture2D(
+			const ImageView& img,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps,
+			Texture_Format format);
+
+		// uploads the view into the texture rectangle starting at x, y without any intermediate copy
+		void
+		updateTexture2D(uint32_t texture2d, uint32_t x, uint32_t y, const ImageView& img);
+
+		// all layers must share the same size and format
+		uint32_t
+		createTexture2DArray(
+			const std::vector<Image*>& layers,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps);
+
+		uint32_t
+		createTexture2DArray(
+			const std::vector<ImageView>& layers,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps);
+
 		uint32_t
 		createTexture3D(
 			Image3D* img,
@@ -109,9 +204,26 @@ namespace gfx
 		uint32_t
 		createGPUProgram(const char* vs, const char* gs, const char* fs);
 
+		// tessellated program drawn with PATCHES, tcs can be null to use the default tessellation levels
+		uint32_t
+		createGPUProgram(const char* vs, const char* tcs, const char* tes, const char* fs);
+
+		// precompiled SPIR-V modules skip the glsl front-end, check isSpirvSupported first. uniforms in the modules
+		// need explicit locations since spir-v doesn't keep their names
+		uint32_t
+		createGPUProgramSPIRV(
+			const std::vector<uint32_t>& vs,
+			const std::vector<uint32_t>& fs,
+			const std::vector<Specialization_Constant>& constants = {});
+
+		// control points per patch of the next PATCHES draws, 3 by default
+		void
+		setPatchVertices(int count);
+
 		void
 		bindGPUProgram(uint32_t gpu_program);
 
+		// values go to gpu_program whether it's bound or not, which is how the stage programs of a pipeline get theirs
 		void
 		setGPUProgramVec2(uint32_t gpu_program, const std::string& name, const glm::vec2& val);
 
@@ -127,21 +239,52 @@ namespace gfx
 		void
 		setGPUProgramInt(uint32_t gpu_program, const std::string& name, const int& val);
 
+		void
+		bindShaderStorageBuffer(uint32_t buffer, uint32_t binding);
+
 		void
 		bindTexture1D(uint32_t texture1d);
 
 		void
 		bindTexture2D(uint32_t texture2d);
 
+		void
+		bindTexture2DArray(uint32_t texture2d_array);
+
 		void
 		bindTexture3D(uint32_t texture3d);
 
+		// binds any kind of texture to the given texture unit, leaving the active unit alone
+		void
+		bindTextureUnit(uint32_t texture, uint32_t unit);
+
 		void
 		draw(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t vertices_count);
 
 		void
 		draw_indexed(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t indices_count);
 
+		void
+		draw_instanced(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t vertices_count, uint32_t instance_count);
+
+		void
+		draw_indexed_instanced(
+			GFX_Primitive type,
+			uint32_t gpu_mesh_id,
+			uint32_t indices_count,
+			uint32_t instance_count);
+
+		// submits draw_count commands from the indirect buffer in a single call
+		void
+		draw_multi_indirect(GFX_Primitive type, uint32_t gpu_mesh_id, uint32_t indirect_buffer, uint32_t draw_count);
+
+		void
+		draw_indexed_multi_indirect(
+			GFX_Primitive type,
+			uint32_t gpu_mesh_id,
+			uint32_t indirect_buffer,
+			uint32_t draw_count);
+
 	private:
 		glm::vec4 m_clearcolor;
 		GLFWwindow* window;
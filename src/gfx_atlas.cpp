@@ -0,0 +1,168 @@
+#include "gfx_atlas.h"
+
+#define STBRP_STATIC
+#define STB_RECT_PACK_IMPLEMENTATION
+#include <imstb_rectpack.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace gfx
+{
+	TextureAtlas::TextureAtlas(int page_width, int page_height, int ncomponents, int padding)
+		: page_width(page_width), page_height(page_height), ncomponents(ncomponents), padding(padding)
+	{
+	}
+
+	TextureAtlas::~TextureAtlas() {}
+
+	int
+	TextureAtlas::add(Image* img)
+	{
+		return add(img->view());
+	}
+
+	int
+	TextureAtlas::add(const ImageView& img)
+	{
+		if (!img.data)
+		{
+			std::cout << "Empty image check image file" << std::endl;
+			return -1;
+		}
+
+		if (img.type != PIXEL_UNSIGNED_BYTE)
+		{
+			std::cout << "Texture atlas supports only 8-bit images" << std::endl;
+			return -1;
+		}
+
+		if ((int)img.width + 2 * padding > page_width || (int)img.height + 2 * padding > page_height)
+		{
+			std::cout << "Image is larger than the atlas page" << std::endl;
+			return -1;
+		}
+
+		images.push_back(img);
+		regions.push_back(Atlas_Region{glm::vec4(1.0f, 1.0f, 0.0f, 0.0f), 0.0f});
+
+		return (int)images.size() - 1;
+	}
+
+	bool
+	TextureAtlas::build()
+	{
+		pages.clear();
+
+		std::vector<stbrp_rect> pending(images.size());
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			pending[i].id = (int)i;
+			pending[i].w = images[i].width + 2 * padding;
+			pending[i].h = images[i].height + 2 * padding;
+		}
+
+		std::vector<stbrp_node> nodes(page_width);
+
+		// every pass fills one page with whatever fits, the rest goes to the next page
+		while (pending.empty() == false)
+		{
+			stbrp_context context;
+			stbrp_init_target(&context, page_width, page_height, nodes.data(), (int)nodes.size());
+			stbrp_pack_rects(&context, pending.data(), (int)pending.size());
+
+			auto page = std::make_unique<Image>(page_width, page_height, ncomponents);
+			auto layer = (float)pages.size();
+
+			std::vector<stbrp_rect> remaining;
+			for (auto& rect : pending)
+			{
+				if (rect.was_packed == 0)
+				{
+					remaining.push_back(rect);
+					continue;
+				}
+
+				auto& img = images[rect.id];
+				blit(page.get(), img, rect.x, rect.y);
+
+				auto& region = regions[rect.id];
+				region.uv_transform = glm::vec4(
+					(float)img.width / page_width,
+					(float)img.height / page_height,
+					(float)(rect.x + padding) / page_width,
+					(float)(rect.y + padding) / page_height);
+				region.layer = layer;
+			}
+
+			if (remaining.size() == pending.size())
+			{
+				std::cout << "Cannot pack images into the atlas page" << std::endl;
+				pages.clear();
+				return false;
+			}
+
+			pages.push_back(std::move(page));
+			pending.swap(remaining);
+		}
+
+		return true;
+	}
+
+	std::vector<Image*>
+	TextureAtlas::getPages()
+	{
+		std::vector<Image*> res;
+		for (auto& page : pages)
+			res.push_back(page.get());
+
+		return res;
+	}
+
+	const Atlas_Region&
+	TextureAtlas::getRegion(int index) const
+	{
+		return regions[index];
+	}
+
+	const std::vector<Atlas_Region>&
+	TextureAtlas::getRegions() const
+	{
+		return regions;
+	}
+
+	uint32_t
+	TextureAtlas::getPageCount() const
+	{
+		return (uint32_t)pages.size();
+	}
+
+	void
+	TextureAtlas::blit(Image* page, const ImageView& img, int x, int y)
+	{
+		int src_components = img.ncomponents;
+		int width = img.width + 2 * padding;
+		int height = img.height + 2 * padding;
+
+		// the padding repeats the image edges so filtering doesn't bleed the neighbours in
+		for (int j = 0; j < height; ++j)
+		{
+			int src_y = std::clamp(j - padding, 0, (int)img.height - 1);
+			for (int i = 0; i < width; ++i)
+			{
+				int src_x = std::clamp(i - padding, 0, (int)img.width - 1);
+
+				auto src = img.pixel(src_x, src_y);
+				auto dst = page->getData() + (size_t(y + j) * page_width + (x + i)) * ncomponents;
+
+				for (int c = 0; c < ncomponents; ++c)
+				{
+					if (c < src_components)
+						dst[c] = src[c];
+					else
+						dst[c] = c == 3 ? 255 : 0;
+				}
+			}
+		}
+	}
+} // namespace gfx
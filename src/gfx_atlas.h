@@ -0,0 +1,63 @@
+#pragma once
+
+#include "Image.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace gfx
+{
+	// location of a packed image inside the atlas pages, laid out to be used directly as per instance data
+	struct Atlas_Region
+	{
+		// xy scale and zw offset that map the image uvs to the page uvs
+		glm::vec4 uv_transform;
+
+		// page index inside the texture array
+		float layer;
+	};
+
+	class TextureAtlas
+	{
+	public:
+		TextureAtlas(int page_width, int page_height, int ncomponents, int padding = 1);
+
+		~TextureAtlas();
+
+		// queue an image for packing, returns its region index or -1 if it doesn't fit in a page
+		int
+		add(Image* img);
+
+		// the view memory must stay alive until build, sub views pack image parts without copying them first
+		int
+		add(const ImageView& img);
+
+		// pack all the queued images into pages
+		bool
+		build();
+
+		// pages are ready to be uploaded with createTexture2DArray
+		std::vector<Image*>
+		getPages();
+
+		const Atlas_Region&
+		getRegion(int index) const;
+
+		const std::vector<Atlas_Region>&
+		getRegions() const;
+
+		uint32_t
+		getPageCount() const;
+
+	private:
+		int page_width, page_height, ncomponents, padding;
+		std::vector<ImageView> images;
+		std::vector<Atlas_Region> regions;
+		std::vector<std::unique_ptr<Image>> pages;
+
+		void
+		blit(Image* page, const ImageView& img, int x, int y);
+	};
+} // namespace gfx
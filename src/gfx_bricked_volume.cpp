@@ -0,0 +1,702 @@
+#include "gfx_bricked_volume.h"
+#include "gfx.h"
+#include "gfx_formats.h"
+#include "gfx_program.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+#include <iostream>
+
+namespace gfx
+{
+	// bricks whose apron, one voxel on each side, holds the voxel i along an axis
+	inline static int
+	_apron_bricks(int i, int brick_size, int brick_count, int bricks[2])
+	{
+		int count = 0;
+		int brick = i / brick_size;
+		bricks[count++] = brick;
+
+		// first voxel of a brick is also the last apron voxel of the previous one and the other way around
+		if (i % brick_size == 0 && brick > 0)
+			bricks[count++] = brick - 1;
+		else if ((i + 1) % brick_size == 0 && brick + 1 < brick_count)
+			bricks[count++] = brick + 1;
+
+		return count;
+	}
+
+	inline static glm::ivec3
+	_slot_coord(uint32_t slot, const glm::ivec3& pool_slots)
+	{
+		return glm::ivec3(
+			slot % pool_slots.x,
+			(slot / pool_slots.x) % pool_slots.y,
+			slot / (pool_slots.x * pool_slots.y));
+	}
+
+	inline static int
+	_round_up(int value, int multiple)
+	{
+		return (value + multiple - 1) / multiple * multiple;
+	}
+
+	BrickedVolume::BrickedVolume(int brick_size, uint32_t texture_unit, bool allow_sparse)
+		: brick_size(brick_size),
+		  texture_unit(texture_unit),
+		  allow_sparse(allow_sparse),
+		  sparse(false),
+		  volume_size(0),
+		  brick_count(0),
+		  pool_slots(0),
+		  empty_threshold(0.0f),
+		  dense_size(0),
+		  pool_texture(0),
+		  page_table_texture(0),
+		  occupancy_texture(0),
+		  virtual_size(0)
+	{
+	}
+
+	BrickedVolume::~BrickedVolume()
+	{
+		releaseTextures();
+	}
+
+	bool
+	BrickedVolume::build(Image3D* volume, float empty_threshold, int channel)
+	{
+		if (brick_size != 8 && brick_size != 16)
+		{
+			std::cout << "Unsupported brick size, use 8 or 16" << std::endl;
+			return false;
+		}
+
+		if (!volume || !volume->hasData() || channel < 0 || channel >= volume->getChannels())
+		{
+			std::cout << "Empty volume or channel out of range" << std::endl;
+			return false;
+		}
+
+		this->empty_threshold = empty_threshold;
+		volume_size = glm::ivec3(volume->getWidth(), volume->getHeight(), volume->getDepth());
+		brick_count = (volume_size + brick_size - 1) / brick_size;
+		dense_size = volume->getSizeInBytes();
+
+		// value range of every brick including its apron, so a brick next to data is never dropped
+		auto brick_total = size_t(brick_count.x) * brick_count.y * brick_count.z;
+		std::vector<glm::vec2> ranges(brick_total, glm::vec2(FLT_MAX, -FLT_MAX));
+		std::vector<float> row(volume_size.x);
+		std::vector<glm::vec2> row_ranges(brick_count.x);
+
+		for (int z = 0; z < volume_size.z; ++z)
+		{
+			int bricks_z[2];
+			int count_z = _apron_bricks(z, brick_size, brick_count.z, bricks_z);
+
+			for (int y = 0; y < volume_size.y; ++y)
+			{
+				int bricks_y[2];
+				int count_y = _apron_bricks(y, brick_size, brick_count.y, bricks_y);
+
+				volume->readRow(y, z, row.data(), channel);
+
+				for (int bx = 0; bx < brick_count.x; ++bx)
+				{
+					int begin = std::max(bx * brick_size - 1, 0);
+					int end = std::min(bx * brick_size + brick_size + 1, volume_size.x);
+
+					auto [min, max] = std::minmax_element(row.begin() + begin, row.begin() + end);
+					row_ranges[bx] = glm::vec2(*min, *max);
+				}
+
+				for (int i = 0; i < count_z; ++i)
+				{
+					for (int j = 0; j < count_y; ++j)
+					{
+						for (int bx = 0; bx < brick_count.x; ++bx)
+						{
+							auto& range = ranges[brickIndex(bx, bricks_y[j], bricks_z[i])];
+							range.x = std::min(range.x, row_ranges[bx].x);
+							range.y = std::max(range.y, row_ranges[bx].y);
+						}
+					}
+				}
+			}
+		}
+
+		// page table, occupied bricks take the pool slots in order
+		page_table.assign(ranges.size(), BRICK_EMPTY);
+		slot_bricks.clear();
+
+		for (int bz = 0; bz < brick_count.z; ++bz)
+		{
+			for (int by = 0; by < brick_count.y; ++by)
+			{
+				for (int bx = 0; bx < brick_count.x; ++bx)
+				{
+					auto index = brickIndex(bx, by, bz);
+					if (ranges[index].y <= empty_threshold)
+						continue;
+
+					page_table[index] = uint32_t(slot_bricks.size());
+					slot_bricks.push_back(glm::ivec3(bx, by, bz));
+				}
+			}
+		}
+
+		// roughly cubic pool so it stays under the 3D texture size limits
+		int slots = std::max((int)slot_bricks.size(), 1);
+		int side = 1;
+		while (side * side * side < slots)
+			++side;
+		pool_slots = glm::ivec3(side, side, (slots + side * side - 1) / (side * side));
+
+		int padded = brick_size + 2;
+		pool = Image3D(pool_slots.x * padded, pool_slots.y * padded, pool_slots.z * padded, volume->getFormat());
+		if (!pool.hasData())
+			return false;
+
+		auto voxel_size = volume->getVoxelSize();
+		for (uint32_t slot = 0; slot < slot_bricks.size(); ++slot)
+		{
+			auto brick = slot_bricks[slot];
+			auto origin = _slot_coord(slot, pool_slots) * padded;
+			auto source = brick * brick_size - 1;
+
+			for (int lz = 0; lz < padded; ++lz)
+			{
+				int sz = std::clamp(source.z + lz, 0, volume_size.z - 1);
+				for (int ly = 0; ly < padded; ++ly)
+				{
+					int sy = std::clamp(source.y + ly, 0, volume_size.y - 1);
+
+					auto src = volume->getRow(sy, sz).data;
+					auto dst = pool.getRow(origin.y + ly, origin.z + lz).data + origin.x * voxel_size;
+					for (int lx = 0; lx < padded; ++lx)
+					{
+						int sx = std::clamp(source.x + lx, 0, volume_size.x - 1);
+						memcpy(dst + lx * voxel_size, src + sx * voxel_size, voxel_size);
+					}
+				}
+			}
+		}
+
+		buildOccupancyPyramid(ranges);
+		return true;
+	}
+
+	bool
+	BrickedVolume::upload(GFX* gfx)
+	{
+		if (page_table.empty())
+		{
+			std::cout << "Bricked volume has to be built before it's uploaded" << std::endl;
+			return false;
+		}
+
+		releaseTextures();
+
+		sparse = allow_sparse && GLEW_ARB_sparse_texture && uploadSparsePool();
+		if (sparse == false && uploadPool(gfx) == false)
+			return false;
+
+		return uploadPageTable() && uploadOccupancy();
+	}
+
+	void
+	BrickedVolume::bind(GFX* gfx)
+	{
+		glActiveTexture(GL_TEXTURE0 + texture_unit);
+		gfx->bindTexture3D(pool_texture);
+
+		glActiveTexture(GL_TEXTURE0 + texture_unit + 1);
+		gfx->bindTexture3D(page_table_texture);
+
+		glActiveTexture(GL_TEXTURE0 + texture_unit + 2);
+		gfx->bindTexture3D(occupancy_texture);
+
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	bool
+	BrickedVolume::isSparse() const
+	{
+		return sparse;
+	}
+
+	int
+	BrickedVolume::getBrickSize() const
+	{
+		return brick_size;
+	}
+
+	glm::ivec3
+	BrickedVolume::getBrickCount() const
+	{
+		return brick_count;
+	}
+
+	int
+	BrickedVolume::getOccupiedBrickCount() const
+	{
+		return (int)slot_bricks.size();
+	}
+
+	uint32_t
+	BrickedVolume::getBrickSlot(int bx, int by, int bz) const
+	{
+		if (bx < 0 || by < 0 || bz < 0 || bx >= brick_count.x || by >= brick_count.y || bz >= brick_count.z)
+			return BRICK_EMPTY;
+
+		return page_table[brickIndex(bx, by, bz)];
+	}
+
+	int
+	BrickedVolume::getOccupancyLevels() const
+	{
+		return (int)occupancy.size();
+	}
+
+	glm::ivec3
+	BrickedVolume::getOccupancySize(int level) const
+	{
+		return occupancy_sizes[level];
+	}
+
+	glm::vec2
+	BrickedVolume::getOccupancy(int level, int x, int y, int z) const
+	{
+		auto size = occupancy_sizes[level];
+		return occupancy[level][(size_t(z) * size.y + y) * size.x + x];
+	}
+
+	float
+	BrickedVolume::getVoxel(int x, int y, int z, int channel)
+	{
+		auto slot = getBrickSlot(x / brick_size, y / brick_size, z / brick_size);
+		if (slot == BRICK_EMPTY)
+			return 0.0f;
+
+		auto origin = _slot_coord(slot, pool_slots) * (brick_size + 2) + 1;
+		return pool.getPixel(
+			origin.x + x % brick_size,
+			origin.y + y % brick_size,
+			origin.z + z % brick_size,
+			channel);
+	}
+
+	size_t
+	BrickedVolume::getMemorySize() const
+	{
+		size_t res = pool.getSizeInBytes() + page_table.size() * sizeof(uint32_t);
+		for (auto& level : occupancy)
+			res += level.size() * sizeof(glm::vec2);
+
+		return res;
+	}
+
+	size_t
+	BrickedVolume::getDenseMemorySize() const
+	{
+		return dense_size;
+	}
+
+	std::string
+	BrickedVolume::injectShaderHeader(const char* shader) const
+	{
+		auto ivec3_str = [](const char* type, const glm::ivec3& v) {
+			return std::string(type) + "(" + std::to_string(v.x) + ", " + std::to_string(v.y) + ", " +
+				   std::to_string(v.z) + ")";
+		};
+
+		std::string header;
+
+		header += "layout(binding = " + std::to_string(texture_unit) + ") uniform sampler3D gfx_brick_pool;\n";
+		header += "layout(binding = " + std::to_string(texture_unit + 1) + ") uniform usampler3D gfx_brick_table;\n";
+		header += "layout(binding = " + std::to_string(texture_unit + 2) +
+				  ") uniform sampler3D gfx_brick_occupancy;\n";
+
+		header += "const vec3 gfx_volume_size = " + ivec3_str("vec3", volume_size) + ";\n";
+		header += "const ivec3 gfx_brick_count = " + ivec3_str("ivec3", brick_count) + ";\n";
+		header += "const float gfx_brick_size = " + std::to_string(brick_size) + ".0;\n";
+		header += "const vec3 gfx_brick_pool_size = " + ivec3_str("vec3", virtual_size) + ";\n";
+		header += "const int gfx_brick_occupancy_levels = " + std::to_string(occupancy.size()) + ";\n";
+		header += "const float gfx_brick_empty_threshold = " + std::to_string(empty_threshold) + ";\n";
+
+		// the last cell of a level also covers the bricks left over by the odd sizes of the level below
+		header += "ivec3 gfx_brickCell(vec3 uvw, int level)\n"
+				  "{\n"
+				  "	ivec3 brick = min(ivec3(clamp(uvw, 0.0, 1.0) * gfx_volume_size / gfx_brick_size), "
+				  "gfx_brick_count - 1);\n"
+				  "	ivec3 size = max(gfx_brick_count >> level, ivec3(1));\n"
+				  "	return min(brick >> level, size - 1);\n"
+				  "}\n"
+				  "vec2 gfx_brickOccupancy(vec3 uvw, int level)\n"
+				  "{\n"
+				  "	return texelFetch(gfx_brick_occupancy, gfx_brickCell(uvw, level), level).rg;\n"
+				  "}\n"
+				  "float gfx_brickExit(vec3 uvw, vec3 dir, int level)\n"
+				  "{\n"
+				  "	ivec3 cell = gfx_brickCell(uvw, level);\n"
+				  "	vec3 lo = vec3(cell << level) * gfx_brick_size / gfx_volume_size;\n"
+				  "	vec3 hi = vec3((cell + 1) << level) * gfx_brick_size / gfx_volume_size;\n"
+				  "	vec3 safe_dir = mix(vec3(-1e-6), vec3(1e-6), greaterThanEqual(dir, vec3(0.0)));\n"
+				  "	safe_dir = mix(safe_dir, dir, greaterThan(abs(dir), vec3(1e-6)));\n"
+				  "	vec3 t = (mix(lo, hi, greaterThan(safe_dir, vec3(0.0))) - uvw) / safe_dir;\n"
+				  "	return max(min(min(t.x, t.y), t.z), 0.0);\n"
+				  "}\n";
+
+		header += "vec4 gfx_sampleBrickedVolume(vec3 uvw)\n"
+				  "{\n"
+				  "	vec3 voxel = clamp(uvw, 0.0, 1.0) * gfx_volume_size;\n"
+				  "	ivec3 brick = min(ivec3(voxel / gfx_brick_size), gfx_brick_count - 1);\n"
+				  "	uvec4 entry = texelFetch(gfx_brick_table, brick, 0);\n"
+				  "	if (entry.w == 0u)\n"
+				  "		return vec4(0.0);\n";
+
+		// the sparse texture keeps the volume layout, the pool needs the brick moved to its slot
+		if (sparse)
+		{
+			header += "	return texture(gfx_brick_pool, voxel / gfx_brick_pool_size);\n";
+		}
+		else
+		{
+			header += "	vec3 local = voxel - vec3(brick) * gfx_brick_size;\n"
+					  "	vec3 texel = vec3(entry.xyz) * (gfx_brick_size + 2.0) + 1.0 + local;\n"
+					  "	return texture(gfx_brick_pool, texel / gfx_brick_pool_size);\n";
+		}
+
+		header += "}\n";
+
+		return injectHeader(shader, header);
+	}
+
+	size_t
+	BrickedVolume::brickIndex(int bx, int by, int bz) const
+	{
+		return (size_t(bz) * brick_count.y + by) * brick_count.x + bx;
+	}
+
+	void
+	BrickedVolume::buildOccupancyPyramid(std::vector<glm::vec2>& brick_ranges)
+	{
+		auto levels = mipLevelsCount(brick_count.x, brick_count.y, brick_count.z);
+
+		occupancy.clear();
+		occupancy_sizes.clear();
+
+		occupancy.push_back(std::move(brick_ranges));
+		occupancy_sizes.push_back(brick_count);
+
+		// sizes follow the opengl mip chain so the pyramid uploads as the mips of one texture
+		for (uint32_t level = 1; level < levels; ++level)
+		{
+			auto prev_size = occupancy_sizes.back();
+			auto size = glm::max(brick_count >> int(level), glm::ivec3(1));
+
+			std::vector<glm::vec2> cells(size_t(size.x) * size.y * size.z, glm::vec2(FLT_MAX, -FLT_MAX));
+			auto& prev = occupancy.back();
+
+			for (int z = 0; z < size.z; ++z)
+			{
+				int z_end = z == size.z - 1 ? prev_size.z : std::min(2 * z + 2, prev_size.z);
+				for (int y = 0; y < size.y; ++y)
+				{
+					int y_end = y == size.y - 1 ? prev_size.y : std::min(2 * y + 2, prev_size.y);
+					for (int x = 0; x < size.x; ++x)
+					{
+						int x_end = x == size.x - 1 ? prev_size.x : std::min(2 * x + 2, prev_size.x);
+
+						auto& cell = cells[(size_t(z) * size.y + y) * size.x + x];
+						for (int cz = 2 * z; cz < z_end; ++cz)
+						{
+							for (int cy = 2 * y; cy < y_end; ++cy)
+							{
+								for (int cx = 2 * x; cx < x_end; ++cx)
+								{
+									auto child = prev[(size_t(cz) * prev_size.y + cy) * prev_size.x + cx];
+									cell.x = std::min(cell.x, child.x);
+									cell.y = std::max(cell.y, child.y);
+								}
+							}
+						}
+					}
+				}
+			}
+
+			occupancy.push_back(std::move(cells));
+			occupancy_sizes.push_back(size);
+		}
+	}
+
+	bool
+	BrickedVolume::uploadPool(GFX* gfx)
+	{
+		GLint max_size = 0;
+		glGetIntegerv(GL_MAX_3D_TEXTURE_SIZE, &max_size);
+
+		if (pool.getWidth() > max_size || pool.getHeight() > max_size || pool.getDepth() > max_size)
+		{
+			std::cout << "Brick pool exceeds the max 3D texture size" << std::endl;
+			return false;
+		}
+
+		pool_texture =
+			gfx->createTexture3D(&pool, Wrapping_Mode::CLAMP_TO_EDGE, Filtering_Mode::LINEAR, Filtering_Mode::LINEAR, false);
+
+		if (pool_texture == -1)
+		{
+			pool_texture = 0;
+			return false;
+		}
+
+		virtual_size = glm::ivec3(pool.getWidth(), pool.getHeight(), pool.getDepth());
+		return true;
+	}
+
+	bool
+	BrickedVolume::uploadSparsePool()
+	{
+		auto format = pool.getFormat();
+		auto internal_format = textureInternalFormat(format);
+
+		GLint page_sizes = 0;
+		glGetInternalformativ(GL_TEXTURE_3D, internal_format, GL_NUM_VIRTUAL_PAGE_SIZES_ARB, 1, &page_sizes);
+		if (page_sizes <= 0)
+			return false;
+
+		glm::ivec3 page;
+		glGetInternalformativ(GL_TEXTURE_3D, internal_format, GL_VIRTUAL_PAGE_SIZE_X_ARB, 1, &page.x);
+		glGetInternalformativ(GL_TEXTURE_3D, internal_format, GL_VIRTUAL_PAGE_SIZE_Y_ARB, 1, &page.y);
+		glGetInternalformativ(GL_TEXTURE_3D, internal_format, GL_VIRTUAL_PAGE_SIZE_Z_ARB, 1, &page.z);
+
+		glm::ivec3 size = brick_count * brick_size;
+		size = glm::ivec3(_round_up(size.x, page.x), _round_up(size.y, page.y), _round_up(size.z, page.z));
+
+		GLint max_size = 0;
+		glGetIntegerv(GL_MAX_SPARSE_3D_TEXTURE_SIZE_ARB, &max_size);
+		if (size.x > max_size || size.y > max_size || size.z > max_size)
+			return false;
+
+		GLuint id = -1;
+		glGenTextures(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate sparse Texture3D" << std::endl;
+			return false;
+		}
+
+		glBindTexture(GL_TEXTURE_3D, id);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_SPARSE_ARB, GL_TRUE);
+		glTexParameteri(GL_TEXTURE_3D, GL_VIRTUAL_PAGE_SIZE_INDEX_ARB, 0);
+		glTexStorage3D(GL_TEXTURE_3D, 1, internal_format, size.x, size.y, size.z);
+
+		auto pixel_format = pixelFormat(textureFormatComponents(format));
+		auto pixel_type = textureTransferType(format);
+
+		// commit the pages touched by an occupied brick or its apron, everything else costs no memory
+		auto page_count = size / page;
+		std::vector<uint8_t> committed(size_t(page_count.x) * page_count.y * page_count.z, 0);
+
+		for (auto& brick : slot_bricks)
+		{
+			auto lo = glm::max(brick * brick_size - 1, glm::ivec3(0)) / page;
+			auto hi = (glm::min(brick * brick_size + brick_size + 1, size) - 1) / page;
+
+			for (int z = lo.z; z <= hi.z; ++z)
+				for (int y = lo.y; y <= hi.y; ++y)
+					for (int x = lo.x; x <= hi.x; ++x)
+						committed[(size_t(z) * page_count.y + y) * page_count.x + x] = 1;
+		}
+
+		for (int z = 0; z < page_count.z; ++z)
+		{
+			for (int y = 0; y < page_count.y; ++y)
+			{
+				for (int x = 0; x < page_count.x; ++x)
+				{
+					if (committed[(size_t(z) * page_count.y + y) * page_count.x + x] == 0)
+						continue;
+
+					auto offset = glm::ivec3(x, y, z) * page;
+					glTexPageCommitmentARB(GL_TEXTURE_3D, 0, offset.x, offset.y, offset.z, page.x, page.y, page.z, GL_TRUE);
+
+					// committed memory starts undefined and empty bricks sharing the page must read as 0
+					glClearTexSubImage(
+						id,
+						0,
+						offset.x,
+						offset.y,
+						offset.z,
+						page.x,
+						page.y,
+						page.z,
+						pixel_format,
+						pixel_type,
+						nullptr);
+				}
+			}
+		}
+
+		// bricks are copied straight out of the pool with their apron, neighbours write the same voxels
+		int padded = brick_size + 2;
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, pool.getWidth());
+		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, pool.getHeight());
+
+		for (uint32_t slot = 0; slot < slot_bricks.size(); ++slot)
+		{
+			auto brick = slot_bricks[slot];
+			auto dst_lo = glm::max(brick * brick_size - 1, glm::ivec3(0));
+			auto dst_hi = glm::min(brick * brick_size + brick_size + 1, size);
+			auto src = _slot_coord(slot, pool_slots) * padded + (dst_lo - (brick * brick_size - 1));
+			auto extent = dst_hi - dst_lo;
+
+			glPixelStorei(GL_UNPACK_SKIP_PIXELS, src.x);
+			glPixelStorei(GL_UNPACK_SKIP_ROWS, src.y);
+			glPixelStorei(GL_UNPACK_SKIP_IMAGES, src.z);
+
+			glTexSubImage3D(
+				GL_TEXTURE_3D,
+				0,
+				dst_lo.x,
+				dst_lo.y,
+				dst_lo.z,
+				extent.x,
+				extent.y,
+				extent.z,
+				pixel_format,
+				pixel_type,
+				pool.getData());
+		}
+
+		glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+		glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+		glPixelStorei(GL_UNPACK_SKIP_IMAGES, 0);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+		glPixelStorei(GL_UNPACK_IMAGE_HEIGHT, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		pool_texture = id;
+		virtual_size = size;
+		return true;
+	}
+
+	bool
+	BrickedVolume::uploadPageTable()
+	{
+		// xyz is the pool slot and w tells if the brick is resident
+		std::vector<uint16_t> entries(page_table.size() * 4, 0);
+		for (size_t i = 0; i < page_table.size(); ++i)
+		{
+			if (page_table[i] == BRICK_EMPTY)
+				continue;
+
+			auto slot = _slot_coord(page_table[i], pool_slots);
+			entries[i * 4 + 0] = uint16_t(slot.x);
+			entries[i * 4 + 1] = uint16_t(slot.y);
+			entries[i * 4 + 2] = uint16_t(slot.z);
+			entries[i * 4 + 3] = 1;
+		}
+
+		GLuint id = -1;
+		glGenTextures(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate page table Texture3D" << std::endl;
+			return false;
+		}
+
+		glBindTexture(GL_TEXTURE_3D, id);
+		glTexStorage3D(GL_TEXTURE_3D, 1, GL_RGBA16UI, brick_count.x, brick_count.y, brick_count.z);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		glTexSubImage3D(
+			GL_TEXTURE_3D,
+			0,
+			0,
+			0,
+			0,
+			brick_count.x,
+			brick_count.y,
+			brick_count.z,
+			GL_RGBA_INTEGER,
+			GL_UNSIGNED_SHORT,
+			entries.data());
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		page_table_texture = id;
+		return true;
+	}
+
+	bool
+	BrickedVolume::uploadOccupancy()
+	{
+		GLuint id = -1;
+		glGenTextures(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate occupancy Texture3D" << std::endl;
+			return false;
+		}
+
+		glBindTexture(GL_TEXTURE_3D, id);
+		glTexStorage3D(GL_TEXTURE_3D, (GLsizei)occupancy.size(), GL_RG32F, brick_count.x, brick_count.y, brick_count.z);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t level = 0; level < occupancy.size(); ++level)
+		{
+			auto size = occupancy_sizes[level];
+			glTexSubImage3D(
+				GL_TEXTURE_3D,
+				(GLint)level,
+				0,
+				0,
+				0,
+				size.x,
+				size.y,
+				size.z,
+				GL_RG,
+				GL_FLOAT,
+				occupancy[level].data());
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		occupancy_texture = id;
+		return true;
+	}
+
+	void
+	BrickedVolume::releaseTextures()
+	{
+		for (auto texture : {&pool_texture, &page_table_texture, &occupancy_texture})
+		{
+			if (*texture)
+				glDeleteTextures(1, texture);
+			*texture = 0;
+		}
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "Image3D.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	class GFX;
+
+	// sparse volume made of fixed size bricks, only the bricks holding data are kept in a pool and a page table
+	// maps every brick of the volume to its pool slot, a min/max pyramid over the bricks lets raymarchers skip
+	// the empty space. uploads as a brick pool texture and an indirection texture, or as a sparse texture with
+	// only the occupied pages committed when ARB_sparse_texture is available
+	class BrickedVolume
+	{
+	public:
+		static constexpr uint32_t BRICK_EMPTY = 0xFFFFFFFF;
+
+		// brick_size is 8 or 16, the pool, the page table and the occupancy pyramid are bound to texture_unit,
+		// texture_unit + 1 and texture_unit + 2
+		BrickedVolume(int brick_size = 8, uint32_t texture_unit = 0, bool allow_sparse = true);
+
+		BrickedVolume(const BrickedVolume&) = delete;
+
+		BrickedVolume&
+		operator=(const BrickedVolume&) = delete;
+
+		~BrickedVolume();
+
+		// splits the volume in bricks and drops the ones where channel never goes above empty_threshold
+		bool
+		build(Image3D* volume, float empty_threshold = 0.0f, int channel = 0);
+
+		// creates the textures, build has to be called first
+		bool
+		upload(GFX* gfx);
+
+		void
+		bind(GFX* gfx);
+
+		bool
+		isSparse() const;
+
+		int
+		getBrickSize() const;
+
+		glm::ivec3
+		getBrickCount() const;
+
+		int
+		getOccupiedBrickCount() const;
+
+		// pool slot of the brick or BRICK_EMPTY
+		uint32_t
+		getBrickSlot(int bx, int by, int bz) const;
+
+		int
+		getOccupancyLevels() const;
+
+		glm::ivec3
+		getOccupancySize(int level) const;
+
+		// min and max of the bricks covered by the occupancy cell, level 0 has one cell per brick
+		glm::vec2
+		getOccupancy(int level, int x, int y, int z) const;
+
+		// voxel value read back through the page table, empty bricks read as 0
+		float
+		getVoxel(int x, int y, int z, int channel = 0);
+
+		// cpu memory of the pool, page table and pyramid against the dense volume
+		size_t
+		getMemorySize() const;
+
+		size_t
+		getDenseMemorySize() const;
+
+		// call after upload, inserts the volume declarations after the #version and #extension lines along with
+		// vec4 gfx_sampleBrickedVolume(vec3 uvw), vec2 gfx_brickOccupancy(vec3 uvw, int level) and
+		// float gfx_brickExit(vec3 uvw, vec3 dir, int level) which is the ray distance to leave the occupancy cell
+		std::string
+		injectShaderHeader(const char* shader) const;
+
+	private:
+		int brick_size;
+		uint32_t texture_unit;
+		bool allow_sparse, sparse;
+
+		glm::ivec3 volume_size, brick_count, pool_slots;
+		float empty_threshold;
+		size_t dense_size;
+
+		// pool bricks carry a one voxel apron so trilinear filtering doesn't bleed into the neighbour slots
+		Image3D pool;
+		std::vector<uint32_t> page_table;
+		std::vector<glm::ivec3> slot_bricks;
+		std::vector<glm::ivec3> occupancy_sizes;
+		std::vector<std::vector<glm::vec2>> occupancy;
+
+		uint32_t pool_texture, page_table_texture, occupancy_texture;
+		glm::ivec3 virtual_size;
+
+		size_t
+		brickIndex(int bx, int by, int bz) const;
+
+		void
+		buildOccupancyPyramid(std::vector<glm::vec2>& brick_ranges);
+
+		bool
+		uploadPool(GFX* gfx);
+
+		bool
+		uploadSparsePool();
+
+		bool
+		uploadPageTable();
+
+		bool
+		uploadOccupancy();
+
+		void
+		releaseTextures();
+	};
+} // namespace gfx
\ No newline at end of file
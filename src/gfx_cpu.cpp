@@ -0,0 +1,74 @@
+#include "gfx_cpu.h"
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+namespace gfx
+{
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+	inline static bool
+	_os_saves_ymm()
+	{
+		int info[4];
+		__cpuid(info, 1);
+
+		bool osxsave = (info[2] & (1 << 27)) != 0;
+		return osxsave && (_xgetbv(0) & 0x6) == 0x6;
+	}
+#endif
+
+	bool
+	cpuHasAVX2()
+	{
+		static const bool supported = []() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			int info[4];
+			__cpuid(info, 0);
+			if (info[0] < 7 || _os_saves_ymm() == false)
+				return false;
+
+			__cpuid(info, 1);
+			bool fma = (info[2] & (1 << 12)) != 0;
+
+			__cpuidex(info, 7, 0);
+			bool avx2 = (info[1] & (1 << 5)) != 0;
+
+			return fma && avx2;
+#else
+			return false;
+#endif
+		}();
+
+		return supported;
+	}
+
+	bool
+	cpuHasF16C()
+	{
+		static const bool supported = []() {
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+			__builtin_cpu_init();
+			return __builtin_cpu_supports("avx") && __builtin_cpu_supports("f16c");
+#elif defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+			if (_os_saves_ymm() == false)
+				return false;
+
+			int info[4];
+			__cpuid(info, 1);
+			bool avx = (info[2] & (1 << 28)) != 0;
+			bool f16c = (info[2] & (1 << 29)) != 0;
+
+			return avx && f16c;
+#else
+			return false;
+#endif
+		}();
+
+		return supported;
+	}
+} // namespace gfx
\ No newline at end of file
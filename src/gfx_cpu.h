@@ -0,0 +1,14 @@
+#pragma once
+
+namespace gfx
+{
+	// runtime cpu feature checks, they also make sure the os saves the ymm registers
+
+	// AVX2 together with FMA
+	bool
+	cpuHasAVX2();
+
+	// hardware float <-> half conversion
+	bool
+	cpuHasF16C();
+} // namespace gfx
\ No newline at end of file
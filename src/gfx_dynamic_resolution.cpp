@@ -0,0 +1,346 @@
+#include "gfx_dynamic_resolution.h"
+#include "gfx.h"
+#include "gfx_program.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace gfx
+{
+	static const char* const dynamic_resolution_vertex_shader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		uniform vec2 uv_scale;
+
+		out vec2 uv;
+
+		void main()
+		{
+			uv = (Position.xy * 0.5 + 0.5) * uv_scale;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+	// catmull-rom in 9 bilinear taps, the taps are clamped half a texel inside the rendered region so nothing left
+	// in the rest of the framebuffer bleeds in. the sharpening is clamped to the neighbourhood so it can't ring
+	static const char* const dynamic_resolution_fragment_shader = R"(
+		#version 450 core
+		layout(binding = 0) uniform sampler2D source;
+
+		uniform vec2 uv_scale;
+		uniform float sharpness;
+
+		in vec2 uv;
+
+		out vec4 FragColor;
+
+		vec4 fetch(vec2 p)
+		{
+			vec2 half_texel = 0.5 / vec2(textureSize(source, 0));
+			return textureLod(source, clamp(p, half_texel, uv_scale - half_texel), 0.0);
+		}
+
+		vec4 catmullRom(vec2 p)
+		{
+			vec2 size = vec2(textureSize(source, 0));
+			vec2 sample_pos = p * size;
+			vec2 texel1 = floor(sample_pos - 0.5) + 0.5;
+			vec2 f = sample_pos - texel1;
+
+			vec2 w0 = f * (-0.5 + f * (1.0 - 0.5 * f));
+			vec2 w1 = 1.0 + f * f * (-2.5 + 1.5 * f);
+			vec2 w2 = f * (0.5 + f * (2.0 - 1.5 * f));
+			vec2 w3 = f * f * (-0.5 + 0.5 * f);
+
+			// the two middle taps share one bilinear fetch
+			vec2 w12 = w1 + w2;
+			vec2 p0 = (texel1 - 1.0) / size;
+			vec2 p12 = (texel1 + w2 / w12) / size;
+			vec2 p3 = (texel1 + 2.0) / size;
+
+			vec4 result = vec4(0.0);
+			result += fetch(vec2(p0.x, p0.y)) * w0.x * w0.y;
+			result += fetch(vec2(p12.x, p0.y)) * w12.x * w0.y;
+			result += fetch(vec2(p3.x, p0.y)) * w3.x * w0.y;
+			result += fetch(vec2(p0.x, p12.y)) * w0.x * w12.y;
+			result += fetch(vec2(p12.x, p12.y)) * w12.x * w12.y;
+			result += fetch(vec2(p3.x, p12.y)) * w3.x * w12.y;
+			result += fetch(vec2(p0.x, p3.y)) * w0.x * w3.y;
+			result += fetch(vec2(p12.x, p3.y)) * w12.x * w3.y;
+			result += fetch(vec2(p3.x, p3.y)) * w3.x * w3.y;
+			return result;
+		}
+
+		void main()
+		{
+			vec4 color = catmullRom(uv);
+
+			if (sharpness > 0.0)
+			{
+				vec2 texel = 1.0 / vec2(textureSize(source, 0));
+				vec4 n0 = fetch(uv + vec2(texel.x, 0.0));
+				vec4 n1 = fetch(uv - vec2(texel.x, 0.0));
+				vec4 n2 = fetch(uv + vec2(0.0, texel.y));
+				vec4 n3 = fetch(uv - vec2(0.0, texel.y));
+
+				vec4 low = min(min(n0, n1), min(n2, n3));
+				vec4 high = max(max(n0, n1), max(n2, n3));
+				vec4 blur = (n0 + n1 + n2 + n3) * 0.25;
+				color = clamp(color + (color - blur) * sharpness, min(low, color), max(high, color));
+			}
+
+			FragColor = color;
+		})";
+
+	DynamicResolution::DynamicResolution(
+		int width,
+		int height,
+		Texture_Format color_format,
+		Depth_Format depth_format,
+		const Dynamic_Resolution_Settings& settings)
+		: settings(settings),
+		  color_format(color_format),
+		  depth_format(depth_format),
+		  width(std::max(width, 1)),
+		  height(std::max(height, 1)),
+		  scale(settings.max_scale),
+		  gpu_ms(0.0f),
+		  pixel_cost(0.0f),
+		  upscale_program(0),
+		  vertex_buffer(0),
+		  mesh(0),
+		  queries{},
+		  query_scales{},
+		  pending{},
+		  query_index(0),
+		  timing(false)
+	{
+	}
+
+	DynamicResolution::~DynamicResolution()
+	{
+		glDeleteProgram(upscale_program);
+		glDeleteVertexArrays(1, &mesh);
+		glDeleteBuffers(1, &vertex_buffer);
+		if (queries[0][0])
+			glDeleteQueries(QUERY_FRAMES * 2, &queries[0][0]);
+	}
+
+	bool
+	DynamicResolution::init(GFX* gfx)
+	{
+		// clang-format off
+		float vertices[] = {
+			-1.0f, -1.0f, 0.0f,
+			 1.0f, -1.0f, 0.0f,
+			-1.0f,  1.0f, 0.0f,
+			 1.0f,  1.0f, 0.0f
+		};
+		// clang-format on
+
+		vertex_buffer = gfx->createVertexBuffer(vertices, sizeof(vertices), BUFFER_USAGE::STATIC);
+
+		Attributes attributes;
+		attributes.append(GPU_Attribute(GPU_Attribute::VEC3, "POSITION"));
+		mesh = gfx->createGPUMesh(vertex_buffer, attributes);
+
+		upscale_program = gfx->createGPUProgram(dynamic_resolution_vertex_shader, dynamic_resolution_fragment_shader);
+
+		glGenQueries(QUERY_FRAMES * 2, &queries[0][0]);
+
+		setSettings(settings);
+		updateFramebuffer();
+		return isProgramLinked(upscale_program);
+	}
+
+	void
+	DynamicResolution::resize(int width, int height)
+	{
+		if (width <= 0 || height <= 0 || (width == this->width && height == this->height))
+			return;
+
+		this->width = width;
+		this->height = height;
+		updateFramebuffer();
+	}
+
+	void
+	DynamicResolution::setSettings(const Dynamic_Resolution_Settings& settings)
+	{
+		auto max_scale_changed = settings.max_scale != this->settings.max_scale;
+
+		this->settings = settings;
+		this->settings.min_scale = std::clamp(settings.min_scale, 0.1f, 1.0f);
+		this->settings.max_scale = std::max(settings.max_scale, this->settings.min_scale);
+		this->settings.smoothing = std::clamp(settings.smoothing, 0.01f, 1.0f);
+		this->settings.target_ms = std::max(settings.target_ms, 0.1f);
+
+		scale = std::clamp(scale, this->settings.min_scale, this->settings.max_scale);
+
+		if (max_scale_changed && framebuffer)
+			updateFramebuffer();
+	}
+
+	const Dynamic_Resolution_Settings&
+	DynamicResolution::getSettings() const
+	{
+		return settings;
+	}
+
+	void
+	DynamicResolution::begin()
+	{
+		// when the gpu is more than QUERY_FRAMES behind, this frame goes untimed instead of waiting on it
+		timing = queries[query_index][0] != 0 && !pending[query_index];
+		if (timing)
+		{
+			glQueryCounter(queries[query_index][0], GL_TIMESTAMP);
+			query_scales[query_index] = scale;
+		}
+
+		auto size = getRenderSize();
+		framebuffer->Bind();
+		glViewport(0, 0, size.x, size.y);
+	}
+
+	void
+	DynamicResolution::end()
+	{
+		if (timing)
+		{
+			glQueryCounter(queries[query_index][1], GL_TIMESTAMP);
+			pending[query_index] = true;
+			query_index = (query_index + 1) % QUERY_FRAMES;
+			timing = false;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, width, height);
+
+		readTimings();
+	}
+
+	void
+	DynamicResolution::upscale(GFX* gfx)
+	{
+		glViewport(0, 0, width, height);
+
+		GLboolean depth_test = glIsEnabled(GL_DEPTH_TEST);
+		GLboolean blend = glIsEnabled(GL_BLEND);
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+
+		gfx->bindTextureUnit(framebuffer->GetTexture(), 0);
+		gfx->bindGPUProgram(upscale_program);
+		gfx->setGPUProgramVec2(upscale_program, "uv_scale", getUVScale());
+		gfx->setGPUProgramFloat(upscale_program, "sharpness", std::max(settings.sharpness, 0.0f));
+
+		gfx->draw(GFX_Primitive::TRIANGLES_STRIP, mesh, 4);
+
+		if (depth_test)
+			glEnable(GL_DEPTH_TEST);
+		if (blend)
+			glEnable(GL_BLEND);
+	}
+
+	float
+	DynamicResolution::getScale() const
+	{
+		return scale;
+	}
+
+	glm::ivec2
+	DynamicResolution::getRenderSize() const
+	{
+		// never past the allocation, which is rounded up from the same scale
+		auto size = glm::ivec2(std::lround(width * scale), std::lround(height * scale));
+		auto desc_size = framebuffer ? glm::ivec2(framebuffer->GetDesc().width, framebuffer->GetDesc().height)
+									 : size;
+		return glm::clamp(size, glm::ivec2(1), desc_size);
+	}
+
+	float
+	DynamicResolution::getGPUTime() const
+	{
+		return gpu_ms;
+	}
+
+	Framebuffer*
+	DynamicResolution::getFramebuffer() const
+	{
+		return framebuffer.get();
+	}
+
+	glm::vec2
+	DynamicResolution::getUVScale() const
+	{
+		if (!framebuffer)
+			return glm::vec2(1.0f);
+
+		auto& desc = framebuffer->GetDesc();
+		return glm::vec2(getRenderSize()) / glm::vec2(desc.width, desc.height);
+	}
+
+	void
+	DynamicResolution::updateFramebuffer()
+	{
+		Framebuffer_Desc desc;
+		desc.width = std::max(int(std::ceil(width * settings.max_scale)), 1);
+		desc.height = std::max(int(std::ceil(height * settings.max_scale)), 1);
+		desc.color_formats = {color_format};
+		desc.depth_format = depth_format;
+
+		if (framebuffer && framebuffer->GetDesc().width == desc.width && framebuffer->GetDesc().height == desc.height)
+			return;
+
+		// color attachments come out linear filtered and clamped, which the upscale relies on
+		framebuffer = std::make_unique<Framebuffer>(desc);
+	}
+
+	void
+	DynamicResolution::readTimings()
+	{
+		// oldest first, stop at the first pair the gpu hasn't reached so the measurements stay in order
+		for (int i = 0; i < QUERY_FRAMES; ++i)
+		{
+			auto index = (query_index + i) % QUERY_FRAMES;
+			if (!pending[index])
+				continue;
+
+			GLint available = GL_FALSE;
+			glGetQueryObjectiv(queries[index][1], GL_QUERY_RESULT_AVAILABLE, &available);
+			if (available == GL_FALSE)
+				break;
+
+			GLuint64 start = 0, stop = 0;
+			glGetQueryObjectui64v(queries[index][0], GL_QUERY_RESULT, &start);
+			glGetQueryObjectui64v(queries[index][1], GL_QUERY_RESULT, &stop);
+			pending[index] = false;
+
+			if (stop > start)
+				adjustScale(float(stop - start) * 1e-6f, query_scales[index]);
+		}
+	}
+
+	void
+	DynamicResolution::adjustScale(float ms, float measured_scale)
+	{
+		gpu_ms = gpu_ms > 0.0f ? gpu_ms + (ms - gpu_ms) * settings.smoothing : ms;
+
+		// the cost follows the pixel count, which is the square of the scale the timing was measured at. timings
+		// come back a few frames late, scaling the current scale by them would keep correcting what the frames
+		// in between already corrected
+		auto cost = ms / (measured_scale * measured_scale);
+		pixel_cost = pixel_cost > 0.0f ? pixel_cost + (cost - pixel_cost) * settings.smoothing : cost;
+
+		auto predicted_ms = pixel_cost * scale * scale;
+		if (std::abs(1.0f - settings.target_ms / predicted_ms) <= settings.dead_band)
+			return;
+
+		auto desired = std::sqrt(settings.target_ms / pixel_cost);
+		desired = std::clamp(desired, scale - settings.max_step, scale + settings.max_step);
+		scale = std::clamp(desired, settings.min_scale, settings.max_scale);
+	}
+} // namespace gfx
\ No newline at end of file
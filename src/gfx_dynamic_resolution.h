@@ -0,0 +1,131 @@
+#pragma once
+
+#include "gfx_fbo.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+
+namespace gfx
+{
+	class GFX;
+
+	struct Dynamic_Resolution_Settings
+	{
+		// gpu time the scene between begin and end should take, in milliseconds
+		float target_ms = 12.0f;
+
+		// fraction of the window size the scene may render at
+		float min_scale = 0.5f;
+		float max_scale = 1.0f;
+
+		// the scale is left alone while the time predicted for it is within this fraction of the target, so it
+		// doesn't hunt around the target, and moves at most max_step per measurement
+		float dead_band = 0.08f;
+		float max_step = 0.05f;
+
+		// weight of the newest measurement in the moving average of the gpu time
+		float smoothing = 0.2f;
+
+		// contrast limited sharpening after the bicubic upscale, 0 turns it off
+		float sharpness = 0.25f;
+	};
+
+	// renders the scene into a framebuffer at a fraction of the window size, the fraction follows the gpu time
+	// of the scene measured with timestamp queries so the frame time stays near the target whatever the load.
+	// the framebuffer is allocated once at max_scale and the scene renders into a smaller viewport of it so
+	// changing the scale never reallocates. the result is upscaled to the framebuffer bound when upscale is
+	// called, ui drawn after that stays at the native resolution
+	class DynamicResolution
+	{
+	public:
+		DynamicResolution(
+			int width,
+			int height,
+			Texture_Format color_format = RGBA8,
+			Depth_Format depth_format = DEPTH24_STENCIL8,
+			const Dynamic_Resolution_Settings& settings = Dynamic_Resolution_Settings{});
+
+		DynamicResolution(const DynamicResolution&) = delete;
+
+		DynamicResolution&
+		operator=(const DynamicResolution&) = delete;
+
+		~DynamicResolution();
+
+		// compiles the upscale program and creates the framebuffer and queries, call once the context is up
+		bool
+		init(GFX* gfx);
+
+		// size of the window, the framebuffer follows it
+		void
+		resize(int width, int height);
+
+		void
+		setSettings(const Dynamic_Resolution_Settings& settings);
+
+		const Dynamic_Resolution_Settings&
+		getSettings() const;
+
+		// binds the framebuffer with the viewport of the current render size and starts timing
+		void
+		begin();
+
+		// stops timing, unbinds the framebuffer and adjusts the scale from the timings the gpu has finished
+		void
+		end();
+
+		// bicubic upscale of the rendered color to the bound framebuffer with a viewport of the window size
+		void
+		upscale(GFX* gfx);
+
+		float
+		getScale() const;
+
+		glm::ivec2
+		getRenderSize() const;
+
+		// moving average of the measured gpu time in milliseconds, 0 until the first timing comes back
+		float
+		getGPUTime() const;
+
+		// the rendered region is getRenderSize, sample it with uv * getUVScale
+		Framebuffer*
+		getFramebuffer() const;
+
+		glm::vec2
+		getUVScale() const;
+
+	private:
+		// timings come back a few frames late, a query pair per frame in flight
+		static constexpr int QUERY_FRAMES = 4;
+
+		Dynamic_Resolution_Settings settings;
+		Texture_Format color_format;
+		Depth_Format depth_format;
+		int width, height;
+		float scale, gpu_ms;
+
+		// smoothed gpu time per unit of scale squared, it doesn't go stale when the scale moves while timings
+		// are still in flight
+		float pixel_cost;
+
+		std::unique_ptr<Framebuffer> framebuffer;
+		uint32_t upscale_program, vertex_buffer, mesh;
+
+		uint32_t queries[QUERY_FRAMES][2];
+		float query_scales[QUERY_FRAMES];
+		bool pending[QUERY_FRAMES];
+		int query_index;
+		bool timing;
+
+		void
+		updateFramebuffer();
+
+		void
+		readTimings();
+
+		void
+		adjustScale(float ms, float measured_scale);
+	};
+} // namespace gfx
\ No newline at end of file
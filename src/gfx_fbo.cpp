@@ -1,4 +1,5 @@
 #include "gfx_fbo.h"
+#include "gfx_formats.h"
 
 #include <GL/glew.h>
 
@@ -6,65 +7,155 @@
 
 namespace gfx
 {
-	Framebuffer::Framebuffer(int width, int height, FrameBuffer_Mode mode) : width(width), height(height), mode(mode)
+	inline static Framebuffer_Desc
+	_mode_desc(int width, int height, FrameBuffer_Mode mode)
 	{
+		Framebuffer_Desc desc;
+		desc.width = width;
+		desc.height = height;
+
 		switch (mode)
 		{
 		case gfx::RenderBuffer:
-			createRenderBuffer();
+			desc.color_formats = {RGB8};
 			break;
-		case gfx::DepthBuffer:
-			createDepthBuffer();
+		case gfx::HDRBuffer:
+			desc.color_formats = {RGBA16F};
 			break;
+		case gfx::DepthBuffer:
 		case gfx::DepthCubeMap:
-			createDepthCubeMapBuffer();
+			desc.depth_format = DEPTH24;
+			desc.sampleable_depth = true;
 			break;
 		default:
 			break;
 		}
+
+		return desc;
 	}
 
-	Framebuffer::~Framebuffer()
+	// multisampled textures take no sampler state, they're read with texelFetch
+	inline static GLuint
+	_attachment_texture(GLenum internal_format, GLint filter, const Framebuffer_Desc& desc)
 	{
-		switch (mode)
+		GLuint texture = 0;
+
+		if (desc.samples > 1)
 		{
-		case gfx::RenderBuffer:
-			deleteRenderBuffer();
-			break;
-		case gfx::DepthBuffer:
-			deleteDepthBuffer();
-			break;
-		case gfx::DepthCubeMap:
-			deleteDepthCubeMapBuffer();
-			break;
-		default:
-			break;
+			glGenTextures(1, &texture);
+			glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, texture);
+			glTexStorage2DMultisample(
+				GL_TEXTURE_2D_MULTISAMPLE,
+				desc.samples,
+				internal_format,
+				desc.width,
+				desc.height,
+				GL_TRUE);
+			glBindTexture(GL_TEXTURE_2D_MULTISAMPLE, 0);
+			return texture;
+		}
+
+		glGenTextures(1, &texture);
+		glBindTexture(GL_TEXTURE_2D, texture);
+		glTexStorage2D(GL_TEXTURE_2D, 1, internal_format, desc.width, desc.height);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glBindTexture(GL_TEXTURE_2D, 0);
+		return texture;
+	}
+
+	Framebuffer::Framebuffer(int width, int height, FrameBuffer_Mode mode)
+		: fbo(0), depth_texture(0), rbo(0), desc(_mode_desc(width, height, mode)), mode(mode)
+	{
+		if (mode == gfx::DepthCubeMap)
+			createDepthCubeMapBuffer();
+		else
+			createAttachments();
+	}
+
+	Framebuffer::Framebuffer(const Framebuffer_Desc& desc)
+		: fbo(0), depth_texture(0), rbo(0), desc(desc), mode(gfx::RenderBuffer)
+	{
+		if (this->desc.color_formats.size() > MAX_COLOR_ATTACHMENTS)
+		{
+			std::cout << "Framebuffer supports up to " << MAX_COLOR_ATTACHMENTS << " color attachments" << std::endl;
+			this->desc.color_formats.resize(MAX_COLOR_ATTACHMENTS);
+		}
+
+		GLint max_samples = 1;
+		glGetIntegerv(GL_MAX_SAMPLES, &max_samples);
+		if (this->desc.samples > max_samples)
+		{
+			std::cout << "Framebuffer samples clamped to " << max_samples << std::endl;
+			this->desc.samples = max_samples;
 		}
+
+		// compressed formats can't be rendered to
+		for (auto& format : this->desc.color_formats)
+		{
+			if (isCompressedFormat(format))
+			{
+				std::cout << "Compressed color attachment replaced by RGBA8" << std::endl;
+				format = RGBA8;
+			}
+		}
+
+		createAttachments();
+	}
+
+	Framebuffer::~Framebuffer()
+	{
+		deleteAttachments();
 	}
 
 	void
-	Framebuffer::createRenderBuffer()
+	Framebuffer::createAttachments()
 	{
 		glGenFramebuffers(1, &fbo);
 		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
-		// create a color attachment texture
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, width, height, 0, GL_RGB, GL_UNSIGNED_BYTE, nullptr);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, texture, 0);
+		// create the color attachment textures
+		for (auto format : desc.color_formats)
+		{
+			auto filter = isIntegerFormat(format) ? GL_NEAREST : GL_LINEAR;
+			auto texture = _attachment_texture(textureInternalFormat(format), filter, desc);
+
+			auto attachment = GL_COLOR_ATTACHMENT0 + GLenum(color_textures.size());
+			glFramebufferTexture(GL_FRAMEBUFFER, attachment, texture, 0);
 
-		// Create renderbuffer for depth and stencil
-		glGenRenderbuffers(1, &rbo);
-		glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+			color_textures.push_back(texture);
+		}
 
-		// use a single renderbuffer object for both a depth AND stencil buffer.
-		glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, width, height);
+		setDrawBuffers();
 
-		// attach frame buffer
-		glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rbo);
+		if (desc.depth_format != NO_DEPTH)
+		{
+			auto internal_format = depthInternalFormat(desc.depth_format);
+			auto attachment = hasStencil(desc.depth_format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+
+			if (desc.sampleable_depth)
+			{
+				depth_texture = _attachment_texture(internal_format, GL_LINEAR, desc);
+				glFramebufferTexture(GL_FRAMEBUFFER, attachment, depth_texture, 0);
+			}
+			else
+			{
+				glGenRenderbuffers(1, &rbo);
+				glBindRenderbuffer(GL_RENDERBUFFER, rbo);
+				if (desc.samples > 1)
+					glRenderbufferStorageMultisample(
+						GL_RENDERBUFFER,
+						desc.samples,
+						internal_format,
+						desc.width,
+						desc.height);
+				else
+					glRenderbufferStorage(GL_RENDERBUFFER, internal_format, desc.width, desc.height);
+				glFramebufferRenderbuffer(GL_FRAMEBUFFER, attachment, GL_RENDERBUFFER, rbo);
+			}
+		}
 
 		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
 		{
@@ -75,40 +166,32 @@ namespace gfx
 	}
 
 	void
-	Framebuffer::createDepthBuffer()
+	Framebuffer::setDrawBuffers()
 	{
-		glGenFramebuffers(1, &fbo);
-		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
-
-		// create a depth texture
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_2D, texture);
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT, width, height, 0, GL_DEPTH_COMPONENT, GL_FLOAT, NULL);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		// depth only framebuffers draw to nothing
+		if (color_textures.empty())
+		{
+			glNamedFramebufferDrawBuffer(fbo, GL_NONE);
+			glNamedFramebufferReadBuffer(fbo, GL_NONE);
+			return;
+		}
 
-		// attach depth texture as FBO's depth buffer
-		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, texture, 0);
-		glDrawBuffer(GL_NONE);
-		glReadBuffer(GL_NONE);
-		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		std::vector<GLenum> draw_buffers;
+		for (size_t i = 0; i < color_textures.size(); ++i)
+			draw_buffers.push_back(GLenum(GL_COLOR_ATTACHMENT0 + i));
+		glNamedFramebufferDrawBuffers(fbo, GLsizei(draw_buffers.size()), draw_buffers.data());
 	}
 
 	void
-	Framebuffer::deleteRenderBuffer()
+	Framebuffer::deleteAttachments()
 	{
 		glDeleteFramebuffers(1, &fbo);
-		glDeleteTextures(1, &texture);
+		glDeleteTextures(GLsizei(color_textures.size()), color_textures.data());
+		glDeleteTextures(1, &depth_texture);
 		glDeleteRenderbuffers(1, &rbo);
-	}
 
-	void
-	Framebuffer::deleteDepthBuffer()
-	{
-		glDeleteFramebuffers(1, &fbo);
-		glDeleteTextures(1, &texture);
+		fbo = depth_texture = rbo = 0;
+		color_textures.clear();
 	}
 
 	void
@@ -118,15 +201,15 @@ namespace gfx
 		glBindFramebuffer(GL_FRAMEBUFFER, fbo);
 
 		// create depth cubemap texture
-		glGenTextures(1, &texture);
-		glBindTexture(GL_TEXTURE_CUBE_MAP, texture);
+		glGenTextures(1, &depth_texture);
+		glBindTexture(GL_TEXTURE_CUBE_MAP, depth_texture);
 		for (unsigned int i = 0; i < 6; ++i)
 			glTexImage2D(
 				GL_TEXTURE_CUBE_MAP_POSITIVE_X + i,
 				0,
 				GL_DEPTH_COMPONENT,
-				width,
-				height,
+				desc.width,
+				desc.height,
 				0,
 				GL_DEPTH_COMPONENT,
 				GL_FLOAT,
@@ -137,19 +220,12 @@ namespace gfx
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 		glTexParameteri(GL_TEXTURE_CUBE_MAP, GL_TEXTURE_WRAP_R, GL_CLAMP_TO_EDGE);
 
-		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, texture, 0);
+		glFramebufferTexture(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, depth_texture, 0);
 		glDrawBuffer(GL_NONE);
 		glReadBuffer(GL_NONE);
 		glBindFramebuffer(GL_FRAMEBUFFER, 0);
 	}
 
-	void
-	Framebuffer::deleteDepthCubeMapBuffer()
-	{
-		glDeleteFramebuffers(1, &fbo);
-		glDeleteTextures(1, &texture);
-	}
-
 	void
 	Framebuffer::Bind()
 	{
@@ -163,36 +239,134 @@ namespace gfx
 	}
 
 	void
-	Framebuffer::Resize(int newWidth, int newHeight)
+	Framebuffer::Clear(const glm::vec4& color, float depth)
 	{
-		if (newWidth != width || newHeight != height)
+		for (size_t i = 0; i < color_textures.size(); ++i)
 		{
-			width = newWidth;
-			height = newHeight;
-
-			switch (mode)
+			if (isIntegerFormat(desc.color_formats[i]))
+			{
+				GLuint value[4] = {GLuint(color.r), GLuint(color.g), GLuint(color.b), GLuint(color.a)};
+				glClearBufferuiv(GL_COLOR, GLint(i), value);
+			}
+			else
 			{
-			case gfx::RenderBuffer:
-				deleteRenderBuffer();
-				createRenderBuffer();
+				glClearBufferfv(GL_COLOR, GLint(i), &color[0]);
+			}
+		}
+
+		if (desc.depth_format != NO_DEPTH && hasStencil(desc.depth_format))
+			glClearBufferfi(GL_DEPTH_STENCIL, 0, depth, 0);
+		else if (desc.depth_format != NO_DEPTH)
+			glClearBufferfv(GL_DEPTH, 0, &depth);
+	}
+
+	void
+	Framebuffer::Resolve(Framebuffer* target, uint32_t color_mask, bool depth)
+	{
+		GLuint target_fbo = target ? target->fbo : 0;
+		int target_width = target ? target->desc.width : desc.width;
+		int target_height = target ? target->desc.height : desc.height;
+
+		// one blit per color attachment, attachment i resolves into attachment i of the target
+		for (int i = 0; i < int(color_textures.size()); ++i)
+		{
+			if ((color_mask & (1u << i)) == 0)
+				continue;
+
+			if (target && i >= int(target->color_textures.size()))
 				break;
-			case gfx::DepthBuffer:
-				deleteDepthBuffer();
-				createDepthBuffer();
+
+			glNamedFramebufferReadBuffer(fbo, GL_COLOR_ATTACHMENT0 + i);
+			glNamedFramebufferDrawBuffer(target_fbo, target ? GL_COLOR_ATTACHMENT0 + i : GL_BACK);
+			glBlitNamedFramebuffer(
+				fbo,
+				target_fbo,
+				0,
+				0,
+				desc.width,
+				desc.height,
+				0,
+				0,
+				target_width,
+				target_height,
+				GL_COLOR_BUFFER_BIT,
+				GL_NEAREST);
+
+			// the default framebuffer only takes one resolved color
+			if (target == nullptr)
 				break;
-			case gfx::DepthCubeMap:
-				deleteDepthCubeMapBuffer();
+		}
+
+		// every sample of the depth is the same after a resolve, which one is picked is up to the driver
+		if (depth && desc.depth_format != NO_DEPTH)
+			glBlitNamedFramebuffer(
+				fbo,
+				target_fbo,
+				0,
+				0,
+				desc.width,
+				desc.height,
+				0,
+				0,
+				target_width,
+				target_height,
+				GL_DEPTH_BUFFER_BIT,
+				GL_NEAREST);
+
+		// put the draw buffers back the way they're after creation
+		glNamedFramebufferReadBuffer(fbo, color_textures.empty() ? GL_NONE : GL_COLOR_ATTACHMENT0);
+		if (target)
+			target->setDrawBuffers();
+		else
+			glNamedFramebufferDrawBuffer(0, GL_BACK);
+	}
+
+	void
+	Framebuffer::Resize(int newWidth, int newHeight)
+	{
+		if (newWidth != desc.width || newHeight != desc.height)
+		{
+			desc.width = newWidth;
+			desc.height = newHeight;
+
+			deleteAttachments();
+			if (mode == gfx::DepthCubeMap)
 				createDepthCubeMapBuffer();
-				break;
-			default:
-				break;
-			}
+			else
+				createAttachments();
 		}
 	}
 
 	unsigned int
 	Framebuffer::GetTexture() const
 	{
-		return texture;
+		return color_textures.empty() ? depth_texture : color_textures[0];
+	}
+
+	unsigned int
+	Framebuffer::GetColorTexture(int index) const
+	{
+		if (index < 0 || index >= int(color_textures.size()))
+			return 0;
+
+		return color_textures[index];
+	}
+
+	int
+	Framebuffer::GetColorCount() const
+	{
+		return int(color_textures.size());
+	}
+
+	unsigned int
+	Framebuffer::GetDepthTexture() const
+	{
+		return depth_texture;
+	}
+
+	const Framebuffer_Desc&
+	Framebuffer::GetDesc() const
+	{
+		return desc;
 	}
 } // namespace gfx
\ No newline at end of file
@@ -2,12 +2,43 @@
 
 #include "enums.h"
 
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
 namespace gfx
 {
+	static constexpr int MAX_COLOR_ATTACHMENTS = 8;
+
+	// color attachment i is written by the fragment output at location i
+	struct Framebuffer_Desc
+	{
+		int width = 0;
+		int height = 0;
+		std::vector<Texture_Format> color_formats;
+		Depth_Format depth_format = DEPTH24_STENCIL8;
+
+		// depth goes to a texture that can be sampled instead of a renderbuffer
+		bool sampleable_depth = false;
+
+		// above 1 every attachment is multisampled, sample the textures with sampler2DMS or resolve them first
+		int samples = 1;
+	};
+
 	class Framebuffer
 	{
 	public:
 		Framebuffer(int width, int height, FrameBuffer_Mode mode = RenderBuffer);
+
+		// up to MAX_COLOR_ATTACHMENTS colors in any uncompressed format, and a depth attachment
+		Framebuffer(const Framebuffer_Desc& desc);
+
+		Framebuffer(const Framebuffer&) = delete;
+
+		Framebuffer&
+		operator=(const Framebuffer&) = delete;
+
 		~Framebuffer();
 
 		void
@@ -16,36 +47,55 @@ namespace gfx
 		void
 		Unbind();
 
+		// clears every attachment of the bound framebuffer, integer colors get the color truncated to integers
+		void
+		Clear(const glm::vec4& color, float depth = 1.0f);
+
+		// blits the multisampled attachments into the single sampled target of the same size, or into the window
+		// when target is null. color_mask picks the color attachments so only what gets sampled later is resolved,
+		// the window only takes the first one and can't be multisampled itself. HDR colors are better resolved
+		// with resolveHDR from gfx/msaa.glsl which keeps bright samples from taking over the edges
+		void
+		Resolve(Framebuffer* target, uint32_t color_mask = 0xFF, bool depth = false);
+
 		void
 		Resize(int newWidth, int newHeight);
 
+		// first color texture, or the depth texture when there's no color
 		unsigned int
 		GetTexture() const;
 
+		unsigned int
+		GetColorTexture(int index) const;
+
+		int
+		GetColorCount() const;
+
+		// 0 when the depth is a renderbuffer
+		unsigned int
+		GetDepthTexture() const;
+
+		const Framebuffer_Desc&
+		GetDesc() const;
+
 	private:
 		unsigned int fbo;
-		unsigned int texture;
+		std::vector<unsigned int> color_textures;
+		unsigned int depth_texture;
 		unsigned int rbo; // Renderbuffer object for depth/stencil
-		int width;
-		int height;
+		Framebuffer_Desc desc;
 		FrameBuffer_Mode mode;
 
 		void
-		createRenderBuffer();
-
-		void
-		createDepthBuffer();
+		createAttachments();
 
 		void
-		deleteRenderBuffer();
+		setDrawBuffers();
 
 		void
-		deleteDepthBuffer();
+		deleteAttachments();
 
 		void
 		createDepthCubeMapBuffer();
-
-		void
-		deleteDepthCubeMapBuffer();
 	};
 } // namespace gfx
\ No newline at end of file
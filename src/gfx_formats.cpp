@@ -0,0 +1,413 @@
+#include "gfx_formats.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+
+namespace gfx
+{
+	uint32_t
+	wrappingMode(Wrapping_Mode wrap_mode)
+	{
+		GLenum res = 0;
+		switch (wrap_mode)
+		{
+		case REPEAT:
+			res = GL_REPEAT;
+			break;
+
+		case CLAMP_TO_EDGE:
+			res = GL_CLAMP_TO_EDGE;
+			break;
+
+		case CLAMP_TO_BORDER:
+			res = GL_CLAMP_TO_BORDER;
+			break;
+
+		case MIRRORED_REPEAT:
+			res = GL_MIRRORED_REPEAT;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	filteringMode(Filtering_Mode mode)
+	{
+		GLint res = 0;
+
+		switch (mode)
+		{
+		case NEAREST:
+			res = GL_NEAREST;
+			break;
+
+		case LINEAR:
+			res = GL_LINEAR;
+			break;
+
+		case NEAREST_MIPMAP_NEAREST:
+			res = GL_NEAREST_MIPMAP_NEAREST;
+			break;
+
+		case LINEAR_MIPMAP_NEAREST:
+			res = GL_LINEAR_MIPMAP_NEAREST;
+			break;
+
+		case NEAREST_MIPMAP_LINEAR:
+			res = GL_NEAREST_MIPMAP_LINEAR;
+			break;
+
+		case LINEAR_MIPMAP_LINEAR:
+			res = GL_LINEAR_MIPMAP_LINEAR;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	textureInternalFormat(Texture_Format format)
+	{
+		GLenum res = 0;
+
+		switch (format)
+		{
+		case R8:
+			res = GL_R8;
+			break;
+		case RG8:
+			res = GL_RG8;
+			break;
+		case RGB8:
+			res = GL_RGB8;
+			break;
+		case RGBA8:
+			res = GL_RGBA8;
+			break;
+		case SRGB8:
+			res = GL_SRGB8;
+			break;
+		case SRGB8_ALPHA8:
+			res = GL_SRGB8_ALPHA8;
+			break;
+		case R16:
+			res = GL_R16;
+			break;
+		case RG16:
+			res = GL_RG16;
+			break;
+		case RGB16:
+			res = GL_RGB16;
+			break;
+		case RGBA16:
+			res = GL_RGBA16;
+			break;
+		case R16F:
+			res = GL_R16F;
+			break;
+		case RG16F:
+			res = GL_RG16F;
+			break;
+		case RGB16F:
+			res = GL_RGB16F;
+			break;
+		case RGBA16F:
+			res = GL_RGBA16F;
+			break;
+		case R11G11B10F:
+			res = GL_R11F_G11F_B10F;
+			break;
+		case R32F:
+			res = GL_R32F;
+			break;
+		case RG32F:
+			res = GL_RG32F;
+			break;
+		case RGBA32F:
+			res = GL_RGBA32F;
+			break;
+		case BC4:
+			res = GL_COMPRESSED_RED_RGTC1;
+			break;
+		case BC5:
+			res = GL_COMPRESSED_RG_RGTC2;
+			break;
+		case BC7:
+			res = GL_COMPRESSED_RGBA_BPTC_UNORM;
+			break;
+		case BC7_SRGB:
+			res = GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+			break;
+		case R32UI:
+			res = GL_R32UI;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	pixelFormat(uint32_t ncomponents)
+	{
+		GLenum res = 0;
+
+		switch (ncomponents)
+		{
+		case 1:
+			res = GL_RED;
+			break;
+		case 2:
+			res = GL_RG;
+			break;
+		case 3:
+			res = GL_RGB;
+			break;
+		case 4:
+			res = GL_RGBA;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	pixelType(Pixel_Type type)
+	{
+		GLenum res = 0;
+
+		switch (type)
+		{
+		case PIXEL_UNSIGNED_BYTE:
+			res = GL_UNSIGNED_BYTE;
+			break;
+		case PIXEL_UNSIGNED_SHORT:
+			res = GL_UNSIGNED_SHORT;
+			break;
+		case PIXEL_FLOAT:
+			res = GL_FLOAT;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	pixelTypeSize(Pixel_Type type)
+	{
+		uint32_t res = 0;
+
+		switch (type)
+		{
+		case PIXEL_UNSIGNED_BYTE:
+			res = 1;
+			break;
+		case PIXEL_UNSIGNED_SHORT:
+			res = 2;
+			break;
+		case PIXEL_FLOAT:
+			res = 4;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	textureFormatComponents(Texture_Format format)
+	{
+		uint32_t res = 0;
+
+		switch (format)
+		{
+		case R8:
+		case R16:
+		case R16F:
+		case R32F:
+		case R32UI:
+		case BC4:
+			res = 1;
+			break;
+		case RG8:
+		case RG16:
+		case RG16F:
+		case RG32F:
+		case BC5:
+			res = 2;
+			break;
+		case RGB8:
+		case SRGB8:
+		case RGB16:
+		case RGB16F:
+		case R11G11B10F:
+			res = 3;
+			break;
+		case RGBA8:
+		case SRGB8_ALPHA8:
+		case RGBA16:
+		case RGBA16F:
+		case RGBA32F:
+		case BC7:
+		case BC7_SRGB:
+			res = 4;
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	textureTransferType(Texture_Format format)
+	{
+		GLenum res = GL_UNSIGNED_BYTE;
+
+		switch (format)
+		{
+		case R16:
+		case RG16:
+		case RGB16:
+		case RGBA16:
+			res = GL_UNSIGNED_SHORT;
+			break;
+		case R16F:
+		case RG16F:
+		case RGB16F:
+		case RGBA16F:
+			res = GL_HALF_FLOAT;
+			break;
+		case R11G11B10F:
+		case R32F:
+		case RG32F:
+		case RGBA32F:
+			res = GL_FLOAT;
+			break;
+		case R32UI:
+			res = GL_UNSIGNED_INT;
+			break;
+		default:
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	textureFormatPixelSize(Texture_Format format)
+	{
+		uint32_t component_size = 1;
+
+		switch (textureTransferType(format))
+		{
+		case GL_UNSIGNED_SHORT:
+		case GL_HALF_FLOAT:
+			component_size = 2;
+			break;
+		case GL_FLOAT:
+		case GL_UNSIGNED_INT:
+			component_size = 4;
+			break;
+		}
+
+		return component_size * textureFormatComponents(format);
+	}
+
+	Texture_Format
+	deduceTextureFormat(uint32_t ncomponents, Pixel_Type type)
+	{
+		// clang-format off
+		static const Texture_Format formats[3][4] = {
+			{R8,   RG8,   RGB8,       RGBA8},
+			{R16,  RG16,  RGB16,      RGBA16},
+			{R16F, RG16F, R11G11B10F, RGBA16F},
+		};
+		// clang-format on
+
+		ncomponents = std::clamp(ncomponents, 1u, 4u);
+		return formats[type][ncomponents - 1];
+	}
+
+	bool
+	isCompressedFormat(Texture_Format format)
+	{
+		return format == BC4 || format == BC5 || format == BC7 || format == BC7_SRGB;
+	}
+
+	bool
+	isIntegerFormat(Texture_Format format)
+	{
+		return format == R32UI;
+	}
+
+	uint32_t
+	depthInternalFormat(Depth_Format format)
+	{
+		GLenum res = 0;
+
+		switch (format)
+		{
+		case DEPTH16:
+			res = GL_DEPTH_COMPONENT16;
+			break;
+		case DEPTH24:
+			res = GL_DEPTH_COMPONENT24;
+			break;
+		case DEPTH32F:
+			res = GL_DEPTH_COMPONENT32F;
+			break;
+		case DEPTH24_STENCIL8:
+			res = GL_DEPTH24_STENCIL8;
+			break;
+		case DEPTH32F_STENCIL8:
+			res = GL_DEPTH32F_STENCIL8;
+			break;
+		default:
+			break;
+		}
+
+		return res;
+	}
+
+	bool
+	hasStencil(Depth_Format format)
+	{
+		return format == DEPTH24_STENCIL8 || format == DEPTH32F_STENCIL8;
+	}
+
+	uint32_t
+	depthFormatPixelSize(Depth_Format format)
+	{
+		uint32_t res = 0;
+
+		switch (format)
+		{
+		case DEPTH16:
+			res = 2;
+			break;
+		case DEPTH24:
+		case DEPTH32F:
+		case DEPTH24_STENCIL8:
+			res = 4;
+			break;
+		case DEPTH32F_STENCIL8:
+			res = 8;
+			break;
+		default:
+			break;
+		}
+
+		return res;
+	}
+
+	uint32_t
+	mipLevelsCount(uint32_t width, uint32_t height, uint32_t depth)
+	{
+		uint32_t size = std::max({width, height, depth, 1u});
+
+		uint32_t levels = 1;
+		while (size >>= 1)
+			++levels;
+
+		return levels;
+	}
+} // namespace gfx
@@ -0,0 +1,69 @@
+#pragma once
+
+#include "enums.h"
+
+#include <cstdint>
+
+namespace gfx
+{
+	uint32_t
+	wrappingMode(Wrapping_Mode wrap_mode);
+
+	uint32_t
+	filteringMode(Filtering_Mode mode);
+
+	// sized opengl internal format of the texture format
+	uint32_t
+	textureInternalFormat(Texture_Format format);
+
+	// opengl pixel transfer format from the component count
+	uint32_t
+	pixelFormat(uint32_t ncomponents);
+
+	// opengl pixel transfer type
+	uint32_t
+	pixelType(Pixel_Type type);
+
+	// size in bytes of a single component
+	uint32_t
+	pixelTypeSize(Pixel_Type type);
+
+	// component count of an uncompressed texture format
+	uint32_t
+	textureFormatComponents(Texture_Format format);
+
+	// opengl pixel transfer type matching the texture format storage, halfs are uploaded as GL_HALF_FLOAT
+	uint32_t
+	textureTransferType(Texture_Format format);
+
+	// size in bytes of one pixel as it's uploaded with textureTransferType
+	uint32_t
+	textureFormatPixelSize(Texture_Format format);
+
+	// default texture format for images with the given components and pixel type
+	Texture_Format
+	deduceTextureFormat(uint32_t ncomponents, Pixel_Type type);
+
+	// block compressed formats are filled by the driver compressor or by glCompressedTexSubImage
+	bool
+	isCompressedFormat(Texture_Format format);
+
+	// integer formats are read with usampler/isampler and can't be filtered
+	bool
+	isIntegerFormat(Texture_Format format);
+
+	// sized opengl internal format of the depth format, 0 for NO_DEPTH
+	uint32_t
+	depthInternalFormat(Depth_Format format);
+
+	bool
+	hasStencil(Depth_Format format);
+
+	// size in bytes of one depth pixel, the stencil included
+	uint32_t
+	depthFormatPixelSize(Depth_Format format);
+
+	// number of levels in a full mip chain
+	uint32_t
+	mipLevelsCount(uint32_t width, uint32_t height, uint32_t depth = 1);
+} // namespace gfx
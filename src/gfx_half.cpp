@@ -0,0 +1,98 @@
+#include "gfx_half.h"
+#include "gfx_cpu.h"
+
+#include <cstring>
+
+namespace gfx
+{
+	inline static uint32_t
+	_float_bits(float value)
+	{
+		uint32_t bits;
+		memcpy(&bits, &value, sizeof(bits));
+		return bits;
+	}
+
+	inline static float
+	_bits_float(uint32_t bits)
+	{
+		float value;
+		memcpy(&value, &bits, sizeof(value));
+		return value;
+	}
+
+	uint16_t
+	floatToHalf(float value)
+	{
+		constexpr uint32_t F32_INFINITY = 255u << 23;
+		constexpr uint32_t F16_MAX = (127u + 16u) << 23;
+		constexpr uint32_t DENORM_MAGIC = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+
+		uint32_t bits = _float_bits(value);
+		uint32_t sign = bits & 0x80000000u;
+		bits ^= sign;
+
+		uint16_t res = 0;
+		if (bits >= F16_MAX)
+		{
+			// too large for a half, nan stays a quiet nan
+			res = bits > F32_INFINITY ? 0x7e00 : 0x7c00;
+		}
+		else if (bits < (113u << 23))
+		{
+			// the float adder does the denormal rounding for us
+			res = uint16_t(_float_bits(_bits_float(bits) + _bits_float(DENORM_MAGIC)) - DENORM_MAGIC);
+		}
+		else
+		{
+			uint32_t mantissa_odd = (bits >> 13) & 1;
+			bits += (uint32_t(15 - 127) << 23) + 0xfff;
+			bits += mantissa_odd;
+			res = uint16_t(bits >> 13);
+		}
+
+		return res | uint16_t(sign >> 16);
+	}
+
+	float
+	halfToFloat(uint16_t value)
+	{
+		constexpr uint32_t SHIFTED_EXPONENT = 0x7c00u << 13;
+
+		uint32_t bits = (value & 0x7fffu) << 13;
+		uint32_t exponent = bits & SHIFTED_EXPONENT;
+		bits += (127u - 15u) << 23;
+
+		if (exponent == SHIFTED_EXPONENT)
+		{
+			// inf and nan
+			bits += (128u - 16u) << 23;
+		}
+		else if (exponent == 0)
+		{
+			// zero and denormals get renormalized
+			bits += 1u << 23;
+			bits = _float_bits(_bits_float(bits) - _bits_float(113u << 23));
+		}
+
+		return _bits_float(bits | (uint32_t(value & 0x8000u) << 16));
+	}
+
+	void
+	floatToHalf(const float* in, uint16_t* out, size_t count)
+	{
+		size_t done = cpuHasF16C() ? floatToHalfF16C(in, out, count) : 0;
+
+		for (size_t i = done; i < count; ++i)
+			out[i] = floatToHalf(in[i]);
+	}
+
+	void
+	halfToFloat(const uint16_t* in, float* out, size_t count)
+	{
+		size_t done = cpuHasF16C() ? halfToFloatF16C(in, out, count) : 0;
+
+		for (size_t i = done; i < count; ++i)
+			out[i] = halfToFloat(in[i]);
+	}
+} // namespace gfx
\ No newline at end of file
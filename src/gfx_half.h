@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace gfx
+{
+	// ieee 754 binary16 conversion with round to nearest even, the same rounding the F16C instructions use
+	uint16_t
+	floatToHalf(float value);
+
+	float
+	halfToFloat(uint16_t value);
+
+	// batch versions use F16C when the cpu supports it
+	void
+	floatToHalf(const float* in, uint16_t* out, size_t count);
+
+	void
+	halfToFloat(const uint16_t* in, float* out, size_t count);
+
+	// implemented in gfx_half_f16c.cpp, return the number of values converted which is 0 when built without F16C
+	size_t
+	floatToHalfF16C(const float* in, uint16_t* out, size_t count);
+
+	size_t
+	halfToFloatF16C(const uint16_t* in, float* out, size_t count);
+} // namespace gfx
\ No newline at end of file
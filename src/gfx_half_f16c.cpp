@@ -0,0 +1,54 @@
+#include "gfx_half.h"
+
+// this file is built with F16C enabled, it's only called once the cpu reported support for it
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX__))
+
+#include <immintrin.h>
+
+namespace gfx
+{
+	size_t
+	floatToHalfF16C(const float* in, uint16_t* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			auto half = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+			_mm_storeu_si128((__m128i*)(out + i), half);
+		}
+
+		return i;
+	}
+
+	size_t
+	halfToFloatF16C(const uint16_t* in, float* out, size_t count)
+	{
+		size_t i = 0;
+		for (; i + 8 <= count; i += 8)
+		{
+			auto half = _mm_loadu_si128((const __m128i*)(in + i));
+			_mm256_storeu_ps(out + i, _mm256_cvtph_ps(half));
+		}
+
+		return i;
+	}
+} // namespace gfx
+
+#else
+
+namespace gfx
+{
+	size_t
+	floatToHalfF16C(const float*, uint16_t*, size_t)
+	{
+		return 0;
+	}
+
+	size_t
+	halfToFloatF16C(const uint16_t*, float*, size_t)
+	{
+		return 0;
+	}
+} // namespace gfx
+
+#endif
\ No newline at end of file
@@ -0,0 +1,46 @@
+#include "gfx_hash.h"
+
+namespace gfx
+{
+	uint64_t
+	hash64(const void* data, size_t size, uint64_t seed)
+	{
+		auto bytes = (const unsigned char*)data;
+
+		uint64_t res = seed;
+		for (size_t i = 0; i < size; ++i)
+		{
+			res ^= bytes[i];
+			res *= 1099511628211ull;
+		}
+
+		return res;
+	}
+
+	uint64_t
+	hash64(const std::string& str, uint64_t seed)
+	{
+		return hash64(str.data(), str.size(), seed);
+	}
+
+	uint64_t
+	hashCombine(uint64_t seed, uint64_t value)
+	{
+		return hash64(&value, sizeof(value), seed);
+	}
+
+	std::string
+	hashToString(uint64_t hash)
+	{
+		const char* digits = "0123456789abcdef";
+
+		std::string res(16, '0');
+		for (int i = 15; i >= 0; --i)
+		{
+			res[i] = digits[hash & 0xF];
+			hash >>= 4;
+		}
+
+		return res;
+	}
+} // namespace gfx
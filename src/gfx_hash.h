@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace gfx
+{
+	// 64-bit FNV-1a, stable across runs and platforms so it can key on-disk caches
+	uint64_t
+	hash64(const void* data, size_t size, uint64_t seed = 14695981039346656037ull);
+
+	uint64_t
+	hash64(const std::string& str, uint64_t seed = 14695981039346656037ull);
+
+	// mixes a value into an existing hash
+	uint64_t
+	hashCombine(uint64_t seed, uint64_t value);
+
+	// fixed width lowercase hex, used for cache file names
+	std::string
+	hashToString(uint64_t hash);
+} // namespace gfx
@@ -0,0 +1,195 @@
+#include "gfx_lz.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace gfx
+{
+	constexpr size_t LZ_MIN_MATCH = 4;
+	constexpr size_t LZ_WINDOW = 65535;
+	constexpr uint32_t LZ_HASH_BITS = 14;
+
+	// the stream always ends with literals, and no match starts in the last bytes
+	constexpr size_t LZ_LAST_LITERALS = 5;
+	constexpr size_t LZ_MATCH_LIMIT = 12;
+
+	// lengths that don't fit a token nibble continue in bytes of 255
+	constexpr size_t LZ_NIBBLE_MAX = 15;
+
+	inline static uint32_t
+	_read32(const uint8_t* ptr)
+	{
+		uint32_t value;
+		memcpy(&value, ptr, sizeof(value));
+		return value;
+	}
+
+	inline static uint32_t
+	_hash(uint32_t value)
+	{
+		return (value * 2654435761u) >> (32 - LZ_HASH_BITS);
+	}
+
+	inline static void
+	_write_length(std::vector<uint8_t>& out, size_t length)
+	{
+		for (; length >= 255; length -= 255)
+			out.push_back(255);
+		out.push_back(uint8_t(length));
+	}
+
+	inline static bool
+	_read_length(const uint8_t*& ptr, const uint8_t* end, size_t& length)
+	{
+		uint8_t byte;
+		do
+		{
+			if (ptr == end)
+				return false;
+			byte = *ptr++;
+			length += byte;
+		} while (byte == 255);
+
+		return true;
+	}
+
+	inline static void
+	_write_sequence(
+		std::vector<uint8_t>& out,
+		const uint8_t* literals,
+		size_t literals_count,
+		size_t offset,
+		size_t match)
+	{
+		auto literal_nibble = std::min(literals_count, LZ_NIBBLE_MAX);
+		auto match_nibble = match ? std::min(match - LZ_MIN_MATCH, LZ_NIBBLE_MAX) : 0;
+		out.push_back(uint8_t((literal_nibble << 4) | match_nibble));
+
+		if (literal_nibble == LZ_NIBBLE_MAX)
+			_write_length(out, literals_count - LZ_NIBBLE_MAX);
+		out.insert(out.end(), literals, literals + literals_count);
+
+		// the last sequence has no match
+		if (match == 0)
+			return;
+
+		out.push_back(uint8_t(offset));
+		out.push_back(uint8_t(offset >> 8));
+
+		if (match_nibble == LZ_NIBBLE_MAX)
+			_write_length(out, match - LZ_MIN_MATCH - LZ_NIBBLE_MAX);
+	}
+
+	void
+	lzCompress(const uint8_t* in, size_t size, std::vector<uint8_t>& out)
+	{
+		out.clear();
+		out.reserve(size + size / 255 + 16);
+
+		size_t anchor = 0;
+
+		if (size > LZ_MATCH_LIMIT)
+		{
+			std::vector<uint32_t> table(size_t(1) << LZ_HASH_BITS, 0);
+			size_t limit = size - LZ_MATCH_LIMIT;
+
+			for (size_t i = 0; i < limit;)
+			{
+				auto value = _read32(in + i);
+				auto& entry = table[_hash(value)];
+				size_t candidate = entry;
+				entry = uint32_t(i);
+
+				if (candidate >= i || i - candidate > LZ_WINDOW || _read32(in + candidate) != value)
+				{
+					// data that doesn't compress is skipped over faster and faster
+					i += 1 + ((i - anchor) >> 6);
+					continue;
+				}
+
+				size_t match = LZ_MIN_MATCH;
+				size_t max_match = size - LZ_LAST_LITERALS - i;
+				while (match < max_match && in[candidate + match] == in[i + match])
+					++match;
+
+				while (i > anchor && candidate > 0 && in[i - 1] == in[candidate - 1])
+				{
+					--i;
+					--candidate;
+					++match;
+				}
+
+				_write_sequence(out, in + anchor, i - anchor, i - candidate, match);
+
+				i += match;
+				anchor = i;
+
+				// the position right before the next search is usually where the next repeat starts
+				if (i < limit)
+					table[_hash(_read32(in + i - 2))] = uint32_t(i - 2);
+			}
+		}
+
+		_write_sequence(out, in + anchor, size - anchor, 0, 0);
+	}
+
+	bool
+	lzDecompress(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size)
+	{
+		auto ip = in;
+		auto in_end = in + in_size;
+		auto op = out;
+		auto out_end = out + out_size;
+
+		while (ip < in_end)
+		{
+			auto token = *ip++;
+
+			size_t literals = token >> 4;
+			if (literals == LZ_NIBBLE_MAX && !_read_length(ip, in_end, literals))
+				return false;
+
+			if (literals > size_t(in_end - ip) || literals > size_t(out_end - op))
+				return false;
+
+			memcpy(op, ip, literals);
+			ip += literals;
+			op += literals;
+
+			if (ip == in_end)
+				break;
+
+			if (in_end - ip < 2)
+				return false;
+
+			size_t offset = size_t(ip[0]) | (size_t(ip[1]) << 8);
+			ip += 2;
+
+			if (offset == 0 || offset > size_t(op - out))
+				return false;
+
+			size_t match = token & 0xF;
+			if (match == LZ_NIBBLE_MAX && !_read_length(ip, in_end, match))
+				return false;
+			match += LZ_MIN_MATCH;
+
+			if (match > size_t(out_end - op))
+				return false;
+
+			// short offsets repeat the bytes just written so they're copied one at a time
+			auto source = op - offset;
+			if (offset >= match)
+			{
+				memcpy(op, source, match);
+				op += match;
+			}
+			else
+			{
+				for (size_t i = 0; i < match; ++i)
+					*op++ = *source++;
+			}
+		}
+
+		return op == out_end;
+	}
+} // namespace gfx
\ No newline at end of file
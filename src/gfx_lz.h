@@ -0,0 +1,19 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gfx
+{
+	// byte oriented lz77 in the spirit of lz4, no entropy coder so decoding runs at memory speed
+	// a stream is a list of sequences, each one a run of literals followed by a copy from up to 64KB back
+
+	// replaces out with the compressed bytes
+	void
+	lzCompress(const uint8_t* in, size_t size, std::vector<uint8_t>& out);
+
+	// out_size is the exact decompressed size, fails on corrupt input instead of reading or writing past the ends
+	bool
+	lzDecompress(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size);
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,224 @@
+#include "gfx_mapped_file.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <utility>
+
+namespace gfx
+{
+#ifdef _WIN32
+	MappedFile::MappedFile() : data(nullptr), size(0), file(INVALID_HANDLE_VALUE), mapping(nullptr) {}
+
+	MappedFile::MappedFile(const char* file_name) : MappedFile()
+	{
+		file = CreateFileA(
+			file_name,
+			GENERIC_READ,
+			FILE_SHARE_READ,
+			nullptr,
+			OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN,
+			nullptr);
+		if (file == INVALID_HANDLE_VALUE)
+			return;
+
+		LARGE_INTEGER file_size;
+		if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0)
+		{
+			close();
+			return;
+		}
+
+		mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping == nullptr)
+		{
+			close();
+			return;
+		}
+
+		data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		if (data == nullptr)
+		{
+			close();
+			return;
+		}
+
+		size = (size_t)file_size.QuadPart;
+	}
+
+	void
+	MappedFile::prefetch(size_t offset, size_t size) const
+	{
+		if (data == nullptr || offset >= this->size)
+			return;
+
+#if _WIN32_WINNT >= 0x0602
+		WIN32_MEMORY_RANGE_ENTRY range;
+		range.VirtualAddress = (void*)(data + offset);
+		range.NumberOfBytes = std::min(size, this->size - offset);
+		PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+#endif
+	}
+
+	void
+	MappedFile::close()
+	{
+		if (data)
+			UnmapViewOfFile(data);
+
+		if (mapping)
+			CloseHandle(mapping);
+
+		if (file != INVALID_HANDLE_VALUE)
+			CloseHandle(file);
+
+		data = nullptr;
+		size = 0;
+		mapping = nullptr;
+		file = INVALID_HANDLE_VALUE;
+	}
+#else
+	MappedFile::MappedFile() : data(nullptr), size(0), file(-1) {}
+
+	MappedFile::MappedFile(const char* file_name) : MappedFile()
+	{
+		file = open(file_name, O_RDONLY);
+		if (file == -1)
+			return;
+
+		struct stat info;
+		if (fstat(file, &info) != 0 || info.st_size == 0)
+		{
+			close();
+			return;
+		}
+
+		auto ptr = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (ptr == MAP_FAILED)
+		{
+			close();
+			return;
+		}
+
+		data = (const unsigned char*)ptr;
+		size = (size_t)info.st_size;
+	}
+
+	void
+	MappedFile::prefetch(size_t offset, size_t size) const
+	{
+		if (data == nullptr || offset >= this->size)
+			return;
+
+		// madvise wants a page aligned start
+		auto page = (size_t)sysconf(_SC_PAGESIZE);
+		auto start = offset & ~(page - 1);
+		auto end = std::min(offset + size, this->size);
+		madvise((void*)(data + start), end - start, MADV_WILLNEED);
+	}
+
+	void
+	MappedFile::close()
+	{
+		if (data)
+			munmap((void*)data, size);
+
+		if (file != -1)
+			::close(file);
+
+		data = nullptr;
+		size = 0;
+		file = -1;
+	}
+#endif
+
+	MappedFile::MappedFile(MappedFile&& other) noexcept : MappedFile()
+	{
+		*this = std::move(other);
+	}
+
+	MappedFile&
+	MappedFile::operator=(MappedFile&& other) noexcept
+	{
+		if (this != &other)
+		{
+			close();
+
+			std::swap(data, other.data);
+			std::swap(size, other.size);
+			std::swap(file, other.file);
+#ifdef _WIN32
+			std::swap(mapping, other.mapping);
+#endif
+		}
+
+		return *this;
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	bool
+	MappedFile::isOpen() const
+	{
+		return data != nullptr;
+	}
+
+	const unsigned char*
+	MappedFile::getData() const
+	{
+		return data;
+	}
+
+	size_t
+	MappedFile::getSize() const
+	{
+		return size;
+	}
+
+	bool
+	writeFileAtomically(const std::string& path, const std::vector<File_Chunk>& chunks, uint64_t file_size)
+	{
+		auto temp_path = path + ".tmp";
+		{
+			std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+			if (!file)
+				return false;
+
+			uint64_t end = 0;
+			for (auto& chunk : chunks)
+			{
+				file.seekp((std::streamoff)chunk.offset);
+				file.write((const char*)chunk.data, chunk.size);
+				end = std::max(end, chunk.offset + chunk.size);
+			}
+
+			if (file_size > end)
+			{
+				file.seekp((std::streamoff)file_size - 1);
+				file.put(0);
+			}
+
+			if (!file)
+				return false;
+		}
+
+		std::error_code error;
+		std::filesystem::rename(temp_path, path, error);
+		return !error;
+	}
+} // namespace gfx
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	// read-only memory mapping of a whole file
+	class MappedFile
+	{
+	public:
+		MappedFile();
+
+		MappedFile(const char* file_name);
+
+		MappedFile(const MappedFile&) = delete;
+
+		MappedFile&
+		operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept;
+
+		MappedFile&
+		operator=(MappedFile&& other) noexcept;
+
+		~MappedFile();
+
+		bool
+		isOpen() const;
+
+		const unsigned char*
+		getData() const;
+
+		size_t
+		getSize() const;
+
+		// hints the os to read the range ahead of use
+		void
+		prefetch(size_t offset, size_t size) const;
+
+		void
+		close();
+
+	private:
+		const unsigned char* data;
+		size_t size;
+
+#ifdef _WIN32
+		void* file;
+		void* mapping;
+#else
+		int file;
+#endif
+	};
+
+	// size bytes of data at offset in a file written by writeFileAtomically
+	struct File_Chunk
+	{
+		uint64_t offset;
+		const void* data;
+		size_t size;
+	};
+
+	// writes the chunks to a temporary file then renames it over path, so readers never see a half written file.
+	// gaps between chunks read as zeros and file_size pads the file past the last chunk
+	bool
+	writeFileAtomically(const std::string& path, const std::vector<File_Chunk>& chunks, uint64_t file_size = 0);
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,249 @@
+#include "gfx_material_table.h"
+#include "gfx.h"
+#include "gfx_atlas.h"
+#include "gfx_program.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace gfx
+{
+	MaterialTable::MaterialTable(uint32_t binding, uint32_t texture_unit, bool allow_bindless)
+		: binding(binding),
+		  texture_unit(texture_unit),
+		  allow_bindless(allow_bindless),
+		  bindless(false),
+		  texture_array(0),
+		  table_buffer(0)
+	{
+	}
+
+	MaterialTable::~MaterialTable()
+	{
+		release();
+	}
+
+	int
+	MaterialTable::add(Image* img)
+	{
+		if (!img->getData())
+		{
+			std::cout << "Empty image check image file" << std::endl;
+			return -1;
+		}
+
+		images.push_back(img);
+		return (int)images.size() - 1;
+	}
+
+	bool
+	MaterialTable::build(GFX* gfx)
+	{
+		release();
+
+		std::vector<Material> materials(images.size());
+
+		bindless = allow_bindless && GLEW_ARB_bindless_texture;
+
+		bool res = bindless ? buildBindless(gfx, materials) : buildTextureArray(gfx, materials);
+		if (res == false)
+			return false;
+
+		table_buffer = gfx->createShaderStorageBuffer(
+			materials.data(),
+			uint32_t(sizeof(Material) * materials.size()),
+			BUFFER_USAGE::STATIC);
+
+		return true;
+	}
+
+	void
+	MaterialTable::bind(GFX* gfx)
+	{
+		gfx->bindShaderStorageBuffer(table_buffer, binding);
+
+		if (bindless == false)
+		{
+			glActiveTexture(GL_TEXTURE0 + texture_unit);
+			gfx->bindTexture2DArray(texture_array);
+			glActiveTexture(GL_TEXTURE0);
+		}
+	}
+
+	bool
+	MaterialTable::isBindless() const
+	{
+		return bindless;
+	}
+
+	uint32_t
+	MaterialTable::getMaterialCount() const
+	{
+		return (uint32_t)images.size();
+	}
+
+	std::string
+	MaterialTable::injectShaderHeader(const char* shader) const
+	{
+		std::string header;
+
+		if (bindless)
+			header += "#extension GL_ARB_bindless_texture : require\n";
+
+		header += "struct gfx_Material\n"
+				  "{\n"
+				  "	uvec2 handle;\n"
+				  "	float layer;\n"
+				  "	float max_lod;\n"
+				  "	vec4 uv_transform;\n"
+				  "};\n"
+				  "layout(std430, binding = " +
+				  std::to_string(binding) +
+				  ") readonly buffer gfx_MaterialTable\n"
+				  "{\n"
+				  "	gfx_Material gfx_materials[];\n"
+				  "};\n";
+
+		// bindless handles must be dynamically uniform, pass the id from a per draw instance attribute
+		if (bindless)
+		{
+			header += "vec4 gfx_sampleMaterial(uint id, vec2 uv)\n"
+					  "{\n"
+					  "	return texture(sampler2D(gfx_materials[id].handle), uv);\n"
+					  "}\n";
+		}
+		else
+		{
+			// atlas regions can't use the sampler wrapping so the uvs are wrapped inside the region. the gradients
+			// come from the unwrapped uvs so the wrap doesn't pick the smallest mip along the seams, and they're
+			// shortened so the mip level never reaches past the padding into the neighbouring materials
+			header += "layout(binding = " + std::to_string(texture_unit) +
+					  ") uniform sampler2DArray gfx_material_array;\n"
+					  "vec4 gfx_sampleMaterial(uint id, vec2 uv)\n"
+					  "{\n"
+					  "	gfx_Material material = gfx_materials[id];\n"
+					  "	vec2 atlas_uv = fract(uv) * material.uv_transform.xy + material.uv_transform.zw;\n"
+					  "	vec2 dx = dFdx(uv * material.uv_transform.xy);\n"
+					  "	vec2 dy = dFdy(uv * material.uv_transform.xy);\n"
+					  "	vec2 size = vec2(textureSize(gfx_material_array, 0).xy);\n"
+					  "	float footprint = max(length(dx * size), length(dy * size));\n"
+					  "	float limit = exp2(material.max_lod);\n"
+					  "	if (footprint > limit)\n"
+					  "	{\n"
+					  "		dx *= limit / footprint;\n"
+					  "		dy *= limit / footprint;\n"
+					  "	}\n"
+					  "	return textureGrad(gfx_material_array, vec3(atlas_uv, material.layer), dx, dy);\n"
+					  "}\n";
+		}
+
+		return injectHeader(shader, header);
+	}
+
+	bool
+	MaterialTable::buildBindless(GFX* gfx, std::vector<Material>& materials)
+	{
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			auto texture = gfx->createTexture2D(
+				images[i],
+				Wrapping_Mode::REPEAT,
+				Filtering_Mode::LINEAR_MIPMAP_LINEAR,
+				Filtering_Mode::LINEAR,
+				true);
+
+			if (texture == -1)
+				return false;
+
+			// the texture is immutable from here on, the handle stays valid until it's deleted
+			auto handle = glGetTextureHandleARB(texture);
+			glMakeTextureHandleResidentARB(handle);
+
+			textures.push_back(texture);
+			handles.push_back(handle);
+
+			materials[i].handle[0] = uint32_t(handle & 0xFFFFFFFF);
+			materials[i].handle[1] = uint32_t(handle >> 32);
+			materials[i].layer = 0.0f;
+			materials[i].max_lod = 0.0f;
+			materials[i].uv_transform = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+		}
+
+		return true;
+	}
+
+	bool
+	MaterialTable::buildTextureArray(GFX* gfx, std::vector<Material>& materials)
+	{
+		const int padding = 4;
+
+		// pages as big as the largest material so every material fits, smaller ones share pages
+		int page_width = 1, page_height = 1, ncomponents = 3;
+		for (auto img : images)
+		{
+			page_width = std::max(page_width, (int)img->getWidth() + 2 * padding);
+			page_height = std::max(page_height, (int)img->getHeight() + 2 * padding);
+			ncomponents = std::max(ncomponents, (int)img->get_NCompnents());
+		}
+
+		TextureAtlas atlas(page_width, page_height, ncomponents, padding);
+		for (auto img : images)
+		{
+			if (atlas.add(img) == -1)
+				return false;
+		}
+
+		if (atlas.build() == false)
+			return false;
+
+		texture_array = gfx->createTexture2DArray(
+			atlas.getPages(),
+			Wrapping_Mode::CLAMP_TO_EDGE,
+			Filtering_Mode::LINEAR_MIPMAP_LINEAR,
+			Filtering_Mode::LINEAR,
+			true);
+
+		if (texture_array == -1)
+		{
+			texture_array = 0;
+			return false;
+		}
+
+		// a texel of mip level n spans 2^n texels of the page, bilinear filtering reaches one of them past the
+		// region edge so the padding has to cover two
+		auto max_lod = std::max(std::log2(float(padding)) - 1.0f, 0.0f);
+
+		for (size_t i = 0; i < images.size(); ++i)
+		{
+			auto& region = atlas.getRegion((int)i);
+			materials[i].handle[0] = 0;
+			materials[i].handle[1] = 0;
+			materials[i].layer = region.layer;
+			materials[i].max_lod = max_lod;
+			materials[i].uv_transform = region.uv_transform;
+		}
+
+		return true;
+	}
+
+	void
+	MaterialTable::release()
+	{
+		for (auto handle : handles)
+			glMakeTextureHandleNonResidentARB(handle);
+		handles.clear();
+
+		if (textures.empty() == false)
+			glDeleteTextures((GLsizei)textures.size(), textures.data());
+		textures.clear();
+
+		if (texture_array)
+			glDeleteTextures(1, &texture_array);
+		texture_array = 0;
+
+		if (table_buffer)
+			glDeleteBuffers(1, &table_buffer);
+		table_buffer = 0;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,74 @@
+#pragma once
+
+#include "Image.h"
+
+#include <glm/glm.hpp>
+
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	class GFX;
+
+	// table of material textures that shaders index by material id, backed by bindless handles when
+	// ARB_bindless_texture is available and by a texture array otherwise
+	class MaterialTable
+	{
+	public:
+		// binding is the shader storage binding of the table, texture_unit is used by the texture array fallback
+		MaterialTable(uint32_t binding = 0, uint32_t texture_unit = 0, bool allow_bindless = true);
+
+		~MaterialTable();
+
+		// queue a material texture, returns its material id
+		int
+		add(Image* img);
+
+		// creates the textures and uploads the table, building again replaces what the last build made
+		bool
+		build(GFX* gfx);
+
+		// makes every material visible to shaders at once
+		void
+		bind(GFX* gfx);
+
+		bool
+		isBindless() const;
+
+		uint32_t
+		getMaterialCount() const;
+
+		// inserts the table declarations and gfx_sampleMaterial(uint id, vec2 uv) after the #version and
+		// #extension lines
+		std::string
+		injectShaderHeader(const char* shader) const;
+
+	private:
+		// std430 layout of a table entry
+		struct Material
+		{
+			uint32_t handle[2];
+			float layer;
+			// the texture array fallback keeps the mip level below what the atlas padding covers
+			float max_lod;
+			glm::vec4 uv_transform;
+		};
+
+		uint32_t binding, texture_unit;
+		bool allow_bindless, bindless;
+		std::vector<Image*> images;
+		std::vector<uint32_t> textures;
+		std::vector<uint64_t> handles;
+		uint32_t texture_array, table_buffer;
+
+		bool
+		buildBindless(GFX* gfx, std::vector<Material>& materials);
+
+		bool
+		buildTextureArray(GFX* gfx, std::vector<Material>& materials);
+
+		void
+		release();
+	};
+} // namespace gfx
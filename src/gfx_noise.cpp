@@ -0,0 +1,269 @@
+#include "gfx_noise.h"
+#include "gfx_cpu.h"
+#include "gfx_noise_kernels.h"
+#include "gfx_parallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+namespace gfx
+{
+	namespace noise
+	{
+		// octaves get different seeds so they don't line up on the shared lattice points
+		constexpr uint32_t OCTAVE_SEED_STEP = 0x9e3779b9u;
+
+		// width of the gaussian that spreads the points of the blue noise, 1.5 is the value of the original paper
+		constexpr float BLUE_NOISE_SIGMA = 1.5f;
+
+		// sums the octaves of one row into out and normalizes by the total amplitude
+		inline static void
+		_fbm_row(Row_Kernel kernel, float* out, int width, int y, int z, int height, int depth, const Noise_Settings& s)
+		{
+			std::fill(out, out + width, 0.0f);
+
+			float amplitude = 1.0f;
+			float total = 0.0f;
+			int frequency = std::max(s.frequency, 1);
+			for (int octave = 0; octave < std::max(s.octaves, 1); ++octave)
+			{
+				float py = (y + 0.5f) / height * frequency;
+				float pz = (z + 0.5f) / depth * frequency;
+				kernel(out, width, py, pz, frequency, s.seed + octave * OCTAVE_SEED_STEP, amplitude);
+
+				total += amplitude;
+				amplitude *= s.gain;
+				frequency *= 2;
+			}
+
+			float inv_total = total > 0.0f ? 1.0f / total : 0.0f;
+			for (int i = 0; i < width; ++i)
+				out[i] *= inv_total;
+		}
+
+		inline static Row_Kernel
+		_perlin_kernel(const Noise_Settings& s)
+		{
+			return s.allow_simd && hasAVX2() ? perlinRowAVX2 : perlinRow;
+		}
+
+		inline static Row_Kernel
+		_worley_kernel(const Noise_Settings& s)
+		{
+			return s.allow_simd && hasAVX2() ? worleyRowAVX2 : worleyRow;
+		}
+
+		inline static bool
+		_valid_volume(Image3D* img, int channel)
+		{
+			return img && img->hasData() && channel >= 0 && channel < img->getChannels();
+		}
+
+		void
+		perlinRow(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude)
+		{
+			float scale = float(period) / float(width);
+			for (int i = 0; i < width; ++i)
+				out[i] += amplitude * perlinSample((i + 0.5f) * scale, py, pz, period, seed);
+		}
+
+		void
+		worleyRow(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude)
+		{
+			float scale = float(period) / float(width);
+			for (int i = 0; i < width; ++i)
+				out[i] += amplitude * worleySample((i + 0.5f) * scale, py, pz, period, seed);
+		}
+
+		void
+		bakePerlin(Image3D* img, const Noise_Settings& settings, int channel)
+		{
+			if (!_valid_volume(img, channel))
+				return;
+
+			auto kernel = _perlin_kernel(settings);
+			int width = img->getWidth(), height = img->getHeight(), depth = img->getDepth();
+
+			parallelFor(depth, settings.threads, [&](int z) {
+				std::vector<float> row(width);
+				for (int y = 0; y < height; ++y)
+				{
+					_fbm_row(kernel, row.data(), width, y, z, height, depth, settings);
+
+					// perlin is in [-1, 1]
+					for (int i = 0; i < width; ++i)
+						row[i] = std::clamp(row[i] * 0.5f + 0.5f, 0.0f, 1.0f);
+
+					img->setRow(y, z, row.data(), channel);
+				}
+			});
+		}
+
+		void
+		bakeWorley(Image3D* img, const Noise_Settings& settings, int channel)
+		{
+			if (!_valid_volume(img, channel))
+				return;
+
+			auto kernel = _worley_kernel(settings);
+			int width = img->getWidth(), height = img->getHeight(), depth = img->getDepth();
+
+			parallelFor(depth, settings.threads, [&](int z) {
+				std::vector<float> row(width);
+				for (int y = 0; y < height; ++y)
+				{
+					_fbm_row(kernel, row.data(), width, y, z, height, depth, settings);
+					img->setRow(y, z, row.data(), channel);
+				}
+			});
+		}
+
+		void
+		bakePerlinWorley(
+			Image3D* img,
+			const Noise_Settings& perlin_settings,
+			const Noise_Settings& worley_settings,
+			int channel)
+		{
+			if (!_valid_volume(img, channel))
+				return;
+
+			auto perlin_kernel = _perlin_kernel(perlin_settings);
+			auto worley_kernel = _worley_kernel(worley_settings);
+			int width = img->getWidth(), height = img->getHeight(), depth = img->getDepth();
+
+			parallelFor(depth, perlin_settings.threads, [&](int z) {
+				std::vector<float> perlin(width), row(width);
+				for (int y = 0; y < height; ++y)
+				{
+					_fbm_row(perlin_kernel, perlin.data(), width, y, z, height, depth, perlin_settings);
+					_fbm_row(worley_kernel, row.data(), width, y, z, height, depth, worley_settings);
+
+					// remap(perlin, worley - 1, 1, 0, 1)
+					for (int i = 0; i < width; ++i)
+					{
+						float p = perlin[i] * 0.5f + 0.5f;
+						float w = row[i];
+						row[i] = std::clamp((p - (w - 1.0f)) / (2.0f - w), 0.0f, 1.0f);
+					}
+
+					img->setRow(y, z, row.data(), channel);
+				}
+			});
+		}
+
+		Image
+		bakeBlueNoise(int size, uint32_t seed)
+		{
+			size = std::max(size, 4);
+			int count = size * size;
+
+			// gaussian energy of every pixel against the pixels that are set, distances wrap so the image tiles
+			std::vector<float> kernel(count);
+			float falloff = 1.0f / (2.0f * BLUE_NOISE_SIGMA * BLUE_NOISE_SIGMA);
+			for (int y = 0; y < size; ++y)
+			{
+				for (int x = 0; x < size; ++x)
+				{
+					float dx = float(std::min(x, size - x));
+					float dy = float(std::min(y, size - y));
+					kernel[y * size + x] = std::exp(-(dx * dx + dy * dy) * falloff);
+				}
+			}
+
+			std::vector<uint8_t> pattern(count, 0);
+			std::vector<float> energy(count, 0.0f);
+
+			auto set = [&](int p, uint8_t value) {
+				pattern[p] = value;
+				float sign = value ? 1.0f : -1.0f;
+				int px = p % size, py = p / size;
+				for (int y = 0; y < size; ++y)
+				{
+					auto row = kernel.data() + ((y - py + size) % size) * size;
+					for (int x = 0; x < size; ++x)
+						energy[y * size + x] += sign * row[(x - px + size) % size];
+				}
+			};
+
+			// the set pixel with the most energy around it and the empty pixel with the least
+			auto tightest_cluster = [&]() {
+				int best = -1;
+				for (int p = 0; p < count; ++p)
+					if (pattern[p] && (best < 0 || energy[p] > energy[best]))
+						best = p;
+				return best;
+			};
+
+			auto largest_void = [&]() {
+				int best = -1;
+				for (int p = 0; p < count; ++p)
+					if (!pattern[p] && (best < 0 || energy[p] < energy[best]))
+						best = p;
+				return best;
+			};
+
+			// a tenth of the pixels at random, then moved from clusters to voids until they're evenly spread
+			std::mt19937 rng(seed);
+			int ones = 0;
+			while (ones < count / 10)
+			{
+				int p = int(rng() % uint32_t(count));
+				if (!pattern[p])
+				{
+					set(p, 1);
+					++ones;
+				}
+			}
+
+			for (;;)
+			{
+				int cluster = tightest_cluster();
+				set(cluster, 0);
+
+				int hole = largest_void();
+				set(hole, 1);
+
+				if (hole == cluster)
+					break;
+			}
+
+			// ranks the initial points by taking clusters out, then fills the voids one pixel at a time
+			std::vector<int> ranks(count);
+			auto initial_pattern = pattern;
+			auto initial_energy = energy;
+
+			for (int rank = ones - 1; rank >= 0; --rank)
+			{
+				int cluster = tightest_cluster();
+				set(cluster, 0);
+				ranks[cluster] = rank;
+			}
+
+			pattern = std::move(initial_pattern);
+			energy = std::move(initial_energy);
+
+			for (int rank = ones; rank < count; ++rank)
+			{
+				int hole = largest_void();
+				set(hole, 1);
+				ranks[hole] = rank;
+			}
+
+			Image img(size, size, 1);
+			auto data = img.getData();
+			for (int p = 0; p < count; ++p)
+				data[p] = uint8_t(int64_t(ranks[p]) * 256 / count);
+
+			return img;
+		}
+
+		bool
+		hasAVX2()
+		{
+			return hasAVX2Kernels() && cpuHasAVX2();
+		}
+	} // namespace noise
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "Image.h"
+#include "Image3D.h"
+
+#include <cstdint>
+
+namespace gfx
+{
+	namespace noise
+	{
+		// frequency is the lattice size of the first octave, every next octave doubles it and scales the
+		// amplitude by gain, the volume tiles on every axis
+		struct Noise_Settings
+		{
+			int frequency = 4;
+			int octaves = 5;
+			float gain = 0.5f;
+			uint32_t seed = 0;
+
+			// 0 uses one thread per hardware thread
+			uint32_t threads = 0;
+
+			// use the AVX2 kernels when the cpu supports them
+			bool allow_simd = true;
+		};
+
+		// the bake functions fill one channel of the whole volume with values in [0, 1], baking different noises
+		// into the channels of an RGBA8 volume packs them into a single texture fetch
+		void
+		bakePerlin(Image3D* img, const Noise_Settings& settings, int channel = 0);
+
+		void
+		bakeWorley(Image3D* img, const Noise_Settings& settings, int channel = 0);
+
+		// perlin fbm remapped by inverted worley fbm, gives the billowy shapes used for clouds
+		void
+		bakePerlinWorley(
+			Image3D* img,
+			const Noise_Settings& perlin_settings,
+			const Noise_Settings& worley_settings,
+			int channel = 0);
+
+		// single channel 8 bit blue noise made with void and cluster, every value shows up equally often and
+		// neighbouring pixels are far apart in value, the image tiles. made for jittering samples per pixel
+		Image
+		bakeBlueNoise(int size = 64, uint32_t seed = 0);
+
+		// true when the cpu and os support AVX2 and FMA, and the library was built with the AVX2 kernels
+		bool
+		hasAVX2();
+	} // namespace noise
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,243 @@
+#include "gfx_noise_kernels.h"
+
+// this file is built with AVX2 and FMA enabled, its kernels are only called once the cpu reported support for them
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+
+#include <immintrin.h>
+
+namespace gfx
+{
+	namespace noise
+	{
+		inline static __m256i
+		_hash_finalize(__m256i h)
+		{
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+			h = _mm256_mullo_epi32(h, _mm256_set1_epi32(int(HASH_MIX_A)));
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 12));
+			h = _mm256_mullo_epi32(h, _mm256_set1_epi32(int(HASH_MIX_B)));
+			h = _mm256_xor_si256(h, _mm256_srli_epi32(h, 15));
+			return h;
+		}
+
+		inline static __m256i
+		_hash(__m256i hx, uint32_t yz)
+		{
+			return _hash_finalize(_mm256_xor_si256(hx, _mm256_set1_epi32(int(yz))));
+		}
+
+		// brings lanes in [-1, period] back into [0, period)
+		inline static __m256i
+		_wrap(__m256i i, int period)
+		{
+			auto p = _mm256_set1_epi32(period);
+			auto negative = _mm256_cmpgt_epi32(_mm256_setzero_si256(), i);
+			auto overflow = _mm256_cmpgt_epi32(i, _mm256_set1_epi32(period - 1));
+			i = _mm256_add_epi32(i, _mm256_and_si256(negative, p));
+			i = _mm256_sub_epi32(i, _mm256_and_si256(overflow, p));
+			return i;
+		}
+
+		inline static __m256
+		_fade(__m256 t)
+		{
+			auto r = _mm256_fmadd_ps(t, _mm256_set1_ps(6.0f), _mm256_set1_ps(-15.0f));
+			r = _mm256_fmadd_ps(t, r, _mm256_set1_ps(10.0f));
+			return _mm256_mul_ps(_mm256_mul_ps(_mm256_mul_ps(t, t), t), r);
+		}
+
+		inline static __m256
+		_lerp(__m256 a, __m256 b, __m256 t)
+		{
+			return _mm256_fmadd_ps(t, _mm256_sub_ps(b, a), a);
+		}
+
+		inline static __m256
+		_lerp(__m256 a, __m256 b, float t)
+		{
+			return _lerp(a, b, _mm256_set1_ps(t));
+		}
+
+		// same case table as grad() in gfx_noise_kernels.h, y and z are constant along a row
+		inline static __m256
+		_grad(__m256i h, __m256 x, float y, float z)
+		{
+			h = _mm256_and_si256(h, _mm256_set1_epi32(15));
+
+			auto vy = _mm256_set1_ps(y);
+			auto vz = _mm256_set1_ps(z);
+
+			auto lt8 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(8), h));
+			auto lt4 = _mm256_castsi256_ps(_mm256_cmpgt_epi32(_mm256_set1_epi32(4), h));
+			auto is_x = _mm256_castsi256_ps(_mm256_or_si256(
+				_mm256_cmpeq_epi32(h, _mm256_set1_epi32(12)),
+				_mm256_cmpeq_epi32(h, _mm256_set1_epi32(14))));
+
+			auto u = _mm256_blendv_ps(vy, x, lt8);
+			auto v = _mm256_blendv_ps(_mm256_blendv_ps(vz, x, is_x), vy, lt4);
+
+			// bit 0 and bit 1 of the case flip the sign of u and v
+			auto sign_u = _mm256_castsi256_ps(_mm256_slli_epi32(h, 31));
+			auto sign_v = _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_srli_epi32(h, 1), 31));
+
+			return _mm256_add_ps(_mm256_xor_ps(u, sign_u), _mm256_xor_ps(v, sign_v));
+		}
+
+		bool
+		hasAVX2Kernels()
+		{
+			return true;
+		}
+
+		void
+		perlinRowAVX2(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude)
+		{
+			float fy = std::floor(py), fz = std::floor(pz);
+			int y0 = int(fy), z0 = int(fz);
+			int y1 = wrap(y0 + 1, period), z1 = wrap(z0 + 1, period);
+			float y = py - fy, z = pz - fz;
+			float v = fade(y), w = fade(z);
+
+			uint32_t h00 = hashYZ(y0, z0, seed), h10 = hashYZ(y1, z0, seed);
+			uint32_t h01 = hashYZ(y0, z1, seed), h11 = hashYZ(y1, z1, seed);
+
+			float scale = float(period) / float(width);
+			auto lanes = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			auto one = _mm256_set1_ps(1.0f);
+			auto amp = _mm256_set1_ps(amplitude);
+
+			int i = 0;
+			for (; i + 8 <= width; i += 8)
+			{
+				auto px = _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(float(i)), lanes), _mm256_set1_ps(scale));
+				auto fx = _mm256_floor_ps(px);
+				auto x0 = _mm256_cvttps_epi32(fx);
+				auto x1 = _wrap(_mm256_add_epi32(x0, _mm256_set1_epi32(1)), period);
+				auto x = _mm256_sub_ps(px, fx);
+				auto xm = _mm256_sub_ps(x, one);
+
+				auto hx0 = _mm256_mullo_epi32(x0, _mm256_set1_epi32(int(HASH_X)));
+				auto hx1 = _mm256_mullo_epi32(x1, _mm256_set1_epi32(int(HASH_X)));
+
+				auto n000 = _grad(_hash(hx0, h00), x, y, z), n100 = _grad(_hash(hx1, h00), xm, y, z);
+				auto n010 = _grad(_hash(hx0, h10), x, y - 1, z), n110 = _grad(_hash(hx1, h10), xm, y - 1, z);
+				auto n001 = _grad(_hash(hx0, h01), x, y, z - 1), n101 = _grad(_hash(hx1, h01), xm, y, z - 1);
+				auto n011 = _grad(_hash(hx0, h11), x, y - 1, z - 1);
+				auto n111 = _grad(_hash(hx1, h11), xm, y - 1, z - 1);
+
+				auto u = _fade(x);
+				auto n = _lerp(
+					_lerp(_lerp(n000, n100, u), _lerp(n010, n110, u), v),
+					_lerp(_lerp(n001, n101, u), _lerp(n011, n111, u), v),
+					w);
+
+				_mm256_storeu_ps(out + i, _mm256_fmadd_ps(amp, n, _mm256_loadu_ps(out + i)));
+			}
+
+			for (; i < width; ++i)
+				out[i] += amplitude * perlinSample((i + 0.5f) * scale, py, pz, period, seed);
+		}
+
+		void
+		worleyRowAVX2(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude)
+		{
+			float fy = std::floor(py), fz = std::floor(pz);
+			int cy = int(fy), cz = int(fz);
+			float y = py - fy, z = pz - fz;
+
+			// the 9 neighbouring (y, z) cells are shared by every voxel of the row
+			uint32_t yz[9];
+			float dyz2[9][2];
+			for (int oz = -1; oz <= 1; ++oz)
+			{
+				for (int oy = -1; oy <= 1; ++oy)
+				{
+					auto k = (oz + 1) * 3 + (oy + 1);
+					yz[k] = hashYZ(wrap(cy + oy, period), wrap(cz + oz, period), seed);
+					dyz2[k][0] = oy - y;
+					dyz2[k][1] = oz - z;
+				}
+			}
+
+			float scale = float(period) / float(width);
+			auto lanes = _mm256_setr_ps(0.5f, 1.5f, 2.5f, 3.5f, 4.5f, 5.5f, 6.5f, 7.5f);
+			auto mask = _mm256_set1_epi32(1023);
+			auto to_unit = _mm256_set1_ps(1.0f / 1024.0f);
+			auto one = _mm256_set1_ps(1.0f);
+			auto amp = _mm256_set1_ps(amplitude);
+
+			int i = 0;
+			for (; i + 8 <= width; i += 8)
+			{
+				auto px = _mm256_mul_ps(_mm256_add_ps(_mm256_set1_ps(float(i)), lanes), _mm256_set1_ps(scale));
+				auto fx = _mm256_floor_ps(px);
+				auto cx = _mm256_cvttps_epi32(fx);
+				auto x = _mm256_sub_ps(px, fx);
+
+				auto min_d2 = _mm256_set1_ps(3.0f);
+				for (int ox = -1; ox <= 1; ++ox)
+				{
+					auto c = _wrap(_mm256_add_epi32(cx, _mm256_set1_epi32(ox)), period);
+					auto hx = _mm256_mullo_epi32(c, _mm256_set1_epi32(int(HASH_X)));
+					auto base_x = _mm256_sub_ps(_mm256_set1_ps(float(ox)), x);
+
+					for (int k = 0; k < 9; ++k)
+					{
+						auto h = _hash(hx, yz[k]);
+						auto jx = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(h, mask)), to_unit);
+						auto jy = _mm256_mul_ps(
+							_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(h, 10), mask)),
+							to_unit);
+						auto jz = _mm256_mul_ps(
+							_mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srli_epi32(h, 20), mask)),
+							to_unit);
+
+						auto dx = _mm256_add_ps(base_x, jx);
+						auto dy = _mm256_add_ps(_mm256_set1_ps(dyz2[k][0]), jy);
+						auto dz = _mm256_add_ps(_mm256_set1_ps(dyz2[k][1]), jz);
+
+						auto d2 = _mm256_mul_ps(dx, dx);
+						d2 = _mm256_fmadd_ps(dy, dy, d2);
+						d2 = _mm256_fmadd_ps(dz, dz, d2);
+						min_d2 = _mm256_min_ps(min_d2, d2);
+					}
+				}
+
+				auto d = _mm256_min_ps(_mm256_sqrt_ps(min_d2), one);
+				auto n = _mm256_sub_ps(one, d);
+				_mm256_storeu_ps(out + i, _mm256_fmadd_ps(amp, n, _mm256_loadu_ps(out + i)));
+			}
+
+			for (; i < width; ++i)
+				out[i] += amplitude * worleySample((i + 0.5f) * scale, py, pz, period, seed);
+		}
+	} // namespace noise
+} // namespace gfx
+
+#else
+
+namespace gfx
+{
+	namespace noise
+	{
+		bool
+		hasAVX2Kernels()
+		{
+			return false;
+		}
+
+		void
+		perlinRowAVX2(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude)
+		{
+			perlinRow(out, width, py, pz, period, seed, amplitude);
+		}
+
+		void
+		worleyRowAVX2(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude)
+		{
+			worleyRow(out, width, py, pz, period, seed, amplitude);
+		}
+	} // namespace noise
+} // namespace gfx
+
+#endif
\ No newline at end of file
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+// shared between the scalar and the AVX2 translation units so both produce the same volumes, the helpers are static
+// so each unit keeps its own copy and the linker can't pick the AVX2 one for the scalar fallback
+namespace gfx
+{
+	namespace noise
+	{
+		// adds amplitude * noise for the voxels of one row, py and pz are in lattice units and the lattice wraps
+		// every period cells so the result tiles
+		using Row_Kernel = void (*)(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude);
+
+		void
+		perlinRow(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude);
+
+		void
+		worleyRow(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude);
+
+		// false when the translation unit was not built with AVX2 enabled
+		bool
+		hasAVX2Kernels();
+
+		void
+		perlinRowAVX2(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude);
+
+		void
+		worleyRowAVX2(float* out, int width, float py, float pz, int period, uint32_t seed, float amplitude);
+
+		// multiply and xor-shift only, so it maps one to one on 32 bit simd lanes
+		constexpr uint32_t HASH_X = 0x8da6b343u;
+		constexpr uint32_t HASH_Y = 0xd8163841u;
+		constexpr uint32_t HASH_Z = 0xcb1ab31fu;
+		constexpr uint32_t HASH_SEED = 0x165667b1u;
+		constexpr uint32_t HASH_MIX_A = 0x2c1b3c6du;
+		constexpr uint32_t HASH_MIX_B = 0x297a2d39u;
+
+		inline static uint32_t
+		hashYZ(int y, int z, uint32_t seed)
+		{
+			return uint32_t(y) * HASH_Y ^ uint32_t(z) * HASH_Z ^ seed * HASH_SEED;
+		}
+
+		inline static uint32_t
+		hashFinalize(uint32_t h)
+		{
+			h ^= h >> 15;
+			h *= HASH_MIX_A;
+			h ^= h >> 12;
+			h *= HASH_MIX_B;
+			h ^= h >> 15;
+			return h;
+		}
+
+		inline static uint32_t
+		hash(int x, uint32_t yz)
+		{
+			return hashFinalize(uint32_t(x) * HASH_X ^ yz);
+		}
+
+		inline static int
+		wrap(int i, int period)
+		{
+			if (i < 0)
+				return i + period;
+			if (i >= period)
+				return i - period;
+			return i;
+		}
+
+		inline static float
+		fade(float t)
+		{
+			return t * t * t * (t * (t * 6.0f - 15.0f) + 10.0f);
+		}
+
+		inline static float
+		lerp(float a, float b, float t)
+		{
+			return a + t * (b - a);
+		}
+
+		// the 12 cube edge gradients of improved perlin noise picked with 16 cases
+		inline static float
+		grad(uint32_t h, float x, float y, float z)
+		{
+			h &= 15;
+			float u = h < 8 ? x : y;
+			float v = h < 4 ? y : (h == 12 || h == 14 ? x : z);
+			return ((h & 1) ? -u : u) + ((h & 2) ? -v : v);
+		}
+
+		// 10 bits per axis of the hash place the feature point inside its cell
+		inline static float
+		jitter(uint32_t h, int shift)
+		{
+			return float((h >> shift) & 1023u) * (1.0f / 1024.0f);
+		}
+
+		inline static float
+		perlinSample(float px, float py, float pz, int period, uint32_t seed)
+		{
+			float fx = std::floor(px), fy = std::floor(py), fz = std::floor(pz);
+			int x0 = int(fx), y0 = int(fy), z0 = int(fz);
+			int x1 = wrap(x0 + 1, period), y1 = wrap(y0 + 1, period), z1 = wrap(z0 + 1, period);
+			float x = px - fx, y = py - fy, z = pz - fz;
+
+			uint32_t h00 = hashYZ(y0, z0, seed), h10 = hashYZ(y1, z0, seed);
+			uint32_t h01 = hashYZ(y0, z1, seed), h11 = hashYZ(y1, z1, seed);
+
+			float n000 = grad(hash(x0, h00), x, y, z), n100 = grad(hash(x1, h00), x - 1, y, z);
+			float n010 = grad(hash(x0, h10), x, y - 1, z), n110 = grad(hash(x1, h10), x - 1, y - 1, z);
+			float n001 = grad(hash(x0, h01), x, y, z - 1), n101 = grad(hash(x1, h01), x - 1, y, z - 1);
+			float n011 = grad(hash(x0, h11), x, y - 1, z - 1), n111 = grad(hash(x1, h11), x - 1, y - 1, z - 1);
+
+			float u = fade(x), v = fade(y), w = fade(z);
+			return lerp(
+				lerp(lerp(n000, n100, u), lerp(n010, n110, u), v),
+				lerp(lerp(n001, n101, u), lerp(n011, n111, u), v),
+				w);
+		}
+
+		// inverted distance to the closest feature point, 1 on a feature point and 0 one cell away or more
+		inline static float
+		worleySample(float px, float py, float pz, int period, uint32_t seed)
+		{
+			float fx = std::floor(px), fy = std::floor(py), fz = std::floor(pz);
+			int cx = int(fx), cy = int(fy), cz = int(fz);
+			float x = px - fx, y = py - fy, z = pz - fz;
+
+			float min_d2 = 3.0f;
+			for (int oz = -1; oz <= 1; ++oz)
+			{
+				for (int oy = -1; oy <= 1; ++oy)
+				{
+					uint32_t yz = hashYZ(wrap(cy + oy, period), wrap(cz + oz, period), seed);
+					for (int ox = -1; ox <= 1; ++ox)
+					{
+						uint32_t h = hash(wrap(cx + ox, period), yz);
+						float dx = ox + jitter(h, 0) - x;
+						float dy = oy + jitter(h, 10) - y;
+						float dz = oz + jitter(h, 20) - z;
+						float d2 = dx * dx + dy * dy + dz * dz;
+						min_d2 = d2 < min_d2 ? d2 : min_d2;
+					}
+				}
+			}
+
+			float d = std::sqrt(min_d2);
+			return 1.0f - (d < 1.0f ? d : 1.0f);
+		}
+	} // namespace noise
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,35 @@
+#include "gfx_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+namespace gfx
+{
+	void
+	parallelFor(int count, uint32_t threads, const std::function<void(int)>& task)
+	{
+		if (count <= 0)
+			return;
+
+		if (threads == 0)
+			threads = std::max(std::thread::hardware_concurrency(), 1u);
+		threads = std::min(threads, uint32_t(count));
+
+		std::atomic<int> next{0};
+		auto worker = [&]() {
+			for (int i = next++; i < count; i = next++)
+				task(i);
+		};
+
+		std::vector<std::thread> workers;
+		for (uint32_t i = 1; i < threads; ++i)
+			workers.emplace_back(worker);
+
+		worker();
+
+		for (auto& t : workers)
+			t.join();
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+
+namespace gfx
+{
+	// calls task for every index in [0, count) spread over threads, 0 uses one thread per hardware thread
+	// indices are handed out one at a time so faster threads pick up more of them, the calling thread works too
+	void
+	parallelFor(int count, uint32_t threads, const std::function<void(int)>& task);
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,271 @@
+#include "gfx_parameter_block.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <unordered_map>
+
+namespace gfx
+{
+	// the block that uploaded the default block values of each program last
+	static std::unordered_map<uint32_t, const ParameterBlock*> program_owners;
+
+	inline static bool
+	_is_int_type(uint32_t type)
+	{
+		return type == GL_INT || type == GL_BOOL || type == GL_UNSIGNED_INT;
+	}
+
+	ParameterBlock::ParameterBlock(uint32_t program, const std::string& block_name)
+		: program(program),
+		  reflection(reflectProgram(program)),
+		  uniform_block(!block_name.empty()),
+		  binding(-1),
+		  buffer(0),
+		  dirty_begin(0),
+		  dirty_end(0),
+		  dirty(false)
+	{
+		int32_t block_index = -1;
+		if (uniform_block)
+		{
+			auto block = reflection.findBlock(block_name);
+			if (block == nullptr)
+			{
+				std::cout << "Program has no uniform block " << block_name << std::endl;
+				uniform_block = false;
+				return;
+			}
+
+			block_index = block->index;
+			binding = block->binding;
+			shadow.resize(block->size, 0);
+		}
+
+		for (auto& uniform : reflection.uniforms)
+		{
+			if (uniform.block_index != block_index || uniformTypeSize(uniform.type) == 0)
+				continue;
+
+			Parameter parameter;
+			parameter.name = uniform.name;
+			parameter.type = uniform.type;
+			parameter.location = uniform.location;
+			parameter.size = uniformTypeSize(uniform.type);
+			parameter.matrix_stride = uniform.matrix_stride;
+			parameter.dirty = false;
+
+			// default block values are packed one after the other, block members sit where the block layout puts them
+			parameter.offset = uniform_block ? uint32_t(uniform.offset) : uint32_t(shadow.size());
+			if (!uniform_block)
+			{
+				// start from what the program holds so an untouched value isn't overwritten with zeros
+				shadow.resize(shadow.size() + parameter.size);
+				if (_is_int_type(uniform.type))
+					glGetUniformiv(program, uniform.location, (GLint*)&shadow[parameter.offset]);
+				else
+					glGetUniformfv(program, uniform.location, (GLfloat*)&shadow[parameter.offset]);
+			}
+
+			parameters.push_back(parameter);
+		}
+
+		if (uniform_block)
+		{
+			glGenBuffers(1, &buffer);
+			glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+			glBufferData(GL_UNIFORM_BUFFER, shadow.size(), shadow.data(), GL_DYNAMIC_DRAW);
+			glBindBuffer(GL_UNIFORM_BUFFER, 0);
+		}
+	}
+
+	ParameterBlock::~ParameterBlock()
+	{
+		if (buffer)
+			glDeleteBuffers(1, &buffer);
+
+		auto it = program_owners.find(program);
+		if (it != program_owners.end() && it->second == this)
+			program_owners.erase(it);
+	}
+
+	bool
+	ParameterBlock::has(const std::string& name) const
+	{
+		for (auto& parameter : parameters)
+			if (parameter.name == name)
+				return true;
+		return false;
+	}
+
+	bool
+	ParameterBlock::setFloat(const std::string& name, float value)
+	{
+		return write(name, GL_FLOAT, &value, sizeof(value), 1);
+	}
+
+	bool
+	ParameterBlock::setInt(const std::string& name, int value)
+	{
+		return write(name, GL_INT, &value, sizeof(value), 1);
+	}
+
+	bool
+	ParameterBlock::setVec2(const std::string& name, const glm::vec2& value)
+	{
+		return write(name, GL_FLOAT_VEC2, &value[0], sizeof(value), 1);
+	}
+
+	bool
+	ParameterBlock::setVec3(const std::string& name, const glm::vec3& value)
+	{
+		return write(name, GL_FLOAT_VEC3, &value[0], sizeof(value), 1);
+	}
+
+	bool
+	ParameterBlock::setVec4(const std::string& name, const glm::vec4& value)
+	{
+		return write(name, GL_FLOAT_VEC4, &value[0], sizeof(value), 1);
+	}
+
+	bool
+	ParameterBlock::setMat4(const std::string& name, const glm::mat4& value)
+	{
+		return write(name, GL_FLOAT_MAT4, &value[0][0], sizeof(value), 4);
+	}
+
+	void
+	ParameterBlock::apply()
+	{
+		if (uniform_block)
+		{
+			if (dirty)
+			{
+				glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+				glBufferSubData(GL_UNIFORM_BUFFER, dirty_begin, dirty_end - dirty_begin, shadow.data() + dirty_begin);
+				glBindBuffer(GL_UNIFORM_BUFFER, 0);
+			}
+
+			glBindBufferBase(GL_UNIFORM_BUFFER, binding, buffer);
+			dirty = false;
+			return;
+		}
+
+		// another block wrote the program's values since this one was applied, all of them have to go again
+		auto& owner = program_owners[program];
+		bool upload_all = owner != this;
+		owner = this;
+
+		if (!dirty && !upload_all)
+			return;
+
+		for (auto& parameter : parameters)
+		{
+			if (parameter.dirty || upload_all)
+				uploadUniform(parameter);
+			parameter.dirty = false;
+		}
+
+		dirty = false;
+	}
+
+	bool
+	ParameterBlock::isDirty() const
+	{
+		return dirty;
+	}
+
+	uint32_t
+	ParameterBlock::getBuffer() const
+	{
+		return buffer;
+	}
+
+	const Program_Reflection&
+	ParameterBlock::getReflection() const
+	{
+		return reflection;
+	}
+
+	bool
+	ParameterBlock::write(const std::string& name, uint32_t type, const void* data, uint32_t size, uint32_t columns)
+	{
+		auto it = std::find_if(
+			parameters.begin(),
+			parameters.end(),
+			[&](const Parameter& parameter) { return parameter.name == name; });
+		if (it == parameters.end())
+			return false;
+
+		auto& parameter = *it;
+		bool same_type = parameter.type == type || (type == GL_INT && _is_int_type(parameter.type));
+		if (!same_type)
+		{
+			std::cout << "Parameter " << name << " has a different type" << std::endl;
+			return false;
+		}
+
+		// block matrices store their columns matrix_stride apart, everything else is copied as is
+		auto column_size = size / columns;
+		auto stride = uniform_block && columns > 1 ? uint32_t(parameter.matrix_stride) : column_size;
+
+		bool changed = false;
+		auto src = (const uint8_t*)data;
+		for (uint32_t column = 0; column < columns; ++column)
+		{
+			auto dst = shadow.data() + parameter.offset + column * stride;
+			if (memcmp(dst, src + column * column_size, column_size) != 0)
+			{
+				memcpy(dst, src + column * column_size, column_size);
+				changed = true;
+			}
+		}
+
+		if (!changed)
+			return true;
+
+		size_t begin = parameter.offset;
+		size_t end = parameter.offset + (columns - 1) * stride + column_size;
+		dirty_begin = dirty ? std::min(dirty_begin, begin) : begin;
+		dirty_end = dirty ? std::max(dirty_end, end) : end;
+		parameter.dirty = true;
+		dirty = true;
+		return true;
+	}
+
+	void
+	ParameterBlock::uploadUniform(const Parameter& parameter)
+	{
+		auto data = shadow.data() + parameter.offset;
+		switch (parameter.type)
+		{
+		case GL_FLOAT:
+			glProgramUniform1fv(program, parameter.location, 1, (const GLfloat*)data);
+			break;
+		case GL_FLOAT_VEC2:
+			glProgramUniform2fv(program, parameter.location, 1, (const GLfloat*)data);
+			break;
+		case GL_FLOAT_VEC3:
+			glProgramUniform3fv(program, parameter.location, 1, (const GLfloat*)data);
+			break;
+		case GL_FLOAT_VEC4:
+			glProgramUniform4fv(program, parameter.location, 1, (const GLfloat*)data);
+			break;
+		case GL_FLOAT_MAT4:
+			glProgramUniformMatrix4fv(program, parameter.location, 1, GL_FALSE, (const GLfloat*)data);
+			break;
+		case GL_INT:
+		case GL_BOOL:
+			glProgramUniform1iv(program, parameter.location, 1, (const GLint*)data);
+			break;
+		case GL_UNSIGNED_INT:
+			glProgramUniform1uiv(program, parameter.location, 1, (const GLuint*)data);
+			break;
+		default:
+			// the setters only reach the types above, the others keep what the program holds
+			break;
+		}
+	}
+} // namespace gfx
\ No newline at end of file
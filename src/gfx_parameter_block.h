@@ -0,0 +1,101 @@
+#pragma once
+
+#include "gfx_program_reflection.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	// the parameters of a program built from its reflection, the setters write a cpu copy and apply uploads only
+	// what changed, so a material whose values stay the same costs nothing per frame. setting a value it already
+	// holds doesn't mark it dirty, names the compiler dropped as unused are ignored
+	class ParameterBlock
+	{
+	public:
+		// an empty block_name covers the default block uniforms of the program, they're uploaded with
+		// glProgramUniform*. the name of a uniform block gives the ParameterBlock a uniform buffer laid out like the
+		// block, only its dirty range is uploaded and it's bound to the binding of the block on apply
+		ParameterBlock(uint32_t program, const std::string& block_name = "");
+
+		ParameterBlock(const ParameterBlock&) = delete;
+
+		ParameterBlock&
+		operator=(const ParameterBlock&) = delete;
+
+		~ParameterBlock();
+
+		bool
+		has(const std::string& name) const;
+
+		// return false when the program has no such parameter or its type is different, arrays get their
+		// first element
+		bool
+		setFloat(const std::string& name, float value);
+
+		bool
+		setInt(const std::string& name, int value);
+
+		bool
+		setVec2(const std::string& name, const glm::vec2& value);
+
+		bool
+		setVec3(const std::string& name, const glm::vec3& value);
+
+		bool
+		setVec4(const std::string& name, const glm::vec4& value);
+
+		bool
+		setMat4(const std::string& name, const glm::mat4& value);
+
+		// call before drawing with the program, default block values are program state so when several blocks
+		// share a program the one applied last uploads everything it holds. values written around the block with
+		// setGPUProgram* aren't noticed
+		void
+		apply();
+
+		bool
+		isDirty() const;
+
+		// 0 for the default block
+		uint32_t
+		getBuffer() const;
+
+		const Program_Reflection&
+		getReflection() const;
+
+	private:
+		struct Parameter
+		{
+			std::string name;
+			uint32_t type;
+			int32_t location;
+			uint32_t offset;
+			uint32_t size;
+			int32_t matrix_stride;
+			bool dirty;
+		};
+
+		uint32_t program;
+		Program_Reflection reflection;
+		bool uniform_block;
+		int32_t binding;
+		uint32_t buffer;
+
+		std::vector<Parameter> parameters;
+		std::vector<uint8_t> shadow;
+
+		// byte range of the uniform buffer written since the last apply
+		size_t dirty_begin, dirty_end;
+		bool dirty;
+
+		bool
+		write(const std::string& name, uint32_t type, const void* data, uint32_t size, uint32_t columns);
+
+		void
+		uploadUniform(const Parameter& parameter);
+	};
+} // namespace gfx
\ No newline at end of file
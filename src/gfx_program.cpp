@@ -0,0 +1,163 @@
+#include "gfx_program.h"
+#include "gfx_shader_preprocessor.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace gfx
+{
+	inline static const char*
+	_stage_name(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_VERTEX_SHADER:
+			return "VERTEX";
+		case GL_TESS_CONTROL_SHADER:
+			return "TESS_CONTROL";
+		case GL_TESS_EVALUATION_SHADER:
+			return "TESS_EVALUATION";
+		case GL_GEOMETRY_SHADER:
+			return "GEOMETRY";
+		case GL_FRAGMENT_SHADER:
+			return "FRAGMENT";
+		case GL_COMPUTE_SHADER:
+			return "COMPUTE";
+		default:
+			return "UNKNOWN";
+		}
+	}
+
+	uint32_t
+	compileShader(uint32_t type, const char* source)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderSource(shader, 1, &source, NULL);
+		glCompileShader(shader);
+
+		checkShader(shader, type);
+		return shader;
+	}
+
+	uint32_t
+	linkProgram(const std::vector<uint32_t>& shaders, bool binary_retrievable)
+	{
+		GLuint program = glCreateProgram();
+		for (auto shader : shaders)
+			glAttachShader(program, shader);
+
+		if (binary_retrievable)
+			glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+		glLinkProgram(program);
+
+		checkProgram(program);
+
+		for (auto shader : shaders)
+			glDeleteShader(shader);
+
+		return program;
+	}
+
+	bool
+	isProgramLinked(uint32_t program)
+	{
+		GLint success = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &success);
+		return success == GL_TRUE;
+	}
+
+	bool
+	checkShader(uint32_t shader, uint32_t type)
+	{
+		GLint success = GL_FALSE;
+		glGetShaderiv(shader, GL_COMPILE_STATUS, &success);
+		if (success)
+			return true;
+
+		GLint length = 0;
+		glGetShaderiv(shader, GL_INFO_LOG_LENGTH, &length);
+		std::string info_log(std::max(length, 1), '\0');
+		glGetShaderInfoLog(shader, length, NULL, &info_log[0]);
+		std::cout << "ERROR::SHADER::" << _stage_name(type) << "::COMPILATION_FAILED\n"
+				  << mapShaderLog(info_log.c_str()) << std::endl;
+		return false;
+	}
+
+	bool
+	checkProgram(uint32_t program)
+	{
+		if (isProgramLinked(program))
+			return true;
+
+		GLint length = 0;
+		glGetProgramiv(program, GL_INFO_LOG_LENGTH, &length);
+		std::string info_log(std::max(length, 1), '\0');
+		glGetProgramInfoLog(program, length, NULL, &info_log[0]);
+		std::cout << "ERROR::SHADER::PROGRAM::LINKING_FAILED\n" << mapShaderLog(info_log.c_str()) << std::endl;
+		return false;
+	}
+
+	std::string
+	injectDefines(const char* source, const std::vector<std::string>& defines)
+	{
+		if (defines.empty())
+			return source;
+
+		std::string block;
+		for (auto& define : defines)
+			block += "#define " + define + "\n";
+
+		return injectHeader(source, block);
+	}
+
+	std::string
+	injectHeader(const char* source, const std::string& header)
+	{
+		std::string result = source;
+		if (header.empty())
+			return result;
+
+		// #version has to stay the first directive and #extension has to come before any declaration, the header
+		// goes after the last of them among the leading blank, comment and directive lines
+		size_t insert = 0;
+		size_t line_start = 0;
+		while (line_start < result.size())
+		{
+			auto line_end = result.find('\n', line_start);
+			if (line_end == std::string::npos)
+				line_end = result.size();
+
+			auto first = result.find_first_not_of(" \t\r", line_start);
+			if (first != std::string::npos && first < line_end)
+			{
+				if (result.compare(first, 8, "#version") == 0 || result.compare(first, 10, "#extension") == 0)
+					insert = line_end == result.size() ? line_end : line_end + 1;
+				else if (result.compare(first, 2, "//") != 0)
+					break;
+			}
+
+			line_start = line_end + 1;
+		}
+
+		auto next_line = 1 + std::count(result.begin(), result.begin() + insert, '\n');
+
+		std::string block = header;
+		if (block.back() != '\n')
+			block += "\n";
+
+		if (insert == result.size() && insert > 0 && result.back() != '\n')
+		{
+			block = "\n" + block;
+			++next_line;
+		}
+
+		block += "#line " + std::to_string(next_line) + "\n";
+
+		result.insert(insert, block);
+		return result;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	// compiles one stage of type GL_VERTEX_SHADER, GL_FRAGMENT_SHADER..., prints the info log when it fails,
+	// the shader is returned either way and the failure shows up again when linking
+	uint32_t
+	compileShader(uint32_t type, const char* source);
+
+	// links the shaders into a new program then deletes them, binary_retrievable lets glGetProgramBinary read
+	// the program back, prints the info log when linking fails
+	uint32_t
+	linkProgram(const std::vector<uint32_t>& shaders, bool binary_retrievable = false);
+
+	bool
+	isProgramLinked(uint32_t program);
+
+	// query the compile or link status, which waits for the driver, and print the info log on failure
+	bool
+	checkShader(uint32_t shader, uint32_t type);
+
+	bool
+	checkProgram(uint32_t program);
+
+	// inserts a #define for every entry after the #version and #extension lines, entries are NAME or NAME VALUE,
+	// a #line directive keeps the line numbers of the compiler errors matching the original source
+	std::string
+	injectDefines(const char* source, const std::vector<std::string>& defines);
+
+	// inserts header after the #version and #extension lines at the top of the source, where declarations can
+	// go, followed by a #line directive like injectDefines
+	std::string
+	injectHeader(const char* source, const std::string& header);
+} // namespace gfx
\ No newline at end of file
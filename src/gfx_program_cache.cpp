@@ -0,0 +1,186 @@
+#include "gfx_program_cache.h"
+#include "gfx_hash.h"
+#include "gfx_mapped_file.h"
+#include "gfx_program.h"
+#include "gfx_shader_preprocessor.h"
+
+#include <GL/glew.h>
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+
+namespace gfx
+{
+	// bump when the file layout changes
+	constexpr uint32_t PROGRAM_CACHE_VERSION = 1;
+
+	struct Program_Cache_Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		uint32_t binary_format;
+		uint32_t size;
+	};
+
+	inline static uint64_t
+	_gl_string_hash(uint64_t seed, GLenum name)
+	{
+		auto str = (const char*)glGetString(name);
+		return str ? hash64(str, strlen(str), seed) : seed;
+	}
+
+	ProgramCache::ProgramCache(const std::string& directory)
+		: directory(directory), hits(0), misses(0), preprocessor(nullptr), driver_key(0), binary_supported(false)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+			std::cout << "Cannot create program cache directory " << directory << std::endl;
+	}
+
+	ProgramCache::~ProgramCache() {}
+
+	uint32_t
+	ProgramCache::createGPUProgram(const char* vs, const char* fs, const std::vector<std::string>& defines)
+	{
+		return createProgram({{GL_VERTEX_SHADER, vs}, {GL_FRAGMENT_SHADER, fs}}, defines);
+	}
+
+	uint32_t
+	ProgramCache::createGPUProgram(
+		const char* vs,
+		const char* gs,
+		const char* fs,
+		const std::vector<std::string>& defines)
+	{
+		return createProgram({{GL_VERTEX_SHADER, vs}, {GL_GEOMETRY_SHADER, gs}, {GL_FRAGMENT_SHADER, fs}}, defines);
+	}
+
+	void
+	ProgramCache::setPreprocessor(ShaderPreprocessor* preprocessor)
+	{
+		this->preprocessor = preprocessor;
+	}
+
+	uint32_t
+	ProgramCache::getHits() const
+	{
+		return hits;
+	}
+
+	uint32_t
+	ProgramCache::getMisses() const
+	{
+		return misses;
+	}
+
+	uint32_t
+	ProgramCache::createProgram(const std::vector<Stage>& stages, const std::vector<std::string>& defines)
+	{
+		// the strings need a current context so they're read on first use rather than in the constructor
+		if (driver_key == 0)
+		{
+			driver_key = _gl_string_hash(hash64(nullptr, 0), GL_VENDOR);
+			driver_key = _gl_string_hash(driver_key, GL_RENDERER);
+			driver_key = _gl_string_hash(driver_key, GL_VERSION);
+
+			GLint formats = 0;
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+			binary_supported = formats > 0;
+		}
+
+		std::vector<std::string> sources;
+		auto key = hashCombine(driver_key, PROGRAM_CACHE_VERSION);
+		for (auto& stage : stages)
+		{
+			if (preprocessor)
+				sources.push_back(preprocessor->process(stage.source, defines));
+			else
+				sources.push_back(injectDefines(stage.source, defines));
+			key = hashCombine(key, stage.type);
+			key = hashCombine(key, hash64(sources.back()));
+		}
+
+		auto path = (std::filesystem::path(directory) / (hashToString(key) + ".gfxprog")).string();
+
+		if (binary_supported)
+		{
+			auto program = loadCached(path, key);
+			if (program != 0)
+			{
+				++hits;
+				return program;
+			}
+		}
+
+		++misses;
+
+		std::vector<uint32_t> shaders;
+		for (size_t i = 0; i < stages.size(); ++i)
+			shaders.push_back(compileShader(stages[i].type, sources[i].c_str()));
+
+		auto program = linkProgram(shaders, binary_supported);
+		if (binary_supported && isProgramLinked(program))
+			store(path, key, program);
+
+		return program;
+	}
+
+	uint32_t
+	ProgramCache::loadCached(const std::string& path, uint64_t key)
+	{
+		MappedFile file(path.c_str());
+		if (file.isOpen() == false || file.getSize() < sizeof(Program_Cache_Header))
+			return 0;
+
+		Program_Cache_Header header;
+		memcpy(&header, file.getData(), sizeof(header));
+
+		if (memcmp(header.magic, "GFXP", 4) != 0 || header.version != PROGRAM_CACHE_VERSION || header.key != key)
+			return 0;
+
+		if (sizeof(header) + size_t(header.size) > file.getSize())
+		{
+			std::cout << "Truncated program cache file " << path << std::endl;
+			return 0;
+		}
+
+		// drivers can refuse binaries from another build even when the version string didn't change
+		GLuint program = glCreateProgram();
+		glProgramBinary(program, header.binary_format, file.getData() + sizeof(header), header.size);
+
+		if (!isProgramLinked(program))
+		{
+			glDeleteProgram(program);
+			return 0;
+		}
+
+		return program;
+	}
+
+	void
+	ProgramCache::store(const std::string& path, uint64_t key, uint32_t program)
+	{
+		GLint length = 0;
+		glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+		if (length <= 0)
+			return;
+
+		std::vector<uint8_t> binary(length);
+		GLenum binary_format = 0;
+		glGetProgramBinary(program, length, &length, &binary_format, binary.data());
+
+		Program_Cache_Header header{};
+		memcpy(header.magic, "GFXP", 4);
+		header.version = PROGRAM_CACHE_VERSION;
+		header.key = key;
+		header.binary_format = binary_format;
+		header.size = uint32_t(length);
+
+		std::vector<File_Chunk> chunks{{0, &header, sizeof(header)}, {sizeof(header), binary.data(), size_t(length)}};
+		if (!writeFileAtomically(path, chunks))
+			std::cout << "Cannot write program cache file " << path << std::endl;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	class ShaderPreprocessor;
+
+	// on-disk cache of linked program binaries keyed by the stage sources, the defines and the driver identity,
+	// warm loads hand the binary to glProgramBinary and skip the glsl compiler, binaries the driver refuses
+	// (after an update for instance) are compiled again and replaced
+	class ProgramCache
+	{
+	public:
+		ProgramCache(const std::string& directory);
+
+		~ProgramCache();
+
+		// defines are NAME or NAME VALUE and go after the #version line of every stage
+		uint32_t
+		createGPUProgram(const char* vs, const char* fs, const std::vector<std::string>& defines = {});
+
+		uint32_t
+		createGPUProgram(
+			const char* vs,
+			const char* gs,
+			const char* fs,
+			const std::vector<std::string>& defines = {});
+
+		// stages go through the preprocessor before they are hashed, so the cache key covers the included files
+		// and edits to an include recompile every program using it, nullptr goes back to plain define injection
+		void
+		setPreprocessor(ShaderPreprocessor* preprocessor);
+
+		uint32_t
+		getHits() const;
+
+		uint32_t
+		getMisses() const;
+
+	private:
+		struct Stage
+		{
+			uint32_t type;
+			const char* source;
+		};
+
+		std::string directory;
+		uint32_t hits, misses;
+		ShaderPreprocessor* preprocessor;
+
+		// hash of the vendor, renderer and version strings, 0 until the first program is created
+		uint64_t driver_key;
+		bool binary_supported;
+
+		uint32_t
+		createProgram(const std::vector<Stage>& stages, const std::vector<std::string>& defines);
+
+		uint32_t
+		loadCached(const std::string& path, uint64_t key);
+
+		void
+		store(const std::string& path, uint64_t key, uint32_t program);
+	};
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include "gfx_program_compiler.h"
+#include "gfx_program.h"
+
+#include <GL/glew.h>
+
+namespace gfx
+{
+	ProgramCompiler::ProgramCompiler(uint32_t max_threads) : parallel(false)
+	{
+		if (GLEW_KHR_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsKHR(max_threads);
+			parallel = true;
+		}
+		else if (GLEW_ARB_parallel_shader_compile)
+		{
+			glMaxShaderCompilerThreadsARB(max_threads);
+			parallel = true;
+		}
+	}
+
+	ProgramCompiler::~ProgramCompiler()
+	{
+		// ready programs belong to the caller, the pending ones were never handed out so they go with their shaders
+		for (auto& entry : entries)
+		{
+			if (entry.state != PROGRAM_PENDING)
+				continue;
+
+			for (auto& stage : entry.stages)
+				glDeleteShader(stage.shader);
+			glDeleteProgram(entry.program);
+		}
+	}
+
+	uint32_t
+	ProgramCompiler::submit(const char* vs, const char* fs)
+	{
+		return submit({{0, GL_VERTEX_SHADER}, {0, GL_FRAGMENT_SHADER}}, {vs, fs});
+	}
+
+	uint32_t
+	ProgramCompiler::submit(const char* vs, const char* gs, const char* fs)
+	{
+		return submit({{0, GL_VERTEX_SHADER}, {0, GL_GEOMETRY_SHADER}, {0, GL_FRAGMENT_SHADER}}, {vs, gs, fs});
+	}
+
+	bool
+	ProgramCompiler::isReady(uint32_t handle)
+	{
+		if (handle >= entries.size())
+			return false;
+
+		auto& entry = entries[handle];
+		if (entry.state == PROGRAM_PENDING)
+			poll(entry, false);
+		return entry.state == PROGRAM_READY;
+	}
+
+	bool
+	ProgramCompiler::isFailed(uint32_t handle)
+	{
+		if (handle >= entries.size())
+			return true;
+
+		auto& entry = entries[handle];
+		if (entry.state == PROGRAM_PENDING)
+			poll(entry, false);
+		return entry.state == PROGRAM_FAILED;
+	}
+
+	uint32_t
+	ProgramCompiler::getProgram(uint32_t handle)
+	{
+		return isReady(handle) ? entries[handle].program : 0;
+	}
+
+	uint32_t
+	ProgramCompiler::update()
+	{
+		uint32_t pending = 0;
+		for (auto& entry : entries)
+		{
+			if (entry.state != PROGRAM_PENDING)
+				continue;
+
+			poll(entry, false);
+			if (entry.state == PROGRAM_PENDING)
+				++pending;
+		}
+		return pending;
+	}
+
+	void
+	ProgramCompiler::finish()
+	{
+		for (auto& entry : entries)
+			if (entry.state == PROGRAM_PENDING)
+				poll(entry, true);
+	}
+
+	bool
+	ProgramCompiler::isParallel() const
+	{
+		return parallel;
+	}
+
+	uint32_t
+	ProgramCompiler::submit(std::vector<Stage> stages, const std::vector<const char*>& sources)
+	{
+		// every stage goes to the compiler before the first status query so the driver can run them side by side
+		for (size_t i = 0; i < stages.size(); ++i)
+		{
+			stages[i].shader = glCreateShader(stages[i].type);
+			glShaderSource(stages[i].shader, 1, &sources[i], NULL);
+			glCompileShader(stages[i].shader);
+		}
+
+		Entry entry;
+		entry.program = glCreateProgram();
+		entry.stages = std::move(stages);
+		entry.state = PROGRAM_PENDING;
+
+		// linking before the stages are known to compile is fine, a failed stage fails the link
+		for (auto& stage : entry.stages)
+			glAttachShader(entry.program, stage.shader);
+		glLinkProgram(entry.program);
+
+		entries.push_back(std::move(entry));
+		return uint32_t(entries.size() - 1);
+	}
+
+	void
+	ProgramCompiler::poll(Entry& entry, bool wait)
+	{
+		// the completion status of the program covers its stages, it's the only query that doesn't block
+		if (parallel && !wait)
+		{
+			GLint completed = GL_FALSE;
+			glGetProgramiv(entry.program, GL_COMPLETION_STATUS_KHR, &completed);
+			if (completed == GL_FALSE)
+				return;
+		}
+
+		bool compiled = true;
+		for (auto& stage : entry.stages)
+			compiled = checkShader(stage.shader, stage.type) && compiled;
+
+		// the link log only repeats the stage errors when a stage failed
+		bool linked = compiled ? checkProgram(entry.program) : isProgramLinked(entry.program);
+
+		for (auto& stage : entry.stages)
+			glDeleteShader(stage.shader);
+		entry.stages.clear();
+
+		entry.state = linked ? PROGRAM_READY : PROGRAM_FAILED;
+		if (!linked)
+		{
+			glDeleteProgram(entry.program);
+			entry.program = 0;
+		}
+	}
+} // namespace gfx
\ No newline at end of file
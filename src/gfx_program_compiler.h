@@ -0,0 +1,85 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace gfx
+{
+	// compiles and links programs without stalling the render thread, every stage and the link of a program are
+	// submitted at once and the driver works through them on its own threads when KHR_parallel_shader_compile
+	// (or the ARB version) is there, handles are polled every frame and draws using a pending program are skipped.
+	// without the extension programs finish on the first poll, the status queries then wait for the driver
+	class ProgramCompiler
+	{
+	public:
+		// needs a current context, max_threads caps the driver compiler threads, the default lets it decide
+		ProgramCompiler(uint32_t max_threads = 0xFFFFFFFF);
+
+		ProgramCompiler(const ProgramCompiler&) = delete;
+
+		ProgramCompiler&
+		operator=(const ProgramCompiler&) = delete;
+
+		~ProgramCompiler();
+
+		// returns a handle to poll, no status is queried so the call doesn't wait on the compiler
+		uint32_t
+		submit(const char* vs, const char* fs);
+
+		uint32_t
+		submit(const char* vs, const char* gs, const char* fs);
+
+		// true once the program is linked, the info logs of a failed program are printed the first time it's seen
+		bool
+		isReady(uint32_t handle);
+
+		bool
+		isFailed(uint32_t handle);
+
+		// 0 while the program is pending or when it failed
+		uint32_t
+		getProgram(uint32_t handle);
+
+		// polls every pending program, returns how many are still compiling
+		uint32_t
+		update();
+
+		// blocks until every program is done, for loading screens or before the first frame
+		void
+		finish();
+
+		bool
+		isParallel() const;
+
+	private:
+		enum Program_State
+		{
+			PROGRAM_PENDING,
+			PROGRAM_READY,
+			PROGRAM_FAILED
+		};
+
+		struct Stage
+		{
+			uint32_t shader;
+			uint32_t type;
+		};
+
+		struct Entry
+		{
+			uint32_t program;
+			std::vector<Stage> stages;
+			Program_State state;
+		};
+
+		bool parallel;
+		std::vector<Entry> entries;
+
+		uint32_t
+		submit(std::vector<Stage> stages, const std::vector<const char*>& sources);
+
+		// polls without waiting when wait is false
+		void
+		poll(Entry& entry, bool wait);
+	};
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "gfx_program_pipeline.h"
+#include "gfx_program.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+
+namespace gfx
+{
+	inline static GLbitfield
+	_stage_bit(GLenum type)
+	{
+		switch (type)
+		{
+		case GL_VERTEX_SHADER:
+			return GL_VERTEX_SHADER_BIT;
+		case GL_TESS_CONTROL_SHADER:
+			return GL_TESS_CONTROL_SHADER_BIT;
+		case GL_TESS_EVALUATION_SHADER:
+			return GL_TESS_EVALUATION_SHADER_BIT;
+		case GL_GEOMETRY_SHADER:
+			return GL_GEOMETRY_SHADER_BIT;
+		case GL_FRAGMENT_SHADER:
+			return GL_FRAGMENT_SHADER_BIT;
+		case GL_COMPUTE_SHADER:
+			return GL_COMPUTE_SHADER_BIT;
+		default:
+			return 0;
+		}
+	}
+
+	ProgramPipelines::ProgramPipelines() {}
+
+	ProgramPipelines::~ProgramPipelines()
+	{
+		for (auto& [stages, pipeline] : pipelines)
+			glDeleteProgramPipelines(1, &pipeline);
+
+		for (auto& stage : stages)
+			glDeleteProgram(stage.program);
+	}
+
+	uint32_t
+	ProgramPipelines::createStage(uint32_t type, const char* source)
+	{
+		if (_stage_bit(type) == 0)
+		{
+			std::cout << "Unknown shader stage type" << std::endl;
+			return 0;
+		}
+
+		// compiles, sets GL_PROGRAM_SEPARABLE and links in one call, the compile errors end up in the program log
+		GLuint program = glCreateShaderProgramv(type, 1, &source);
+		if (!checkProgram(program))
+		{
+			glDeleteProgram(program);
+			return 0;
+		}
+
+		stages.push_back(Stage{program, type});
+		return program;
+	}
+
+	uint32_t
+	ProgramPipelines::getPipeline(uint32_t vs, uint32_t fs)
+	{
+		return getPipeline(vs, 0, fs);
+	}
+
+	uint32_t
+	ProgramPipelines::getPipeline(uint32_t vs, uint32_t gs, uint32_t fs)
+	{
+		auto key = std::make_tuple(vs, gs, fs);
+		auto it = pipelines.find(key);
+		if (it != pipelines.end())
+			return it->second;
+
+		GLuint pipeline = 0;
+		glCreateProgramPipelines(1, &pipeline);
+
+		for (auto stage : {vs, gs, fs})
+			if (stage != 0)
+				glUseProgramStages(pipeline, stageBit(stage), stage);
+
+		// validation catches interfaces that don't line up between the stages
+		GLint valid = GL_FALSE;
+		glValidateProgramPipeline(pipeline);
+		glGetProgramPipelineiv(pipeline, GL_VALIDATE_STATUS, &valid);
+		if (valid == GL_FALSE)
+		{
+			GLint length = 0;
+			glGetProgramPipelineiv(pipeline, GL_INFO_LOG_LENGTH, &length);
+			std::string info_log(std::max(length, 1), '\0');
+			glGetProgramPipelineInfoLog(pipeline, length, NULL, &info_log[0]);
+			std::cout << "ERROR::SHADER::PIPELINE::VALIDATION_FAILED\n" << info_log.c_str() << std::endl;
+		}
+
+		pipelines[key] = pipeline;
+		return pipeline;
+	}
+
+	void
+	ProgramPipelines::bind(uint32_t pipeline)
+	{
+		glUseProgram(0);
+		glBindProgramPipeline(pipeline);
+	}
+
+	uint32_t
+	ProgramPipelines::getStageCount() const
+	{
+		return uint32_t(stages.size());
+	}
+
+	uint32_t
+	ProgramPipelines::getPipelineCount() const
+	{
+		return uint32_t(pipelines.size());
+	}
+
+	uint32_t
+	ProgramPipelines::stageBit(uint32_t program) const
+	{
+		for (auto& stage : stages)
+			if (stage.program == program)
+				return _stage_bit(stage.type);
+
+		std::cout << "Program " << program << " is not a stage created by these pipelines" << std::endl;
+		return 0;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <tuple>
+#include <vector>
+
+namespace gfx
+{
+	// separable stage programs combined into program pipeline objects, every stage is compiled and linked once and
+	// a pipeline is only created for the combinations actually drawn with, so a material x pass matrix costs
+	// materials + passes links instead of their product. uniforms are set on the stage program declaring them,
+	// vertex and geometry stages should redeclare out gl_PerVertex { vec4 gl_Position; } and the interfaces
+	// between stages have to match exactly or use explicit locations
+	class ProgramPipelines
+	{
+	public:
+		ProgramPipelines();
+
+		ProgramPipelines(const ProgramPipelines&) = delete;
+
+		ProgramPipelines&
+		operator=(const ProgramPipelines&) = delete;
+
+		~ProgramPipelines();
+
+		// type is GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER..., returns the stage program,
+		// 0 when it fails to compile
+		uint32_t
+		createStage(uint32_t type, const char* source);
+
+		// creates and validates the pipeline the first time the combination is asked for
+		uint32_t
+		getPipeline(uint32_t vs, uint32_t fs);
+
+		uint32_t
+		getPipeline(uint32_t vs, uint32_t gs, uint32_t fs);
+
+		// a program bound with glUseProgram takes precedence over the pipeline, so it's unbound first
+		void
+		bind(uint32_t pipeline);
+
+		uint32_t
+		getStageCount() const;
+
+		uint32_t
+		getPipelineCount() const;
+
+	private:
+		struct Stage
+		{
+			uint32_t program;
+			uint32_t type;
+		};
+
+		std::vector<Stage> stages;
+		std::map<std::tuple<uint32_t, uint32_t, uint32_t>, uint32_t> pipelines;
+
+		// GL_VERTEX_SHADER_BIT... of a stage program created here, 0 for anything else
+		uint32_t
+		stageBit(uint32_t program) const;
+	};
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "gfx_program_reflection.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+
+namespace gfx
+{
+	inline static std::string
+	_resource_name(GLuint program, GLenum interface, GLuint index, GLint length)
+	{
+		std::string name(std::max(length, 1), '\0');
+		glGetProgramResourceName(program, interface, index, length, nullptr, &name[0]);
+		name.resize(strlen(name.c_str()));
+
+		// arrays report their first element
+		if (name.size() > 3 && name.compare(name.size() - 3, 3, "[0]") == 0)
+			name.resize(name.size() - 3);
+		return name;
+	}
+
+	const Uniform_Info*
+	Program_Reflection::findUniform(const std::string& name) const
+	{
+		for (auto& uniform : uniforms)
+			if (uniform.name == name)
+				return &uniform;
+		return nullptr;
+	}
+
+	const Sampler_Info*
+	Program_Reflection::findSampler(const std::string& name) const
+	{
+		for (auto& sampler : samplers)
+			if (sampler.name == name)
+				return &sampler;
+		return nullptr;
+	}
+
+	const Uniform_Block_Info*
+	Program_Reflection::findBlock(const std::string& name) const
+	{
+		for (auto& block : blocks)
+			if (block.name == name)
+				return &block;
+		return nullptr;
+	}
+
+	Program_Reflection
+	reflectProgram(uint32_t program)
+	{
+		Program_Reflection reflection;
+
+		GLint count = 0;
+		glGetProgramInterfaceiv(program, GL_UNIFORM, GL_ACTIVE_RESOURCES, &count);
+
+		const GLenum uniform_props[] = {
+			GL_NAME_LENGTH,
+			GL_TYPE,
+			GL_LOCATION,
+			GL_ARRAY_SIZE,
+			GL_BLOCK_INDEX,
+			GL_OFFSET,
+			GL_ARRAY_STRIDE,
+			GL_MATRIX_STRIDE,
+		};
+		constexpr GLsizei uniform_prop_count = sizeof(uniform_props) / sizeof(uniform_props[0]);
+
+		for (GLint i = 0; i < count; ++i)
+		{
+			GLint values[uniform_prop_count];
+			glGetProgramResourceiv(
+				program,
+				GL_UNIFORM,
+				i,
+				uniform_prop_count,
+				uniform_props,
+				uniform_prop_count,
+				nullptr,
+				values);
+
+			auto name = _resource_name(program, GL_UNIFORM, i, values[0]);
+
+			if (isSamplerType(values[1]))
+			{
+				GLint unit = 0;
+				glGetUniformiv(program, values[2], &unit);
+				reflection.samplers.push_back(Sampler_Info{name, uint32_t(values[1]), values[2], unit});
+				continue;
+			}
+
+			reflection.uniforms.push_back(Uniform_Info{
+				name,
+				uint32_t(values[1]),
+				values[2],
+				values[3],
+				values[4],
+				values[5],
+				values[6],
+				values[7],
+			});
+		}
+
+		glGetProgramInterfaceiv(program, GL_UNIFORM_BLOCK, GL_ACTIVE_RESOURCES, &count);
+
+		const GLenum block_props[] = {GL_NAME_LENGTH, GL_BUFFER_BINDING, GL_BUFFER_DATA_SIZE};
+		for (GLint i = 0; i < count; ++i)
+		{
+			GLint values[3];
+			glGetProgramResourceiv(program, GL_UNIFORM_BLOCK, i, 3, block_props, 3, nullptr, values);
+
+			reflection.blocks.push_back(
+				Uniform_Block_Info{_resource_name(program, GL_UNIFORM_BLOCK, i, values[0]), i, values[1], values[2]});
+		}
+
+		return reflection;
+	}
+
+	bool
+	isSamplerType(uint32_t type)
+	{
+		switch (type)
+		{
+		case GL_SAMPLER_1D:
+		case GL_SAMPLER_2D:
+		case GL_SAMPLER_3D:
+		case GL_SAMPLER_CUBE:
+		case GL_SAMPLER_1D_SHADOW:
+		case GL_SAMPLER_2D_SHADOW:
+		case GL_SAMPLER_1D_ARRAY:
+		case GL_SAMPLER_2D_ARRAY:
+		case GL_SAMPLER_1D_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_ARRAY_SHADOW:
+		case GL_SAMPLER_2D_MULTISAMPLE:
+		case GL_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_SAMPLER_CUBE_SHADOW:
+		case GL_SAMPLER_CUBE_MAP_ARRAY:
+		case GL_SAMPLER_CUBE_MAP_ARRAY_SHADOW:
+		case GL_SAMPLER_BUFFER:
+		case GL_SAMPLER_2D_RECT:
+		case GL_SAMPLER_2D_RECT_SHADOW:
+		case GL_INT_SAMPLER_1D:
+		case GL_INT_SAMPLER_2D:
+		case GL_INT_SAMPLER_3D:
+		case GL_INT_SAMPLER_CUBE:
+		case GL_INT_SAMPLER_1D_ARRAY:
+		case GL_INT_SAMPLER_2D_ARRAY:
+		case GL_INT_SAMPLER_2D_MULTISAMPLE:
+		case GL_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_INT_SAMPLER_BUFFER:
+		case GL_INT_SAMPLER_2D_RECT:
+		case GL_UNSIGNED_INT_SAMPLER_1D:
+		case GL_UNSIGNED_INT_SAMPLER_2D:
+		case GL_UNSIGNED_INT_SAMPLER_3D:
+		case GL_UNSIGNED_INT_SAMPLER_CUBE:
+		case GL_UNSIGNED_INT_SAMPLER_1D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE:
+		case GL_UNSIGNED_INT_SAMPLER_2D_MULTISAMPLE_ARRAY:
+		case GL_UNSIGNED_INT_SAMPLER_BUFFER:
+		case GL_UNSIGNED_INT_SAMPLER_2D_RECT:
+		case GL_IMAGE_1D:
+		case GL_IMAGE_2D:
+		case GL_IMAGE_3D:
+		case GL_IMAGE_2D_ARRAY:
+		case GL_IMAGE_CUBE:
+		case GL_IMAGE_BUFFER:
+		case GL_INT_IMAGE_2D:
+		case GL_INT_IMAGE_3D:
+		case GL_UNSIGNED_INT_IMAGE_2D:
+		case GL_UNSIGNED_INT_IMAGE_3D:
+			return true;
+		default:
+			return false;
+		}
+	}
+
+	uint32_t
+	uniformTypeSize(uint32_t type)
+	{
+		switch (type)
+		{
+		case GL_FLOAT:
+		case GL_INT:
+		case GL_UNSIGNED_INT:
+		case GL_BOOL:
+			return 4;
+		case GL_FLOAT_VEC2:
+		case GL_INT_VEC2:
+		case GL_UNSIGNED_INT_VEC2:
+		case GL_BOOL_VEC2:
+			return 8;
+		case GL_FLOAT_VEC3:
+		case GL_INT_VEC3:
+		case GL_UNSIGNED_INT_VEC3:
+		case GL_BOOL_VEC3:
+			return 12;
+		case GL_FLOAT_VEC4:
+		case GL_INT_VEC4:
+		case GL_UNSIGNED_INT_VEC4:
+		case GL_BOOL_VEC4:
+		case GL_FLOAT_MAT2:
+			return 16;
+		case GL_FLOAT_MAT3:
+			return 36;
+		case GL_FLOAT_MAT4:
+			return 64;
+		default:
+			return 0;
+		}
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	// an active uniform, names of arrays lose their [0] suffix. default block uniforms have a location and
+	// block_index -1, block members have location -1 and an offset and strides inside the block
+	struct Uniform_Info
+	{
+		std::string name;
+		uint32_t type;
+		int32_t location;
+		int32_t array_size;
+		int32_t block_index;
+		int32_t offset;
+		int32_t array_stride;
+		int32_t matrix_stride;
+	};
+
+	// samplers and images are default block uniforms, unit is the texture or image unit they read from
+	struct Sampler_Info
+	{
+		std::string name;
+		uint32_t type;
+		int32_t location;
+		int32_t unit;
+	};
+
+	struct Uniform_Block_Info
+	{
+		std::string name;
+		int32_t index;
+		int32_t binding;
+		int32_t size;
+	};
+
+	struct Program_Reflection
+	{
+		std::vector<Uniform_Info> uniforms;
+		std::vector<Sampler_Info> samplers;
+		std::vector<Uniform_Block_Info> blocks;
+
+		// nullptr when the program has no such active uniform or block
+		const Uniform_Info*
+		findUniform(const std::string& name) const;
+
+		const Sampler_Info*
+		findSampler(const std::string& name) const;
+
+		const Uniform_Block_Info*
+		findBlock(const std::string& name) const;
+	};
+
+	// queries the active resources of a linked program through the program interface api, the compiler drops
+	// unused uniforms so only the ones the shaders read are listed
+	Program_Reflection
+	reflectProgram(uint32_t program);
+
+	bool
+	isSamplerType(uint32_t type);
+
+	// bytes taken by one element of a uniform of that type in a tightly packed cpu copy, 0 for opaque types
+	uint32_t
+	uniformTypeSize(uint32_t type);
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,502 @@
+#include "gfx_render_graph.h"
+#include "gfx_formats.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace gfx
+{
+	inline static GLbitfield
+	_barrier_bit(Render_Access access)
+	{
+		switch (access)
+		{
+		case ACCESS_SAMPLED:
+			return GL_TEXTURE_FETCH_BARRIER_BIT;
+		case ACCESS_ATTACHMENT:
+			return GL_FRAMEBUFFER_BARRIER_BIT;
+		case ACCESS_STORAGE_READ:
+		case ACCESS_STORAGE_WRITE:
+			return GL_SHADER_IMAGE_ACCESS_BARRIER_BIT;
+		default:
+			return 0;
+		}
+	}
+
+	RenderGraph::RenderGraph(RenderTargetPool* pool)
+		: pool(pool), culled(0), pool_texture_count(0), pool_allocation_count(0)
+	{
+	}
+
+	RenderGraph::~RenderGraph()
+	{
+		releaseFramebuffers();
+	}
+
+	void
+	RenderGraph::reset()
+	{
+		pool->beginFrame();
+
+		resources.clear();
+		passes.clear();
+		execution_order.clear();
+		culled = 0;
+	}
+
+	uint32_t
+	RenderGraph::createTarget(const std::string& name, const Render_Target_Desc& desc, const glm::vec4& clear_color)
+	{
+		Resource resource{name, Render_Target{}, clear_color, false, false, false, INVALID, INVALID, false, 0};
+		resource.target.desc = desc;
+		resources.push_back(resource);
+		return uint32_t(resources.size() - 1);
+	}
+
+	uint32_t
+	RenderGraph::importTexture(const std::string& name, uint32_t texture, const Render_Target_Desc& desc)
+	{
+		Resource resource{name, Render_Target{}, glm::vec4(0.0f), true, false, false, INVALID, INVALID, true, 0};
+		resource.target.texture = texture;
+		resource.target.desc = desc;
+		resource.target.allocated_width = desc.width;
+		resource.target.allocated_height = desc.height;
+		resources.push_back(resource);
+		return uint32_t(resources.size() - 1);
+	}
+
+	uint32_t
+	RenderGraph::importWindow(int width, int height)
+	{
+		Render_Target_Desc desc;
+		desc.width = width;
+		desc.height = height;
+
+		auto resource = importTexture("window", 0, desc);
+		resources[resource].window = true;
+		return resource;
+	}
+
+	uint32_t
+	RenderGraph::addPass(const std::string& name, std::function<void()> execute)
+	{
+		passes.push_back(Pass{name, execute, {}, false});
+		return uint32_t(passes.size() - 1);
+	}
+
+	void
+	RenderGraph::read(uint32_t pass, uint32_t resource, Render_Access access)
+	{
+		if (pass >= passes.size() || resource >= resources.size())
+		{
+			std::cout << "Render graph read of an unknown pass or resource" << std::endl;
+			return;
+		}
+
+		passes[pass].accesses.push_back(Access{resource, access, false});
+	}
+
+	void
+	RenderGraph::write(uint32_t pass, uint32_t resource, Render_Access access)
+	{
+		if (pass >= passes.size() || resource >= resources.size())
+		{
+			std::cout << "Render graph write of an unknown pass or resource" << std::endl;
+			return;
+		}
+
+		passes[pass].accesses.push_back(Access{resource, access, true});
+	}
+
+	void
+	RenderGraph::keep(uint32_t resource)
+	{
+		if (resource < resources.size())
+			resources[resource].kept = true;
+	}
+
+	void
+	RenderGraph::execute()
+	{
+		auto order = sortPasses();
+		cullPasses(order);
+
+		// lifetimes over the passes that are left, kept targets live to the end of the frame
+		uint32_t index = 0;
+		for (auto pass_index : order)
+		{
+			auto& pass = passes[pass_index];
+			if (!pass.live)
+				continue;
+
+			for (auto& access : pass.accesses)
+			{
+				auto& resource = resources[access.resource];
+				if (resource.first_use == INVALID)
+					resource.first_use = index;
+				resource.last_use = resource.kept ? INVALID - 1 : index;
+			}
+			++index;
+		}
+
+		// a texture name deleted by the pool can come back for a new texture, the cached framebuffers would still
+		// point at the old one
+		if (pool->getTextureCount() != pool_texture_count || pool->getAllocationCount() != pool_allocation_count)
+			releaseFramebuffers();
+
+		index = 0;
+		for (auto pass_index : order)
+		{
+			auto& pass = passes[pass_index];
+			if (!pass.live)
+				continue;
+
+			for (auto& access : pass.accesses)
+			{
+				auto& resource = resources[access.resource];
+				if (!resource.imported && resource.first_use == index && resource.target.texture == 0)
+					resource.target = pool->acquire(resource.target.desc);
+			}
+
+			runPass(pass);
+
+			for (auto& access : pass.accesses)
+			{
+				auto& resource = resources[access.resource];
+				if (!resource.imported && resource.last_use == index && resource.target.texture != 0)
+					pool->release(resource.target);
+			}
+
+			execution_order.push_back(pass.name);
+			++index;
+		}
+
+		pool_texture_count = pool->getTextureCount();
+		pool_allocation_count = pool->getAllocationCount();
+
+		// kept and imported targets are read after the frame by code the graph doesn't see
+		GLbitfield barriers = 0;
+		for (auto& resource : resources)
+		{
+			if (resource.kept || resource.imported)
+				barriers |= resource.pending_barriers;
+			resource.pending_barriers = 0;
+		}
+
+		if (barriers != 0)
+			glMemoryBarrier(barriers);
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+	}
+
+	const Render_Target&
+	RenderGraph::getTarget(uint32_t resource) const
+	{
+		static const Render_Target empty;
+		if (resource >= resources.size())
+			return empty;
+
+		return resources[resource].target;
+	}
+
+	uint32_t
+	RenderGraph::getTexture(uint32_t resource) const
+	{
+		return getTarget(resource).texture;
+	}
+
+	uint32_t
+	RenderGraph::getPassCount() const
+	{
+		return uint32_t(passes.size());
+	}
+
+	uint32_t
+	RenderGraph::getCulledPassCount() const
+	{
+		return culled;
+	}
+
+	const std::vector<std::string>&
+	RenderGraph::getExecutionOrder() const
+	{
+		return execution_order;
+	}
+
+	std::vector<uint32_t>
+	RenderGraph::sortPasses()
+	{
+		auto count = passes.size();
+		std::vector<std::vector<uint32_t>> edges(count);
+		std::vector<uint32_t> incoming(count, 0);
+
+		auto add_edge = [&](uint32_t from, uint32_t to) {
+			if (from == to || std::find(edges[from].begin(), edges[from].end(), to) != edges[from].end())
+				return;
+			edges[from].push_back(to);
+			++incoming[to];
+		};
+
+		for (uint32_t r = 0; r < resources.size(); ++r)
+		{
+			std::vector<uint32_t> writers;
+			for (uint32_t p = 0; p < count; ++p)
+				for (auto& access : passes[p].accesses)
+					if (access.resource == r && access.write)
+					{
+						writers.push_back(p);
+						break;
+					}
+
+			// writes land in the order they're added
+			for (size_t i = 1; i < writers.size(); ++i)
+				add_edge(writers[i - 1], writers[i]);
+
+			for (uint32_t p = 0; p < count; ++p)
+			{
+				bool reads = false;
+				for (auto& access : passes[p].accesses)
+					reads |= access.resource == r && !access.write;
+				if (!reads)
+					continue;
+
+				// a read sees the last write added before it and has to happen before the next one, with no write
+				// before it the pass reads what the later passes produce
+				auto next = std::upper_bound(writers.begin(), writers.end(), p);
+				if (next != writers.begin())
+				{
+					add_edge(*(next - 1), p);
+					if (next != writers.end())
+						add_edge(p, *next);
+				}
+				else
+				{
+					for (auto writer : writers)
+						add_edge(writer, p);
+				}
+			}
+		}
+
+		// kahn's algorithm, picking the earliest added pass that's ready keeps the order stable
+		std::vector<uint32_t> order;
+		std::vector<uint32_t> ready;
+		for (uint32_t p = 0; p < count; ++p)
+			if (incoming[p] == 0)
+				ready.push_back(p);
+
+		while (!ready.empty())
+		{
+			auto it = std::min_element(ready.begin(), ready.end());
+			auto p = *it;
+			ready.erase(it);
+			order.push_back(p);
+
+			for (auto next : edges[p])
+				if (--incoming[next] == 0)
+					ready.push_back(next);
+		}
+
+		if (order.size() != count)
+		{
+			std::cout << "Render graph has a dependency cycle, passes run in the order they were added" << std::endl;
+			order.resize(count);
+			for (uint32_t p = 0; p < count; ++p)
+				order[p] = p;
+		}
+
+		return order;
+	}
+
+	void
+	RenderGraph::cullPasses(const std::vector<uint32_t>& order)
+	{
+		std::vector<bool> needed(resources.size(), false);
+		for (size_t r = 0; r < resources.size(); ++r)
+			needed[r] = resources[r].imported || resources[r].kept;
+
+		// walking back from the outputs, a pass is needed if it writes something needed and then everything it
+		// touches is needed too, attachments it writes included since it may load what earlier passes left
+		culled = 0;
+		for (auto it = order.rbegin(); it != order.rend(); ++it)
+		{
+			auto& pass = passes[*it];
+
+			pass.live = false;
+			for (auto& access : pass.accesses)
+				pass.live |= access.write && needed[access.resource];
+
+			if (!pass.live)
+			{
+				++culled;
+				continue;
+			}
+
+			for (auto& access : pass.accesses)
+				needed[access.resource] = true;
+		}
+	}
+
+	void
+	RenderGraph::runPass(Pass& pass)
+	{
+		// storage writes have to be made visible to the kind of access that comes next
+		GLbitfield barriers = 0;
+		for (auto& access : pass.accesses)
+		{
+			auto& resource = resources[access.resource];
+			auto bit = _barrier_bit(access.access);
+			if (resource.pending_barriers & bit)
+			{
+				barriers |= bit;
+				resource.pending_barriers &= ~bit;
+			}
+		}
+
+		if (barriers != 0)
+			glMemoryBarrier(barriers);
+
+		bindAttachments(pass);
+
+		if (pass.execute)
+			pass.execute();
+
+		for (auto& access : pass.accesses)
+		{
+			if (!access.write)
+				continue;
+
+			// any first write counts, an attachment write after a storage write must not clear what it wrote
+			auto& resource = resources[access.resource];
+			resource.cleared = true;
+
+			if (access.access == ACCESS_STORAGE_WRITE)
+				resource.pending_barriers = _barrier_bit(ACCESS_SAMPLED) | _barrier_bit(ACCESS_ATTACHMENT) |
+											_barrier_bit(ACCESS_STORAGE_READ);
+		}
+	}
+
+	void
+	RenderGraph::bindAttachments(Pass& pass)
+	{
+		std::vector<uint32_t> colors;
+		uint32_t depth = INVALID;
+		uint32_t window = INVALID;
+
+		for (auto& access : pass.accesses)
+		{
+			if (!access.write || access.access != ACCESS_ATTACHMENT)
+				continue;
+
+			auto& resource = resources[access.resource];
+			if (resource.window)
+				window = access.resource;
+			else if (resource.target.desc.depth_format != NO_DEPTH)
+				depth = access.resource;
+			else if (std::find(colors.begin(), colors.end(), access.resource) == colors.end())
+				colors.push_back(access.resource);
+		}
+
+		// passes with no attachments like compute ones keep whatever is bound
+		if (window == INVALID && colors.empty() && depth == INVALID)
+			return;
+
+		if (window != INVALID)
+		{
+			if (!colors.empty() || depth != INVALID)
+				std::cout << "Render pass " << pass.name << " writes the window along with other targets" << std::endl;
+
+			auto& desc = resources[window].target.desc;
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, desc.width, desc.height);
+			return;
+		}
+
+		std::vector<uint32_t> attachments;
+		for (auto color : colors)
+			attachments.push_back(resources[color].target.texture);
+		if (depth != INVALID)
+			attachments.push_back(resources[depth].target.texture);
+
+		auto& framebuffer = framebuffers[attachments];
+		if (framebuffer == 0)
+		{
+			glCreateFramebuffers(1, &framebuffer);
+
+			std::vector<GLenum> draw_buffers;
+			for (size_t i = 0; i < colors.size(); ++i)
+			{
+				glNamedFramebufferTexture(framebuffer, GLenum(GL_COLOR_ATTACHMENT0 + i), attachments[i], 0);
+				draw_buffers.push_back(GLenum(GL_COLOR_ATTACHMENT0 + i));
+			}
+
+			if (depth != INVALID)
+			{
+				auto depth_format = resources[depth].target.desc.depth_format;
+				auto attachment = hasStencil(depth_format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+				glNamedFramebufferTexture(framebuffer, attachment, attachments.back(), 0);
+			}
+
+			if (draw_buffers.empty())
+				glNamedFramebufferDrawBuffer(framebuffer, GL_NONE);
+			else
+				glNamedFramebufferDrawBuffers(framebuffer, GLsizei(draw_buffers.size()), draw_buffers.data());
+
+			if (glCheckNamedFramebufferStatus(framebuffer, GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+				std::cout << "Render pass " << pass.name << " framebuffer is not complete!" << std::endl;
+		}
+
+		glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+
+		// every attachment has the same size, the first one sets the viewport
+		auto& desc = resources[colors.empty() ? depth : colors[0]].target.desc;
+		glViewport(0, 0, desc.width, desc.height);
+
+		// transient targets hold garbage until their first write clears them
+		for (size_t i = 0; i < colors.size(); ++i)
+		{
+			auto& resource = resources[colors[i]];
+			if (resource.cleared)
+				continue;
+
+			if (isIntegerFormat(resource.target.desc.format))
+			{
+				auto& color = resource.clear_color;
+				GLuint value[4] = {GLuint(color.r), GLuint(color.g), GLuint(color.b), GLuint(color.a)};
+				glClearBufferuiv(GL_COLOR, GLint(i), value);
+			}
+			else
+			{
+				glClearBufferfv(GL_COLOR, GLint(i), &resource.clear_color[0]);
+			}
+			resource.cleared = true;
+		}
+
+		if (depth != INVALID && !resources[depth].cleared)
+		{
+			// clears follow the depth write mask, the pass gets back the mask it had
+			GLboolean depth_mask = GL_TRUE;
+			glGetBooleanv(GL_DEPTH_WRITEMASK, &depth_mask);
+			glDepthMask(GL_TRUE);
+
+			auto& resource = resources[depth];
+			float clear_depth = 1.0f;
+			if (hasStencil(resource.target.desc.depth_format))
+				glClearBufferfi(GL_DEPTH_STENCIL, 0, clear_depth, 0);
+			else
+				glClearBufferfv(GL_DEPTH, 0, &clear_depth);
+			resource.cleared = true;
+
+			glDepthMask(depth_mask);
+		}
+	}
+
+	void
+	RenderGraph::releaseFramebuffers()
+	{
+		for (auto& [attachments, framebuffer] : framebuffers)
+			glDeleteFramebuffers(1, &framebuffer);
+		framebuffers.clear();
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "gfx_render_target_pool.h"
+
+#include <glm/glm.hpp>
+
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace gfx
+{
+	enum Render_Access
+	{
+		// read with a sampler
+		ACCESS_SAMPLED,
+		// color or depth attachment of the pass framebuffer
+		ACCESS_ATTACHMENT,
+		// image load and store, glBindImageTexture is left to the pass
+		ACCESS_STORAGE_READ,
+		ACCESS_STORAGE_WRITE,
+	};
+
+	// a frame described as passes and the targets they read and write, rebuilt every frame. execute orders the
+	// passes so every target is written before it's read, culls the passes nothing needed reads from, acquires the
+	// transient targets from the pool right before their first use and releases them right after their last so
+	// targets that don't overlap in time share memory, binds the framebuffer with the viewport of the targets,
+	// clears transient targets on their first write and issues the glMemoryBarrier storage writes need
+	class RenderGraph
+	{
+	public:
+		static constexpr uint32_t INVALID = 0xFFFFFFFF;
+
+		RenderGraph(RenderTargetPool* pool);
+
+		RenderGraph(const RenderGraph&) = delete;
+
+		RenderGraph&
+		operator=(const RenderGraph&) = delete;
+
+		~RenderGraph();
+
+		// drops last frame passes and targets and starts a new frame in the pool
+		void
+		reset();
+
+		// transient target, its content only lives through the frame. it's cleared to clear_color when its first
+		// write binds it as an attachment, depth targets to 1, a first storage write leaves it to the pass
+		uint32_t
+		createTarget(const std::string& name, const Render_Target_Desc& desc, const glm::vec4& clear_color = {});
+
+		// texture owned by someone else, passes writing to it are never culled. desc says how it's attached, a
+		// depth_format other than NO_DEPTH makes it the depth attachment
+		uint32_t
+		importTexture(const std::string& name, uint32_t texture, const Render_Target_Desc& desc);
+
+		// the window framebuffer, passes writing to it are never culled
+		uint32_t
+		importWindow(int width, int height);
+
+		// passes run in the order they're added unless a read needs a later pass to run first
+		uint32_t
+		addPass(const std::string& name, std::function<void()> execute);
+
+		void
+		read(uint32_t pass, uint32_t resource, Render_Access access = ACCESS_SAMPLED);
+
+		// attachments are bound in the order they're written, a depth target goes to the depth attachment
+		void
+		write(uint32_t pass, uint32_t resource, Render_Access access = ACCESS_ATTACHMENT);
+
+		// keeps the passes producing the target and the target itself until the next reset
+		void
+		keep(uint32_t resource);
+
+		void
+		execute();
+
+		// valid while the pass using the target runs, or after execute for kept targets
+		const Render_Target&
+		getTarget(uint32_t resource) const;
+
+		uint32_t
+		getTexture(uint32_t resource) const;
+
+		uint32_t
+		getPassCount() const;
+
+		uint32_t
+		getCulledPassCount() const;
+
+		// pass names in the order they ran
+		const std::vector<std::string>&
+		getExecutionOrder() const;
+
+	private:
+		struct Resource
+		{
+			std::string name;
+			Render_Target target;
+			glm::vec4 clear_color;
+			bool imported, window, kept;
+			uint32_t first_use, last_use;
+			bool cleared;
+			// storage writes not yet made visible to each kind of access
+			uint32_t pending_barriers;
+		};
+
+		struct Access
+		{
+			uint32_t resource;
+			Render_Access access;
+			bool write;
+		};
+
+		struct Pass
+		{
+			std::string name;
+			std::function<void()> execute;
+			std::vector<Access> accesses;
+			bool live;
+		};
+
+		RenderTargetPool* pool;
+		std::vector<Resource> resources;
+		std::vector<Pass> passes;
+		std::vector<std::string> execution_order;
+		uint32_t culled;
+
+		// framebuffers of the attachment combinations, flushed when the pool textures change
+		std::map<std::vector<uint32_t>, uint32_t> framebuffers;
+		uint32_t pool_texture_count, pool_allocation_count;
+
+		std::vector<uint32_t>
+		sortPasses();
+
+		void
+		cullPasses(const std::vector<uint32_t>& order);
+
+		void
+		runPass(Pass& pass);
+
+		void
+		bindAttachments(Pass& pass);
+
+		void
+		releaseFramebuffers();
+	};
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,247 @@
+#include "gfx_render_target_pool.h"
+#include "gfx_formats.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <iostream>
+
+namespace gfx
+{
+	inline static int
+	_round_up(int size, int granularity)
+	{
+		granularity = std::max(granularity, 1);
+		return (size + granularity - 1) / granularity * granularity;
+	}
+
+	inline static size_t
+	_target_size(const Render_Target& target)
+	{
+		// what the pixels take once uploaded, drivers may pad some formats
+		auto& desc = target.desc;
+		auto pixel_size = textureFormatPixelSize(desc.format);
+		if (desc.depth_format != NO_DEPTH)
+			pixel_size = depthFormatPixelSize(desc.depth_format);
+		return size_t(target.allocated_width) * target.allocated_height * pixel_size * std::max(desc.samples, 1);
+	}
+
+	glm::vec2
+	Render_Target::getUVScale() const
+	{
+		if (allocated_width == 0 || allocated_height == 0)
+			return glm::vec2(1.0f);
+
+		return glm::vec2(float(desc.width) / allocated_width, float(desc.height) / allocated_height);
+	}
+
+	RenderTargetPool::RenderTargetPool(const Render_Target_Pool_Settings& settings)
+		: settings(settings), frame(0), allocations(0)
+	{
+	}
+
+	RenderTargetPool::~RenderTargetPool()
+	{
+		for (auto& entry : entries)
+			destroy(entry);
+	}
+
+	void
+	RenderTargetPool::beginFrame()
+	{
+		++frame;
+
+		for (auto& entry : entries)
+			entry.in_use = false;
+
+		for (auto& entry : entries)
+			if (frame - entry.last_used_frame > settings.max_unused_frames)
+				destroy(entry);
+
+		compact();
+	}
+
+	Render_Target
+	RenderTargetPool::acquire(const Render_Target_Desc& desc)
+	{
+		if (desc.width <= 0 || desc.height <= 0 || (desc.depth_format == NO_DEPTH && isCompressedFormat(desc.format)))
+		{
+			std::cout << "Unsupported render target size or format" << std::endl;
+			return Render_Target{};
+		}
+
+		auto wanted_width = _round_up(desc.width, settings.granularity);
+		auto wanted_height = _round_up(desc.height, settings.granularity);
+		auto max_area = double(wanted_width) * wanted_height * std::max(settings.max_waste, 1.0f);
+
+		// the smallest free texture of the same kind that covers the request
+		Entry* best = nullptr;
+		for (auto& entry : entries)
+		{
+			auto& target = entry.target;
+			if (entry.in_use || target.desc.samples != desc.samples || target.desc.depth_format != desc.depth_format)
+				continue;
+
+			// depth targets don't use the color format
+			if (desc.depth_format == NO_DEPTH && target.desc.format != desc.format)
+				continue;
+
+			if (target.allocated_width < desc.width || target.allocated_height < desc.height)
+				continue;
+
+			auto area = double(target.allocated_width) * target.allocated_height;
+			if (area > max_area)
+				continue;
+
+			if (best == nullptr || area < double(best->target.allocated_width) * best->target.allocated_height)
+				best = &entry;
+		}
+
+		if (best == nullptr)
+		{
+			auto allocated = desc;
+			allocated.width = wanted_width;
+			allocated.height = wanted_height;
+
+			auto target = create(allocated);
+			if (target.texture == 0)
+				return target;
+
+			entries.push_back(Entry{target, false, frame});
+			best = &entries.back();
+		}
+
+		best->in_use = true;
+		best->last_used_frame = frame;
+		best->target.desc = desc;
+		return best->target;
+	}
+
+	void
+	RenderTargetPool::release(const Render_Target& target)
+	{
+		for (auto& entry : entries)
+		{
+			if (entry.target.texture == target.texture)
+			{
+				entry.in_use = false;
+				return;
+			}
+		}
+	}
+
+	void
+	RenderTargetPool::bind(const Render_Target& target)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+		glViewport(0, 0, target.desc.width, target.desc.height);
+	}
+
+	void
+	RenderTargetPool::unbind(int width, int height)
+	{
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+		glViewport(0, 0, width, height);
+	}
+
+	void
+	RenderTargetPool::trim()
+	{
+		for (auto& entry : entries)
+			if (!entry.in_use)
+				destroy(entry);
+
+		compact();
+	}
+
+	uint32_t
+	RenderTargetPool::getTextureCount() const
+	{
+		return uint32_t(entries.size());
+	}
+
+	uint32_t
+	RenderTargetPool::getAllocationCount() const
+	{
+		return allocations;
+	}
+
+	size_t
+	RenderTargetPool::getMemorySize() const
+	{
+		size_t size = 0;
+		for (auto& entry : entries)
+			size += _target_size(entry.target);
+		return size;
+	}
+
+	Render_Target
+	RenderTargetPool::create(const Render_Target_Desc& desc)
+	{
+		Render_Target target;
+		target.desc = desc;
+		target.allocated_width = desc.width;
+		target.allocated_height = desc.height;
+
+		bool depth = desc.depth_format != NO_DEPTH;
+		auto internal_format = depth ? depthInternalFormat(desc.depth_format) : textureInternalFormat(desc.format);
+		GLenum texture_target = desc.samples > 1 ? GL_TEXTURE_2D_MULTISAMPLE : GL_TEXTURE_2D;
+
+		glGenTextures(1, &target.texture);
+		glBindTexture(texture_target, target.texture);
+
+		// immutable storage, the texture never changes size, a different size is a different texture
+		if (desc.samples > 1)
+		{
+			glTexStorage2DMultisample(texture_target, desc.samples, internal_format, desc.width, desc.height, GL_TRUE);
+		}
+		else
+		{
+			glTexStorage2D(texture_target, 1, internal_format, desc.width, desc.height);
+			auto filter = !depth && isIntegerFormat(desc.format) ? GL_NEAREST : GL_LINEAR;
+			glTexParameteri(texture_target, GL_TEXTURE_MIN_FILTER, filter);
+			glTexParameteri(texture_target, GL_TEXTURE_MAG_FILTER, filter);
+			glTexParameteri(texture_target, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+			glTexParameteri(texture_target, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		}
+		glBindTexture(texture_target, 0);
+
+		glGenFramebuffers(1, &target.framebuffer);
+		glBindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+		if (depth)
+		{
+			auto attachment = hasStencil(desc.depth_format) ? GL_DEPTH_STENCIL_ATTACHMENT : GL_DEPTH_ATTACHMENT;
+			glFramebufferTexture(GL_FRAMEBUFFER, attachment, target.texture, 0);
+			glDrawBuffer(GL_NONE);
+			glReadBuffer(GL_NONE);
+		}
+		else
+		{
+			glFramebufferTexture(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, target.texture, 0);
+		}
+
+		if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+			std::cout << "Render target framebuffer is not complete!" << std::endl;
+
+		glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+		++allocations;
+		return target;
+	}
+
+	void
+	RenderTargetPool::compact()
+	{
+		auto destroyed = [](const Entry& entry) { return entry.target.texture == 0; };
+		entries.erase(std::remove_if(entries.begin(), entries.end(), destroyed), entries.end());
+	}
+
+	void
+	RenderTargetPool::destroy(Entry& entry)
+	{
+		glDeleteFramebuffers(1, &entry.target.framebuffer);
+		glDeleteTextures(1, &entry.target.texture);
+		entry.target.framebuffer = 0;
+		entry.target.texture = 0;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+
+#include "enums.h"
+
+#include <glm/glm.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace gfx
+{
+	// a depth target when depth_format is set, format is ignored then
+	struct Render_Target_Desc
+	{
+		Texture_Format format = RGBA8;
+		int width = 0;
+		int height = 0;
+		int samples = 1;
+		Depth_Format depth_format = NO_DEPTH;
+	};
+
+	// a pooled texture, width and height are the requested size to set the viewport to, the texture itself can be
+	// larger so sample it with uv * getUVScale()
+	struct Render_Target
+	{
+		uint32_t texture = 0;
+		uint32_t framebuffer = 0;
+		Render_Target_Desc desc;
+		int allocated_width = 0;
+		int allocated_height = 0;
+
+		glm::vec2
+		getUVScale() const;
+	};
+
+	struct Render_Target_Pool_Settings
+	{
+		// sizes are rounded up to a multiple of granularity so small window resizes keep the same textures
+		int granularity = 64;
+
+		// a free texture is reused for a smaller request while it wastes less than this factor of memory
+		float max_waste = 2.0f;
+
+		// free textures not acquired for this many frames are deleted
+		uint32_t max_unused_frames = 3;
+	};
+
+	// transient render targets keyed by format, size and samples. targets live for one frame, the ones still held
+	// at the next beginFrame go back to the pool, and a target released mid frame is handed to the next matching
+	// acquire so passes that don't overlap in time share the same memory
+	class RenderTargetPool
+	{
+	public:
+		RenderTargetPool(const Render_Target_Pool_Settings& settings = {});
+
+		RenderTargetPool(const RenderTargetPool&) = delete;
+
+		RenderTargetPool&
+		operator=(const RenderTargetPool&) = delete;
+
+		~RenderTargetPool();
+
+		// returns every target to the pool and deletes the ones unused for too long
+		void
+		beginFrame();
+
+		// free texture that fits or a new one, texture is 0 for compressed formats or empty sizes
+		Render_Target
+		acquire(const Render_Target_Desc& desc);
+
+		void
+		release(const Render_Target& target);
+
+		// binds the target framebuffer and sets the viewport to the requested size
+		void
+		bind(const Render_Target& target);
+
+		// back to the window framebuffer with a viewport of its size
+		void
+		unbind(int width, int height);
+
+		// deletes every free texture
+		void
+		trim();
+
+		uint32_t
+		getTextureCount() const;
+
+		// textures created since the pool was made, stays flat once the frames reach a steady state
+		uint32_t
+		getAllocationCount() const;
+
+		size_t
+		getMemorySize() const;
+
+	private:
+		struct Entry
+		{
+			Render_Target target;
+			bool in_use;
+			uint64_t last_used_frame;
+		};
+
+		Render_Target_Pool_Settings settings;
+		std::vector<Entry> entries;
+		uint64_t frame;
+		uint32_t allocations;
+
+		Render_Target
+		create(const Render_Target_Desc& desc);
+
+		// drops the destroyed entries
+		void
+		compact();
+
+		void
+		destroy(Entry& entry);
+	};
+} // namespace gfx
\ No newline at end of file
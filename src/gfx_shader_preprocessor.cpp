@@ -0,0 +1,429 @@
+#include "gfx_shader_preprocessor.h"
+#include "gfx_hash.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+
+namespace gfx
+{
+	// clang-format off
+	static const char* SHADER_LIBRARY[][2] = {
+		{"gfx/hash.glsl", R"(#pragma once
+
+float hash(float n)
+{
+	return fract(sin(n) * 43758.5453123);
+}
+)"},
+		{"gfx/noise.glsl", R"(#pragma once
+#include "hash.glsl"
+
+// trilinear value noise in [0, 1]
+float noise(vec3 x)
+{
+	vec3 f = fract(x);
+	float n = dot(floor(x), vec3(1.0, 157.0, 113.0));
+	return mix(mix(mix(hash(n +   0.0), hash(n +   1.0), f.x),
+				   mix(hash(n + 157.0), hash(n + 158.0), f.x), f.y),
+			   mix(mix(hash(n + 113.0), hash(n + 114.0), f.x),
+				   mix(hash(n + 270.0), hash(n + 271.0), f.x), f.y), f.z);
+}
+)"},
+		{"gfx/fbm.glsl", R"(#pragma once
+#include "noise.glsl"
+
+// fractional brownian motion, every octave is rotated so the lattice of the noise doesn't line up
+float fbm(vec3 p)
+{
+	const mat3 m = mat3(0.0, 1.60,  1.20, -1.6, 0.72, -0.96, -1.2, -0.96, 1.28);
+	float f = 0.0;
+	f += noise(p) / 2; p = m * p * 1.1;
+	f += noise(p) / 4; p = m * p * 1.2;
+	f += noise(p) / 6; p = m * p * 1.3;
+	f += noise(p) / 12; p = m * p * 1.4;
+	f += noise(p) / 24;
+	return f;
+}
+)"},
+		{"gfx/tonemapping.glsl", R"(#pragma once
+
+vec3 Uncharted2ToneMapping(vec3 color)
+{
+	float A = 0.15;
+	float B = 0.50;
+	float C = 0.10;
+	float D = 0.20;
+	float E = 0.02;
+	float F = 0.30;
+	float W = 11.2;
+	float exposure = 2.;
+	color *= exposure;
+	color = ((color * (A * color + C * B) + D * E) / (color * (A * color + B) + D * F)) - E / F;
+	float white = ((W * (A * W + C * B) + D * E) / (W * (A * W + B) + D * F)) - E / F;
+	color /= white;
+	return color;
+}
+)"},
+		{"gfx/checker.glsl", R"(#pragma once
+
+// checker pattern with the square edges smoothed over a hundredth of a square
+vec4 checker(vec2 uv, float scale, vec3 color1, vec3 color2)
+{
+	vec2 pos = uv * scale;
+	float checker = step(0.5, mod(floor(pos.x) + floor(pos.y), 2.0));
+
+	float edge_distance = min(abs(fract(pos.x)), abs(fract(pos.y)));
+	float smoothing = smoothstep(0.0, 0.01, edge_distance);
+
+	return vec4(mix(color1, color2, mix(checker, 1.0 - checker, smoothing)), 1.0);
+}
+)"},
+		{"gfx/shadow.glsl", R"(#pragma once
+
+// percentage closer filtering over 3x3 texels, frag_pos_light_space is the clip space position seen from the light,
+// returns 1 when fully in shadow and 0 past the far plane of the light
+float shadowPCF(sampler2D shadow_map, vec4 frag_pos_light_space, float bias)
+{
+	vec3 coords = frag_pos_light_space.xyz / frag_pos_light_space.w * 0.5 + 0.5;
+	if (coords.z > 1.0)
+		return 0.0;
+
+	float shadow = 0.0;
+	vec2 texel_size = 1.0 / textureSize(shadow_map, 0);
+	for (int x = -1; x <= 1; ++x)
+		for (int y = -1; y <= 1; ++y)
+			shadow += coords.z - bias > texture(shadow_map, coords.xy + vec2(x, y) * texel_size).r ? 1.0 : 0.0;
+	return shadow / 9.0;
+}
+
+// slope scaled bias, grows as the surface turns away from the light
+float shadowBias(vec3 normal, vec3 light_dir, float max_bias, float min_bias)
+{
+	return max(max_bias * (1.0 - dot(normal, light_dir)), min_bias);
+}
+)"},
+		{"gfx/tessellation.glsl", R"(#pragma once
+
+// level for the edge between two view space points, the edge is measured through its bounding sphere and only
+// depends on its end points so the patches sharing it agree on the level
+float edgeTessLevel(vec3 p0, vec3 p1, mat4 projection, float viewport_height, float edge_pixels, float max_level)
+{
+	vec3 center = (p0 + p1) * 0.5;
+	float radius = length(p1 - p0) * 0.5;
+	float size = radius * projection[1][1] * viewport_height / max(-center.z, 1e-4);
+	return clamp(size / edge_pixels, 1.0, max_level);
+}
+
+// level falling linearly from max_level at near to 1 at far
+float distanceTessLevel(float distance, float near, float far, float max_level)
+{
+	return mix(max_level, 1.0, clamp((distance - near) / (far - near), 0.0, 1.0));
+}
+)"},
+		{"gfx/msaa.glsl", R"(#pragma once
+
+// averages the samples of an hdr color weighted by 1 / (1 + luminance), a box resolve lets a single very bright
+// sample saturate the whole pixel once tonemapped and brings the aliasing back
+vec4 resolveHDR(sampler2DMS color, ivec2 coord, int samples)
+{
+	vec4 sum = vec4(0.0);
+	float weight_sum = 0.0;
+	for (int i = 0; i < samples; ++i)
+	{
+		vec4 sample_color = texelFetch(color, coord, i);
+		float weight = 1.0 / (1.0 + dot(sample_color.rgb, vec3(0.2126, 0.7152, 0.0722)));
+		sum += sample_color * weight;
+		weight_sum += weight;
+	}
+	return sum / weight_sum;
+}
+)"},
+	};
+	// clang-format on
+
+	// source string numbers come from a hash of the file name so the output, and the program cache keys made
+	// from it, don't depend on the order the shaders were processed in. they stay below 10^9 for the drivers
+	// that read them as int, 0 is left to sources without a name
+	constexpr uint32_t FILE_ID_RANGE = 999999999;
+
+	// shared by every preprocessor so any compile log can be mapped back
+	static std::mutex file_names_mutex;
+	static std::unordered_map<uint32_t, std::string> file_names;
+
+	inline static uint32_t
+	_file_id(const std::string& name)
+	{
+		if (name.empty())
+			return 0;
+
+		auto id = uint32_t(hash64(name) % FILE_ID_RANGE) + 1;
+
+		std::lock_guard<std::mutex> lock(file_names_mutex);
+		file_names.emplace(id, name);
+		return id;
+	}
+
+	inline static bool
+	_starts_with_directive(const std::string& line, size_t& at, const char* directive)
+	{
+		auto i = line.find_first_not_of(" \t");
+		if (i == std::string::npos || line[i] != '#')
+			return false;
+
+		i = line.find_first_not_of(" \t", i + 1);
+		auto length = strlen(directive);
+		if (i == std::string::npos || line.compare(i, length, directive) != 0)
+			return false;
+
+		at = i + length;
+		return true;
+	}
+
+	inline static std::string
+	_normalize(const std::string& name)
+	{
+		return std::filesystem::path(name).lexically_normal().generic_string();
+	}
+
+	ShaderPreprocessor::ShaderPreprocessor() : hits(0), misses(0)
+	{
+		for (auto& file : SHADER_LIBRARY)
+			files[file[0]] = file[1];
+	}
+
+	void
+	ShaderPreprocessor::addFile(const std::string& name, const std::string& source)
+	{
+		files[_normalize(name)] = source;
+		cache.clear();
+	}
+
+	void
+	ShaderPreprocessor::addIncludeDirectory(const std::string& directory)
+	{
+		include_directories.push_back(directory);
+		cache.clear();
+	}
+
+	bool
+	ShaderPreprocessor::hasFile(const std::string& name) const
+	{
+		return files.find(_normalize(name)) != files.end();
+	}
+
+	const std::string&
+	ShaderPreprocessor::process(const char* source, const std::vector<std::string>& defines, const std::string& name)
+	{
+		auto key = hash64(source, strlen(source));
+		for (auto& define : defines)
+			key = hashCombine(key, hash64(define));
+		key = hashCombine(key, hash64(name));
+
+		auto it = cache.find(key);
+		if (it != cache.end())
+		{
+			++hits;
+			return it->second;
+		}
+
+		++misses;
+
+		std::string out;
+		std::vector<std::string> stack;
+		std::unordered_set<std::string> included_once;
+		expand(source, name, &defines, stack, included_once, out);
+
+		return cache[key] = std::move(out);
+	}
+
+	uint32_t
+	ShaderPreprocessor::getHits() const
+	{
+		return hits;
+	}
+
+	uint32_t
+	ShaderPreprocessor::getMisses() const
+	{
+		return misses;
+	}
+
+	const std::string*
+	ShaderPreprocessor::findFile(const std::string& include, const std::string& parent, std::string& resolved)
+	{
+		std::vector<std::string> candidates;
+		if (!parent.empty())
+			candidates.push_back(_normalize((std::filesystem::path(parent).parent_path() / include).string()));
+		candidates.push_back(_normalize(include));
+
+		for (auto& candidate : candidates)
+		{
+			auto it = files.find(candidate);
+			if (it != files.end())
+			{
+				resolved = candidate;
+				return &it->second;
+			}
+		}
+
+		for (auto& candidate : candidates)
+		{
+			for (auto& directory : include_directories)
+			{
+				std::ifstream file(std::filesystem::path(directory) / candidate);
+				if (!file)
+					continue;
+
+				std::stringstream buffer;
+				buffer << file.rdbuf();
+				resolved = candidate;
+				return &(files[candidate] = buffer.str());
+			}
+		}
+
+		return nullptr;
+	}
+
+	void
+	ShaderPreprocessor::expand(
+		const std::string& source,
+		const std::string& name,
+		const std::vector<std::string>* defines,
+		std::vector<std::string>& stack,
+		std::unordered_set<std::string>& included_once,
+		std::string& out)
+	{
+		auto id = std::to_string(_file_id(name));
+
+		// without a #version line the defines go first, #version has to stay the first directive otherwise
+		if (defines && source.find("#version") == std::string::npos && (!defines->empty() || id != "0"))
+		{
+			for (auto& define : *defines)
+				out += "#define " + define + "\n";
+			out += "#line 1 " + id + "\n";
+		}
+
+		stack.push_back(name);
+
+		std::istringstream lines(source);
+		std::string line;
+		size_t at = 0;
+		for (size_t number = 1; std::getline(lines, line); ++number)
+		{
+			auto next_line = "#line " + std::to_string(number + 1) + " " + id + "\n";
+
+			if (_starts_with_directive(line, at, "version"))
+			{
+				// included files are pasted after the #version of the source, theirs would break the compile
+				if (stack.size() > 1)
+				{
+					out += "\n";
+					continue;
+				}
+
+				out += line + "\n";
+				if (defines)
+					for (auto& define : *defines)
+						out += "#define " + define + "\n";
+				out += next_line;
+				continue;
+			}
+
+			if (_starts_with_directive(line, at, "pragma") && line.find("once", at) != std::string::npos)
+			{
+				included_once.insert(name);
+				out += "\n";
+				continue;
+			}
+
+			if (!_starts_with_directive(line, at, "include"))
+			{
+				out += line + "\n";
+				continue;
+			}
+
+			auto open = line.find_first_of("\"<", at);
+			auto close = open == std::string::npos ? open : line.find_first_of("\">", open + 1);
+			if (close == std::string::npos)
+			{
+				std::cout << "Malformed shader include in " << (name.empty() ? "source" : name) << ":" << number
+						  << std::endl;
+				out += "#error malformed #include\n";
+				continue;
+			}
+
+			auto include = line.substr(open + 1, close - open - 1);
+			std::string resolved;
+			auto file = findFile(include, name, resolved);
+
+			// an #error keeps the failure in the compile log at the line of the include
+			if (file == nullptr)
+			{
+				std::cout << "Cannot find shader include " << include << std::endl;
+				out += "#error cannot find include " + include + "\n";
+				continue;
+			}
+
+			if (std::find(stack.begin(), stack.end(), resolved) != stack.end())
+			{
+				std::cout << "Recursive shader include " << resolved << std::endl;
+				out += "#error recursive include " + resolved + "\n";
+				continue;
+			}
+
+			if (included_once.count(resolved))
+			{
+				out += "\n";
+				continue;
+			}
+
+			out += "#line 1 " + std::to_string(_file_id(resolved)) + "\n";
+			expand(*file, resolved, nullptr, stack, included_once, out);
+			out += next_line;
+		}
+
+		stack.pop_back();
+	}
+
+	std::string
+	mapShaderLog(const std::string& log)
+	{
+		std::lock_guard<std::mutex> lock(file_names_mutex);
+		if (file_names.empty())
+			return log;
+
+		std::string result;
+		std::istringstream lines(log);
+		std::string line;
+		while (std::getline(lines, line))
+		{
+			// mesa prints 3:12(5), nvidia 3(12) and the others ERROR: 3:12 where 3 is the source string number
+			size_t at = 0;
+			for (auto prefix : {"ERROR: ", "WARNING: "})
+				if (line.compare(0, strlen(prefix), prefix) == 0)
+					at = strlen(prefix);
+
+			auto end = at;
+			while (end < line.size() && end - at < 9 && isdigit((unsigned char)line[end]))
+				++end;
+
+			if (end > at && end + 1 < line.size() && (line[end] == ':' || line[end] == '(') &&
+				isdigit((unsigned char)line[end + 1]))
+			{
+				auto file = file_names.find(uint32_t(std::stoul(line.substr(at, end - at))));
+				if (file != file_names.end())
+					line = line.substr(0, at) + file->second + line.substr(end);
+			}
+
+			result += line + "\n";
+		}
+
+		return result;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace gfx
+{
+	// expands #include "name" (or <name>) against a virtual file system before the source reaches the driver,
+	// included files can use #pragma once. a shared library is registered under gfx/:
+	// gfx/hash.glsl: float hash(float n)
+	// gfx/noise.glsl: float noise(vec3 x), value noise built on hash
+	// gfx/fbm.glsl: float fbm(vec3 p), 5 octaves of noise
+	// gfx/tonemapping.glsl: vec3 Uncharted2ToneMapping(vec3 color)
+	// gfx/checker.glsl: vec4 checker(vec2 uv, float scale, vec3 color1, vec3 color2)
+	// gfx/shadow.glsl: float shadowPCF(sampler2D shadow_map, vec4 frag_pos_light_space, float bias) and
+	// float shadowBias(vec3 normal, vec3 light_dir, float max_bias, float min_bias)
+	// gfx/tessellation.glsl: float edgeTessLevel(vec3 p0, vec3 p1, mat4 projection, float viewport_height,
+	// float edge_pixels, float max_level) and
+	// float distanceTessLevel(float distance, float near, float far, float max_level)
+	// gfx/msaa.glsl: vec4 resolveHDR(sampler2DMS color, ivec2 coord, int samples)
+	// every file gets a source string number hashed from its name in the #line directives, the compile errors
+	// printed by checkShader name the file and the line inside it
+	class ShaderPreprocessor
+	{
+	public:
+		ShaderPreprocessor();
+
+		// adds or replaces a file, the names are relative paths like "lighting/pbr.glsl"
+		void
+		addFile(const std::string& name, const std::string& source);
+
+		// includes missing from the virtual file system are looked up in these directories and kept once read
+		void
+		addIncludeDirectory(const std::string& directory);
+
+		bool
+		hasFile(const std::string& name) const;
+
+		// defines are NAME or NAME VALUE and go after the #version line, name is what compile errors report for
+		// the source itself. the output is cached by a hash of the inputs, the reference stays valid until a file
+		// is added or replaced
+		const std::string&
+		process(const char* source, const std::vector<std::string>& defines = {}, const std::string& name = "");
+
+		uint32_t
+		getHits() const;
+
+		uint32_t
+		getMisses() const;
+
+	private:
+		std::unordered_map<std::string, std::string> files;
+		std::vector<std::string> include_directories;
+		std::unordered_map<uint64_t, std::string> cache;
+		uint32_t hits, misses;
+
+		// resolves relative to the including file first then from the root, nullptr when it can't be found
+		const std::string*
+		findFile(const std::string& include, const std::string& parent, std::string& resolved);
+
+		void
+		expand(
+			const std::string& source,
+			const std::string& name,
+			const std::vector<std::string>* defines,
+			std::vector<std::string>& stack,
+			std::unordered_set<std::string>& included_once,
+			std::string& out);
+	};
+
+	// swaps the source string numbers of a compiler log for the file names the preprocessor gave them
+	std::string
+	mapShaderLog(const std::string& log);
+} // namespace gfx
\ No newline at end of file
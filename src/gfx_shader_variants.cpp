@@ -0,0 +1,182 @@
+#include "gfx_shader_variants.h"
+#include "gfx_program.h"
+#include "gfx_program_cache.h"
+#include "gfx_program_compiler.h"
+#include "gfx_shader_preprocessor.h"
+
+#include <GL/glew.h>
+
+#include <iostream>
+
+namespace gfx
+{
+	ShaderVariants::ShaderVariants(
+		const char* vs,
+		const char* fs,
+		const std::vector<std::string>& features,
+		ProgramCache* cache,
+		ShaderPreprocessor* preprocessor)
+		: sources{vs, fs},
+		  types{GL_VERTEX_SHADER, GL_FRAGMENT_SHADER},
+		  features(features),
+		  cache(cache),
+		  preprocessor(preprocessor)
+	{
+		if (features.size() > 32)
+			std::cout << "Shader variants support at most 32 features, the rest are ignored" << std::endl;
+	}
+
+	ShaderVariants::ShaderVariants(
+		const char* vs,
+		const char* gs,
+		const char* fs,
+		const std::vector<std::string>& features,
+		ProgramCache* cache,
+		ShaderPreprocessor* preprocessor)
+		: sources{vs, gs, fs},
+		  types{GL_VERTEX_SHADER, GL_GEOMETRY_SHADER, GL_FRAGMENT_SHADER},
+		  features(features),
+		  cache(cache),
+		  preprocessor(preprocessor)
+	{
+		if (features.size() > 32)
+			std::cout << "Shader variants support at most 32 features, the rest are ignored" << std::endl;
+	}
+
+	ShaderVariants::~ShaderVariants()
+	{
+		for (auto& [mask, program] : programs)
+			if (program != 0)
+				glDeleteProgram(program);
+	}
+
+	uint32_t
+	ShaderVariants::getFeatureBit(const std::string& feature) const
+	{
+		for (size_t i = 0; i < features.size() && i < 32; ++i)
+			if (features[i] == feature)
+				return 1u << i;
+
+		std::cout << "Unknown shader feature " << feature << std::endl;
+		return 0;
+	}
+
+	uint32_t
+	ShaderVariants::getMask(const std::vector<std::string>& features) const
+	{
+		uint32_t mask = 0;
+		for (auto& feature : features)
+			mask |= getFeatureBit(feature);
+		return mask;
+	}
+
+	uint32_t
+	ShaderVariants::getProgram(uint32_t mask)
+	{
+		auto it = programs.find(mask);
+		if (it != programs.end())
+			return it->second;
+
+		uint32_t program = 0;
+		if (cache)
+		{
+			// with a preprocessor the defines are already in the expanded sources
+			auto stage_sources = preprocessor ? getStageSources(mask) : sources;
+			auto defines = preprocessor ? std::vector<std::string>{} : getDefines(mask);
+			if (types.size() == 3)
+				program = cache->createGPUProgram(
+					stage_sources[0].c_str(),
+					stage_sources[1].c_str(),
+					stage_sources[2].c_str(),
+					defines);
+			else
+				program = cache->createGPUProgram(stage_sources[0].c_str(), stage_sources[1].c_str(), defines);
+		}
+		else
+		{
+			auto stage_sources = getStageSources(mask);
+			std::vector<uint32_t> shaders;
+			for (size_t i = 0; i < types.size(); ++i)
+				shaders.push_back(compileShader(types[i], stage_sources[i].c_str()));
+			program = linkProgram(shaders);
+		}
+
+		// failed variants are kept too so a broken permutation isn't compiled again every frame
+		programs[mask] = program;
+		return program;
+	}
+
+	void
+	ShaderVariants::warmUp(const std::vector<uint32_t>& masks)
+	{
+		// the cache compiles one program at a time, its warm runs only load binaries anyway
+		if (cache)
+		{
+			for (auto mask : masks)
+				getProgram(mask);
+			return;
+		}
+
+		ProgramCompiler compiler;
+		std::vector<std::pair<uint32_t, uint32_t>> handles;
+		for (auto mask : masks)
+		{
+			if (hasVariant(mask))
+				continue;
+
+			auto stage_sources = getStageSources(mask);
+			uint32_t handle = 0;
+			if (types.size() == 3)
+				handle = compiler.submit(stage_sources[0].c_str(), stage_sources[1].c_str(), stage_sources[2].c_str());
+			else
+				handle = compiler.submit(stage_sources[0].c_str(), stage_sources[1].c_str());
+
+			// the same mask twice in the list is submitted once
+			programs[mask] = 0;
+			handles.push_back({mask, handle});
+		}
+
+		compiler.finish();
+
+		for (auto& [mask, handle] : handles)
+			programs[mask] = compiler.getProgram(handle);
+	}
+
+	bool
+	ShaderVariants::hasVariant(uint32_t mask) const
+	{
+		return programs.find(mask) != programs.end();
+	}
+
+	size_t
+	ShaderVariants::getVariantCount() const
+	{
+		return programs.size();
+	}
+
+	std::vector<std::string>
+	ShaderVariants::getDefines(uint32_t mask) const
+	{
+		std::vector<std::string> defines;
+		for (size_t i = 0; i < features.size() && i < 32; ++i)
+			if (mask & (1u << i))
+				defines.push_back(features[i]);
+		return defines;
+	}
+
+	std::vector<std::string>
+	ShaderVariants::getStageSources(uint32_t mask)
+	{
+		auto defines = getDefines(mask);
+
+		std::vector<std::string> stage_sources;
+		for (auto& source : sources)
+		{
+			if (preprocessor)
+				stage_sources.push_back(preprocessor->process(source.c_str(), defines));
+			else
+				stage_sources.push_back(injectDefines(source.c_str(), defines));
+		}
+		return stage_sources;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gfx
+{
+	class ProgramCache;
+	class ShaderPreprocessor;
+
+	// one program source compiled into a variant per combination of feature keywords, so shaders test
+	// #ifdef FEATURE instead of branching on uniforms. bit i of a variant mask defines features[i], variants are
+	// compiled the first time they're asked for and kept until the ShaderVariants goes away
+	class ShaderVariants
+	{
+	public:
+		// at most 32 features, the cache keeps the linked variants on disk and the preprocessor resolves
+		// includes, both are optional and have to outlive the variants. the cache shouldn't have a preprocessor
+		// of its own when one is given here
+		ShaderVariants(
+			const char* vs,
+			const char* fs,
+			const std::vector<std::string>& features,
+			ProgramCache* cache = nullptr,
+			ShaderPreprocessor* preprocessor = nullptr);
+
+		ShaderVariants(
+			const char* vs,
+			const char* gs,
+			const char* fs,
+			const std::vector<std::string>& features,
+			ProgramCache* cache = nullptr,
+			ShaderPreprocessor* preprocessor = nullptr);
+
+		ShaderVariants(const ShaderVariants&) = delete;
+
+		ShaderVariants&
+		operator=(const ShaderVariants&) = delete;
+
+		~ShaderVariants();
+
+		// bit of the feature, 0 for a name that wasn't declared
+		uint32_t
+		getFeatureBit(const std::string& feature) const;
+
+		uint32_t
+		getMask(const std::vector<std::string>& features) const;
+
+		// compiles the variant on first use, select it per draw then bind it
+		uint32_t
+		getProgram(uint32_t mask);
+
+		// compiles the variants ahead of time, for loading screens, without a cache every stage is submitted
+		// before waiting on any of them so parallel shader compile can spread them over the driver threads
+		void
+		warmUp(const std::vector<uint32_t>& masks);
+
+		bool
+		hasVariant(uint32_t mask) const;
+
+		size_t
+		getVariantCount() const;
+
+	private:
+		std::vector<std::string> sources;
+		std::vector<uint32_t> types;
+		std::vector<std::string> features;
+		ProgramCache* cache;
+		ShaderPreprocessor* preprocessor;
+		std::unordered_map<uint32_t, uint32_t> programs;
+
+		std::vector<std::string>
+		getDefines(uint32_t mask) const;
+
+		std::vector<std::string>
+		getStageSources(uint32_t mask);
+	};
+} // namespace gfx
\ No newline at end of file
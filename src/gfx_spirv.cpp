@@ -0,0 +1,108 @@
+#include "gfx_spirv.h"
+#include "gfx_program.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+
+namespace gfx
+{
+	constexpr uint32_t SPIRV_MAGIC = 0x07230203;
+	constexpr uint32_t SPIRV_HEADER_WORDS = 5;
+	constexpr uint32_t SPIRV_OP_DECORATE = 71;
+	constexpr uint32_t SPIRV_DECORATION_SPEC_ID = 1;
+
+	// walks the instructions for OpDecorate SpecId, glSpecializeShader fails on ids the module doesn't have
+	inline static std::vector<uint32_t>
+	_spec_ids(const std::vector<uint32_t>& code)
+	{
+		std::vector<uint32_t> ids;
+		for (size_t i = SPIRV_HEADER_WORDS; i < code.size();)
+		{
+			uint32_t word_count = code[i] >> 16;
+			uint32_t opcode = code[i] & 0xFFFF;
+			if (word_count == 0 || i + word_count > code.size())
+				break;
+
+			if (opcode == SPIRV_OP_DECORATE && word_count >= 4 && code[i + 2] == SPIRV_DECORATION_SPEC_ID)
+				ids.push_back(code[i + 3]);
+
+			i += word_count;
+		}
+		return ids;
+	}
+
+	bool
+	isSpirvSupported()
+	{
+		return GLEW_VERSION_4_6 || GLEW_ARB_gl_spirv;
+	}
+
+	std::vector<uint32_t>
+	loadSpirv(const char* file_name)
+	{
+		std::ifstream file(file_name, std::ios::binary | std::ios::ate);
+		if (!file)
+		{
+			std::cout << "Cannot open SPIR-V module " << file_name << std::endl;
+			return {};
+		}
+
+		auto size = size_t(file.tellg());
+		if (size < SPIRV_HEADER_WORDS * sizeof(uint32_t) || size % sizeof(uint32_t) != 0)
+		{
+			std::cout << "Invalid SPIR-V module " << file_name << std::endl;
+			return {};
+		}
+
+		std::vector<uint32_t> code(size / sizeof(uint32_t));
+		file.seekg(0);
+		file.read((char*)code.data(), size);
+
+		if (!file || code[0] != SPIRV_MAGIC)
+		{
+			std::cout << "Invalid SPIR-V module " << file_name << std::endl;
+			return {};
+		}
+
+		return code;
+	}
+
+	uint32_t
+	compileSpirvShader(
+		uint32_t type,
+		const std::vector<uint32_t>& code,
+		const std::vector<Specialization_Constant>& constants,
+		const char* entry_point)
+	{
+		GLuint shader = glCreateShader(type);
+		glShaderBinary(
+			1,
+			&shader,
+			GL_SHADER_BINARY_FORMAT_SPIR_V_ARB,
+			code.data(),
+			GLsizei(code.size() * sizeof(uint32_t)));
+
+		auto declared = _spec_ids(code);
+		std::vector<GLuint> indices, values;
+		for (auto& constant : constants)
+		{
+			if (std::find(declared.begin(), declared.end(), constant.id) == declared.end())
+				continue;
+
+			indices.push_back(constant.id);
+			values.push_back(constant.value);
+		}
+
+		if (GLEW_VERSION_4_6)
+			glSpecializeShader(shader, entry_point, GLuint(indices.size()), indices.data(), values.data());
+		else
+			glSpecializeShaderARB(shader, entry_point, GLuint(indices.size()), indices.data(), values.data());
+
+		// specialization takes the place of the compile, it sets the same status and info log
+		checkShader(shader, type);
+		return shader;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace gfx
+{
+	// value of a layout(constant_id = id) constant, bools are 0 or 1 and floats are passed by their bits
+	struct Specialization_Constant
+	{
+		uint32_t id;
+		uint32_t value;
+	};
+
+	// needs a current context, true with ARB_gl_spirv or GL 4.6
+	bool
+	isSpirvSupported();
+
+	// reads a module built by the offline shader tool, empty when the file can't be read or isn't spir-v
+	std::vector<uint32_t>
+	loadSpirv(const char* file_name);
+
+	// hands the module to glShaderBinary and specializes it, only the constants the module declares are passed
+	// on so one list can cover every stage of a program, prints the info log when specialization fails
+	uint32_t
+	compileSpirvShader(
+		uint32_t type,
+		const std::vector<uint32_t>& code,
+		const std::vector<Specialization_Constant>& constants = {},
+		const char* entry_point = "main");
+} // namespace gfx
\ No newline at end of file
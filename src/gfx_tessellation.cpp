@@ -0,0 +1,69 @@
+#include "gfx_tessellation.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+
+namespace gfx
+{
+	inline static float
+	_clamp_level(float level, const Tessellation_Settings& settings)
+	{
+		return std::clamp(level, settings.min_level, settings.max_level);
+	}
+
+	int
+	maxTessellationLevel()
+	{
+		GLint level = 64;
+		glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &level);
+		return level;
+	}
+
+	float
+	projectedSize(const glm::vec3& view_center, float radius, const glm::mat4& projection, float viewport_height)
+	{
+		// the camera looks down -z, projection[1][1] is 1 / tan(fov / 2)
+		float depth = std::max(-view_center.z, 1e-4f);
+		return radius * projection[1][1] * viewport_height / depth;
+	}
+
+	float
+	edgeTessellationLevel(
+		const glm::vec3& view_p0,
+		const glm::vec3& view_p1,
+		const glm::mat4& projection,
+		float viewport_height,
+		const Tessellation_Settings& settings)
+	{
+		auto center = (view_p0 + view_p1) * 0.5f;
+		float radius = glm::length(view_p1 - view_p0) * 0.5f;
+		float size = projectedSize(center, radius, projection, viewport_height);
+		return _clamp_level(size / settings.edge_pixels, settings);
+	}
+
+	float
+	objectTessellationLevel(
+		const glm::vec3& center,
+		float radius,
+		float control_edge,
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		float viewport_height,
+		const Tessellation_Settings& settings)
+	{
+		auto view_center = glm::vec3(view * glm::vec4(center, 1.0f));
+
+		// the nearest point of the bounds sets the level
+		view_center.z = std::min(view_center.z + radius, -1e-4f);
+		float edge = projectedSize(view_center, control_edge * 0.5f, projection, viewport_height);
+		return _clamp_level(edge / settings.edge_pixels, settings);
+	}
+
+	float
+	distanceTessellationLevel(float distance, float near, float far, const Tessellation_Settings& settings)
+	{
+		float t = far > near ? std::clamp((distance - near) / (far - near), 0.0f, 1.0f) : 0.0f;
+		return _clamp_level(settings.max_level + (settings.min_level - settings.max_level) * t, settings);
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+namespace gfx
+{
+	// tessellation levels driven by the size things take on screen, edge_pixels is the length in pixels the
+	// generated edges aim for so near surfaces get dense and far ones drop to a handful of triangles. the same
+	// functions are in the gfx/tessellation.glsl shader library for the control stages, computing the level of
+	// an edge from its two end points alone keeps neighbouring patches agreeing on it so no cracks open
+	struct Tessellation_Settings
+	{
+		float edge_pixels = 12.0f;
+		float min_level = 1.0f;
+		float max_level = 64.0f;
+	};
+
+	// GL_MAX_TESS_GEN_LEVEL, 64 is the minimum any implementation supports
+	int
+	maxTessellationLevel();
+
+	// pixels covered by the diameter of a sphere of view space center, for a perspective projection
+	float
+	projectedSize(const glm::vec3& view_center, float radius, const glm::mat4& projection, float viewport_height);
+
+	// level for an edge between two view space points, the edge is measured through its bounding sphere so the
+	// level doesn't change as the edge turns relative to the camera
+	float
+	edgeTessellationLevel(
+		const glm::vec3& view_p0,
+		const glm::vec3& view_p1,
+		const glm::mat4& projection,
+		float viewport_height,
+		const Tessellation_Settings& settings = {});
+
+	// level for a whole object from its world space bounds, with control_edge the length of the control mesh edges,
+	// a per object uniform or a pick between pre tessellated meshes
+	float
+	objectTessellationLevel(
+		const glm::vec3& center,
+		float radius,
+		float control_edge,
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		float viewport_height,
+		const Tessellation_Settings& settings = {});
+
+	// level falling linearly from max_level at near to min_level at far, when screen size isn't what matters
+	float
+	distanceTessellationLevel(float distance, float near, float far, const Tessellation_Settings& settings = {});
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "gfx_texture_cache.h"
+#include "gfx.h"
+#include "gfx_formats.h"
+#include "gfx_hash.h"
+#include "gfx_mapped_file.h"
+
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <vector>
+
+namespace gfx
+{
+	// bump when the file layout or the conversion changes
+	constexpr uint32_t CACHE_VERSION = 1;
+
+	// level data starts on page boundaries so it can be read straight from the mapping
+	constexpr uint64_t CACHE_ALIGNMENT = 4096;
+
+	constexpr uint32_t CACHE_MAX_LEVELS = 32;
+
+	struct Cache_Level
+	{
+		uint64_t offset;
+		uint64_t size;
+		uint32_t width;
+		uint32_t height;
+	};
+
+	struct Cache_Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint64_t key;
+		uint32_t internal_format;
+		uint32_t pixel_format;
+		uint32_t pixel_type;
+		uint32_t compressed;
+		uint32_t levels_count;
+		uint32_t padding;
+		Cache_Level levels[CACHE_MAX_LEVELS];
+	};
+
+	inline static uint64_t
+	_align(uint64_t value)
+	{
+		return (value + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+	}
+
+	inline static Texture_Format
+	_compressed_format(uint32_t ncomponents)
+	{
+		if (ncomponents == 1)
+			return BC4;
+		else if (ncomponents == 2)
+			return BC5;
+
+		return BC7;
+	}
+
+	TextureCache::TextureCache(const std::string& directory) : directory(directory), hits(0), misses(0)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(directory, error);
+		if (error)
+			std::cout << "Cannot create texture cache directory " << directory << std::endl;
+	}
+
+	TextureCache::~TextureCache() {}
+
+	uint32_t
+	TextureCache::loadTexture2D(
+		GFX* gfx,
+		const char* file_name,
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps,
+		bool compress)
+	{
+		GLuint id = -1;
+
+		MappedFile source(file_name);
+		if (source.isOpen() == false)
+		{
+			std::cout << "Cannot open texture file " << file_name << std::endl;
+			return id;
+		}
+
+		auto key = hash64(source.getData(), source.getSize());
+		key = hashCombine(key, CACHE_VERSION);
+		key = hashCombine(key, enable_mipmaps);
+		key = hashCombine(key, compress);
+		source.close();
+
+		auto path = (std::filesystem::path(directory) / (hashToString(key) + ".gfxtex")).string();
+
+		id = loadCached(path, key);
+		if (id != -1)
+		{
+			++hits;
+		}
+		else
+		{
+			++misses;
+			id = createCached(gfx, file_name, path, key, enable_mipmaps, compress);
+			if (id == -1)
+				return id;
+		}
+
+		glBindTexture(GL_TEXTURE_2D, id);
+
+		auto res = wrappingMode(wrap_mode);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, res);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, res);
+
+		auto minifying = filteringMode(minifying_mode);
+		auto magnifying = filteringMode(magnifying_mode);
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, minifying);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, magnifying);
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		return id;
+	}
+
+	uint32_t
+	TextureCache::getHits() const
+	{
+		return hits;
+	}
+
+	uint32_t
+	TextureCache::getMisses() const
+	{
+		return misses;
+	}
+
+	uint32_t
+	TextureCache::loadCached(const std::string& path, uint64_t key)
+	{
+		GLuint id = -1;
+
+		MappedFile file(path.c_str());
+		if (file.isOpen() == false || file.getSize() < sizeof(Cache_Header))
+			return id;
+
+		Cache_Header header;
+		memcpy(&header, file.getData(), sizeof(header));
+
+		if (memcmp(header.magic, "GFXT", 4) != 0 || header.version != CACHE_VERSION || header.key != key ||
+			header.levels_count == 0 || header.levels_count > CACHE_MAX_LEVELS)
+			return id;
+
+		for (uint32_t i = 0; i < header.levels_count; ++i)
+		{
+			if (header.levels[i].offset + header.levels[i].size > file.getSize())
+			{
+				std::cout << "Truncated texture cache file " << path << std::endl;
+				return id;
+			}
+		}
+
+		file.prefetch(0, file.getSize());
+
+		glGenTextures(1, &id);
+		glBindTexture(GL_TEXTURE_2D, id);
+
+		glTexStorage2D(
+			GL_TEXTURE_2D,
+			header.levels_count,
+			header.internal_format,
+			header.levels[0].width,
+			header.levels[0].height);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (uint32_t i = 0; i < header.levels_count; ++i)
+		{
+			auto& level = header.levels[i];
+			auto data = file.getData() + level.offset;
+
+			if (header.compressed)
+			{
+				glCompressedTexSubImage2D(
+					GL_TEXTURE_2D,
+					i,
+					0,
+					0,
+					level.width,
+					level.height,
+					header.internal_format,
+					(GLsizei)level.size,
+					data);
+			}
+			else
+			{
+				glTexSubImage2D(
+					GL_TEXTURE_2D,
+					i,
+					0,
+					0,
+					level.width,
+					level.height,
+					header.pixel_format,
+					header.pixel_type,
+					data);
+			}
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		return id;
+	}
+
+	uint32_t
+	TextureCache::createCached(
+		GFX* gfx,
+		const char* file_name,
+		const std::string& path,
+		uint64_t key,
+		bool enable_mipmaps,
+		bool compress)
+	{
+		GLuint id = -1;
+
+		Image img(file_name);
+		if (!img.getData())
+		{
+			std::cout << "Empty image check image file" << std::endl;
+			return id;
+		}
+
+		// mips are generated on the uncompressed texture, compressed formats can't be rendered to
+		id = gfx->createTexture2D(img.view(), REPEAT, LINEAR, LINEAR, enable_mipmaps);
+		if (id == -1)
+			return id;
+
+		if (compress)
+		{
+			auto format = _compressed_format(img.get_NCompnents());
+			auto pixel_format = pixelFormat(img.get_NCompnents());
+			auto levels = enable_mipmaps ? mipLevelsCount(img.getWidth(), img.getHeight()) : 1;
+
+			GLuint compressed = -1;
+			glGenTextures(1, &compressed);
+			glBindTexture(GL_TEXTURE_2D, compressed);
+			glTexStorage2D(
+				GL_TEXTURE_2D,
+				levels,
+				textureInternalFormat(format),
+				img.getWidth(),
+				img.getHeight());
+
+			// the driver compresses each level on upload, which core profiles don't have to support. errors left
+			// from before are dropped so only the uploads are checked
+			while (glGetError() != GL_NO_ERROR)
+				;
+
+			bool uploaded = true;
+			std::vector<unsigned char> level_data;
+			glPixelStorei(GL_PACK_ALIGNMENT, 1);
+			glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+			for (uint32_t i = 0; i < levels && uploaded; ++i)
+			{
+				auto width = std::max(1u, img.getWidth() >> i);
+				auto height = std::max(1u, img.getHeight() >> i);
+				level_data.resize(size_t(width) * height * img.get_NCompnents());
+
+				glBindTexture(GL_TEXTURE_2D, id);
+				glGetTexImage(GL_TEXTURE_2D, i, pixel_format, GL_UNSIGNED_BYTE, level_data.data());
+
+				glBindTexture(GL_TEXTURE_2D, compressed);
+				glTexSubImage2D(GL_TEXTURE_2D, i, 0, 0, width, height, pixel_format, GL_UNSIGNED_BYTE, level_data.data());
+				uploaded = glGetError() == GL_NO_ERROR;
+			}
+
+			glBindTexture(GL_TEXTURE_2D, 0);
+
+			// the cache file records the chain uncompressed then, warm loads don't try again
+			if (uploaded)
+			{
+				glDeleteTextures(1, &id);
+				id = compressed;
+			}
+			else
+			{
+				std::cout << "Driver cannot compress " << file_name << ", caching it uncompressed" << std::endl;
+				glDeleteTextures(1, &compressed);
+				compress = false;
+			}
+		}
+
+		store(path, key, id, img.get_NCompnents(), compress);
+
+		return id;
+	}
+
+	void
+	TextureCache::store(const std::string& path, uint64_t key, uint32_t texture, uint32_t ncomponents, bool compressed)
+	{
+		Cache_Header header;
+		memset(&header, 0, sizeof(header));
+		memcpy(header.magic, "GFXT", 4);
+		header.version = CACHE_VERSION;
+		header.key = key;
+		header.pixel_format = pixelFormat(ncomponents);
+		header.pixel_type = GL_UNSIGNED_BYTE;
+		header.compressed = compressed;
+
+		glBindTexture(GL_TEXTURE_2D, texture);
+
+		GLint internal_format = 0, levels = 0;
+		glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &internal_format);
+		glGetTexParameteriv(GL_TEXTURE_2D, GL_TEXTURE_IMMUTABLE_LEVELS, &levels);
+
+		header.internal_format = internal_format;
+		header.levels_count = std::min((uint32_t)levels, CACHE_MAX_LEVELS);
+
+		// read back the whole chain first to lay the levels out on aligned offsets
+		std::vector<std::vector<unsigned char>> levels_data(header.levels_count);
+		uint64_t offset = _align(sizeof(Cache_Header));
+
+		glPixelStorei(GL_PACK_ALIGNMENT, 1);
+		for (uint32_t i = 0; i < header.levels_count; ++i)
+		{
+			GLint width = 0, height = 0, size = 0;
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_WIDTH, &width);
+			glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_HEIGHT, &height);
+
+			if (compressed)
+			{
+				glGetTexLevelParameteriv(GL_TEXTURE_2D, i, GL_TEXTURE_COMPRESSED_IMAGE_SIZE, &size);
+				levels_data[i].resize(size);
+				glGetCompressedTexImage(GL_TEXTURE_2D, i, levels_data[i].data());
+			}
+			else
+			{
+				size = width * height * ncomponents;
+				levels_data[i].resize(size);
+				glGetTexImage(GL_TEXTURE_2D, i, header.pixel_format, GL_UNSIGNED_BYTE, levels_data[i].data());
+			}
+
+			header.levels[i] = Cache_Level{offset, (uint64_t)size, (uint32_t)width, (uint32_t)height};
+			offset = _align(offset + size);
+		}
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		std::vector<File_Chunk> chunks{{0, &header, sizeof(header)}};
+		for (uint32_t i = 0; i < header.levels_count; ++i)
+			chunks.push_back(File_Chunk{header.levels[i].offset, levels_data[i].data(), levels_data[i].size()});
+
+		// the tail is padded so the last level is fully inside a page of the file
+		if (!writeFileAtomically(path, chunks, offset))
+			std::cout << "Cannot write texture cache file " << path << std::endl;
+	}
+} // namespace gfx
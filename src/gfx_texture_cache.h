@@ -0,0 +1,56 @@
+#pragma once
+
+#include "enums.h"
+
+#include <string>
+
+namespace gfx
+{
+	class GFX;
+
+	// on-disk cache of GPU-ready mip chains keyed by the source file content and the conversion parameters,
+	// warm loads map the cache file and upload it directly without decoding or generating mips
+	class TextureCache
+	{
+	public:
+		TextureCache(const std::string& directory);
+
+		~TextureCache();
+
+		// compress stores the mip chain block compressed (BC4 for R, BC5 for RG, BC7 for RGB and RGBA)
+		uint32_t
+		loadTexture2D(
+			GFX* gfx,
+			const char* file_name,
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps,
+			bool compress = false);
+
+		uint32_t
+		getHits() const;
+
+		uint32_t
+		getMisses() const;
+
+	private:
+		std::string directory;
+		uint32_t hits, misses;
+
+		uint32_t
+		loadCached(const std::string& path, uint64_t key);
+
+		uint32_t
+		createCached(
+			GFX* gfx,
+			const char* file_name,
+			const std::string& path,
+			uint64_t key,
+			bool enable_mipmaps,
+			bool compress);
+
+		void
+		store(const std::string& path, uint64_t key, uint32_t texture, uint32_t ncomponents, bool compressed);
+	};
+} // namespace gfx
@@ -0,0 +1,615 @@
+#include "gfx_volume_file.h"
+#include "gfx_formats.h"
+#include "gfx_lz.h"
+#include "gfx_mapped_file.h"
+#include "gfx_parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace gfx
+{
+	// bump when the file layout or the brick encoding changes
+	constexpr uint32_t VOLUME_VERSION = 1;
+
+	constexpr uint32_t VOLUME_MAX_CHANNELS = 4;
+
+	// residuals are bit packed in groups of this many values, each group starts with its bit width
+	constexpr size_t VOLUME_PACK_GROUP = 32;
+
+	enum Brick_Encoding : uint32_t
+	{
+		BRICK_LZ,
+		// packed residuals kept as is when lz doesn't make them smaller
+		BRICK_PACKED,
+		// every channel holds a single value, nothing is stored
+		BRICK_CONSTANT
+	};
+
+	struct Volume_File_Header
+	{
+		char magic[4];
+		uint32_t version;
+		uint32_t width;
+		uint32_t height;
+		uint32_t depth;
+		uint32_t format;
+		uint32_t brick_size;
+		uint32_t quantization_bits;
+		uint32_t brick_count;
+		uint32_t padding;
+	};
+
+	// a channel value is bias + quantized * scale
+	struct Volume_File_Brick
+	{
+		uint64_t offset;
+		uint32_t size;
+		uint32_t packed_size;
+		uint32_t encoding;
+		uint32_t padding;
+		float scale[VOLUME_MAX_CHANNELS];
+		float bias[VOLUME_MAX_CHANNELS];
+	};
+
+	inline static void
+	_quantize_range(float min_value, float max_value, int bits, size_t component_size, float& scale, float& bias)
+	{
+		bias = min_value;
+		scale = (max_value - min_value) / float((1u << bits) - 1);
+
+		// 8 bit channels never need steps finer than the format so they round trip exactly
+		if (component_size == 1 && max_value > min_value)
+			scale = std::max(scale, 1.0f / 255.0f);
+	}
+
+	// median edge detector from LOCO-I, picks the left or the upper neighbour across edges and the plane through
+	// the three neighbours elsewhere
+	inline static uint32_t
+	_med(uint32_t a, uint32_t b, uint32_t c)
+	{
+		auto low = std::min(a, b);
+		auto high = std::max(a, b);
+		return c >= high ? low : (c <= low ? high : a + b - c);
+	}
+
+	// replaces the quantized values of a brick channel with their zigzagged prediction residuals, the residuals
+	// wrap around the quantization range so small ones of either sign use few bits
+	inline static void
+	_encode_residuals(const uint32_t* q, const glm::ivec3& extent, int bits, uint32_t* residuals)
+	{
+		uint32_t levels = (1u << bits) - 1;
+		uint32_t half = levels >> 1;
+		auto zigzag = [&](uint32_t value, uint32_t prediction) {
+			uint32_t residual = (value - prediction) & levels;
+			return residual <= half ? residual << 1 : (((levels + 1) - residual) << 1) - 1;
+		};
+
+		size_t i = 0;
+		for (int z = 0; z < extent.z; ++z)
+		{
+			for (int y = 0; y < extent.y; ++y)
+			{
+				// the first voxel of a slice is predicted from the slice below, the first row and column from
+				// their single neighbour
+				if (y == 0)
+					residuals[i] = zigzag(q[i], z > 0 ? q[i - size_t(extent.x) * extent.y] : 0);
+				else
+					residuals[i] = zigzag(q[i], q[i - extent.x]);
+				++i;
+
+				for (int x = 1; x < extent.x; ++x, ++i)
+				{
+					auto prediction = y == 0 ? q[i - 1] : _med(q[i - 1], q[i - extent.x], q[i - extent.x - 1]);
+					residuals[i] = zigzag(q[i], prediction);
+				}
+			}
+		}
+	}
+
+	// inverse of _encode_residuals, done in place as every prediction only reads voxels that are already decoded
+	inline static void
+	_decode_residuals(uint32_t* q, const glm::ivec3& extent, int bits)
+	{
+		uint32_t levels = (1u << bits) - 1;
+		auto unzigzag = [&](uint32_t zigzag, uint32_t prediction) {
+			return (prediction + ((zigzag >> 1) ^ (0u - (zigzag & 1)))) & levels;
+		};
+
+		size_t i = 0;
+		for (int z = 0; z < extent.z; ++z)
+		{
+			for (int y = 0; y < extent.y; ++y)
+			{
+				if (y == 0)
+					q[i] = unzigzag(q[i], z > 0 ? q[i - size_t(extent.x) * extent.y] : 0);
+				else
+					q[i] = unzigzag(q[i], q[i - extent.x]);
+				++i;
+
+				if (y == 0)
+				{
+					for (int x = 1; x < extent.x; ++x, ++i)
+						q[i] = unzigzag(q[i], q[i - 1]);
+					continue;
+				}
+
+				for (int x = 1; x < extent.x; ++x, ++i)
+					q[i] = unzigzag(q[i], _med(q[i - 1], q[i - extent.x], q[i - extent.x - 1]));
+			}
+		}
+	}
+
+	// groups of VOLUME_PACK_GROUP values packed with the bit width of the largest one
+	inline static void
+	_pack_groups(const uint32_t* values, size_t count, std::vector<uint8_t>& out)
+	{
+		for (size_t start = 0; start < count; start += VOLUME_PACK_GROUP)
+		{
+			auto group_count = std::min(VOLUME_PACK_GROUP, count - start);
+
+			uint32_t all = 0;
+			for (size_t i = 0; i < group_count; ++i)
+				all |= values[start + i];
+
+			uint32_t width = 0;
+			while (width < 32 && (all >> width) != 0)
+				++width;
+			out.push_back(uint8_t(width));
+
+			uint64_t buffer = 0;
+			uint32_t buffered = 0;
+			for (size_t i = 0; i < VOLUME_PACK_GROUP; ++i)
+			{
+				buffer |= uint64_t(i < group_count ? values[start + i] : 0) << buffered;
+				buffered += width;
+				for (; buffered >= 8; buffered -= 8, buffer >>= 8)
+					out.push_back(uint8_t(buffer));
+			}
+		}
+	}
+
+	inline static bool
+	_unpack_groups(const uint8_t*& ptr, const uint8_t* end, size_t count, int bits, uint32_t* values)
+	{
+		for (size_t start = 0; start < count; start += VOLUME_PACK_GROUP)
+		{
+			if (ptr == end)
+				return false;
+
+			uint32_t width = *ptr++;
+			auto group_size = size_t(width) * VOLUME_PACK_GROUP / 8;
+			if (width > uint32_t(bits) || group_size > size_t(end - ptr))
+				return false;
+
+			auto group_count = std::min(VOLUME_PACK_GROUP, count - start);
+			auto group = ptr;
+			ptr += group_size;
+
+			uint64_t buffer = 0;
+			uint32_t buffered = 0;
+			uint64_t mask = (uint64_t(1) << width) - 1;
+			for (size_t i = 0; i < group_count; ++i)
+			{
+				for (; buffered < width; buffered += 8)
+					buffer |= uint64_t(*group++) << buffered;
+				values[start + i] = uint32_t(buffer & mask);
+				buffer >>= width;
+				buffered -= width;
+			}
+		}
+
+		return true;
+	}
+
+	VolumeFile::VolumeFile()
+		: width(0),
+		  height(0),
+		  depth(0),
+		  format(Texture_Format::R8),
+		  brick_size(0),
+		  quantization_bits(0),
+		  brick_count(0),
+		  table_offset(0)
+	{
+	}
+
+	VolumeFile::VolumeFile(const char* file_name) : VolumeFile()
+	{
+		open(file_name);
+	}
+
+	bool
+	VolumeFile::open(const char* file_name)
+	{
+		close();
+
+		file = MappedFile(file_name);
+		if (!file.isOpen())
+		{
+			std::cout << "Cannot open volume file " << file_name << std::endl;
+			return false;
+		}
+
+		Volume_File_Header header;
+		if (file.getSize() < sizeof(header))
+		{
+			std::cout << "Volume file is smaller than its header " << file_name << std::endl;
+			close();
+			return false;
+		}
+		memcpy(&header, file.getData(), sizeof(header));
+
+		auto volume_format = Texture_Format(header.format);
+		if (memcmp(header.magic, "GFXV", 4) != 0 || header.version != VOLUME_VERSION ||
+			!Image3D::isSupportedFormat(volume_format))
+		{
+			std::cout << "Unsupported volume file " << file_name << std::endl;
+			close();
+			return false;
+		}
+
+		if (header.width == 0 || header.height == 0 || header.depth == 0 || header.brick_size == 0 ||
+			(header.quantization_bits != 8 && header.quantization_bits != 16))
+		{
+			std::cout << "Corrupt volume file " << file_name << std::endl;
+			close();
+			return false;
+		}
+
+		width = int(header.width);
+		height = int(header.height);
+		depth = int(header.depth);
+		format = volume_format;
+		brick_size = int(header.brick_size);
+		quantization_bits = int(header.quantization_bits);
+		brick_count = (glm::ivec3(width, height, depth) + brick_size - 1) / brick_size;
+		table_offset = sizeof(header);
+
+		auto bricks = size_t(brick_count.x) * brick_count.y * brick_count.z;
+		if (header.brick_count != bricks || file.getSize() < table_offset + bricks * sizeof(Volume_File_Brick))
+		{
+			std::cout << "Corrupt volume file " << file_name << std::endl;
+			close();
+			return false;
+		}
+
+		return true;
+	}
+
+	bool
+	VolumeFile::isOpen() const
+	{
+		return file.isOpen();
+	}
+
+	void
+	VolumeFile::close()
+	{
+		file.close();
+		width = height = depth = 0;
+		brick_size = quantization_bits = 0;
+		brick_count = glm::ivec3(0);
+		table_offset = 0;
+	}
+
+	int
+	VolumeFile::getWidth() const
+	{
+		return width;
+	}
+
+	int
+	VolumeFile::getHeight() const
+	{
+		return height;
+	}
+
+	int
+	VolumeFile::getDepth() const
+	{
+		return depth;
+	}
+
+	Texture_Format
+	VolumeFile::getFormat() const
+	{
+		return format;
+	}
+
+	int
+	VolumeFile::getBrickSize() const
+	{
+		return brick_size;
+	}
+
+	glm::ivec3
+	VolumeFile::getBrickCount() const
+	{
+		return brick_count;
+	}
+
+	int
+	VolumeFile::getQuantizationBits() const
+	{
+		return quantization_bits;
+	}
+
+	size_t
+	VolumeFile::getFileSize() const
+	{
+		return file.getSize();
+	}
+
+	Image3D
+	VolumeFile::read(uint32_t threads) const
+	{
+		if (!isOpen())
+			return Image3D();
+
+		Image3D volume(width, height, depth, format);
+		if (!volume.hasData())
+			return volume;
+
+		// bricks cover disjoint voxels so they're written to the volume without locking
+		std::atomic<bool> failed{false};
+		parallelFor(brick_count.x * brick_count.y * brick_count.z, threads, [&](int i) {
+			int bx = i % brick_count.x;
+			int by = (i / brick_count.x) % brick_count.y;
+			int bz = i / (brick_count.x * brick_count.y);
+
+			if (!readBrick(bx, by, bz, &volume))
+				failed = true;
+		});
+
+		if (failed)
+		{
+			std::cout << "Corrupt brick in volume file" << std::endl;
+			return Image3D();
+		}
+
+		return volume;
+	}
+
+	bool
+	VolumeFile::readBrick(int bx, int by, int bz, Image3D* volume) const
+	{
+		if (!volume || volume->getWidth() != width || volume->getHeight() != height ||
+			volume->getDepth() != depth || volume->getFormat() != format)
+		{
+			std::cout << "Volume doesn't match the volume file" << std::endl;
+			return false;
+		}
+
+		thread_local std::vector<float> values;
+		if (!decodeBrick(bx, by, bz, values))
+			return false;
+
+		auto extent = brickExtent(bx, by, bz);
+		auto origin = glm::ivec3(bx, by, bz) * brick_size;
+		auto plane = size_t(extent.x) * extent.y * extent.z;
+
+		for (int c = 0; c < volume->getChannels(); ++c)
+		{
+			auto channel_values = values.data() + c * plane;
+			for (int z = 0; z < extent.z; ++z)
+			{
+				for (int y = 0; y < extent.y; ++y)
+				{
+					auto row = channel_values + (size_t(z) * extent.y + y) * extent.x;
+					volume->setSpan(origin.x, origin.y + y, origin.z + z, extent.x, row, c);
+				}
+			}
+		}
+
+		return true;
+	}
+
+	bool
+	VolumeFile::readBrick(int bx, int by, int bz, std::vector<float>& values) const
+	{
+		return decodeBrick(bx, by, bz, values);
+	}
+
+	bool
+	VolumeFile::write(const char* file_name, Image3D* volume, int quantization_bits, int brick_size, uint32_t threads)
+	{
+		if (!volume || !volume->hasData())
+		{
+			std::cout << "Empty image check image file" << std::endl;
+			return false;
+		}
+
+		if ((quantization_bits != 8 && quantization_bits != 16) || brick_size <= 0)
+		{
+			std::cout << "Volume files use 8 or 16 bit quantization" << std::endl;
+			return false;
+		}
+
+		glm::ivec3 size(volume->getWidth(), volume->getHeight(), volume->getDepth());
+		auto count = (size + brick_size - 1) / brick_size;
+		auto bricks_count = size_t(count.x) * count.y * count.z;
+
+		auto channels = volume->getChannels();
+		auto component_size = volume->getVoxelSize() / channels;
+
+		// 8 bit channels gain nothing from 16 bit quantization
+		quantization_bits = std::min(quantization_bits, int(component_size) * 8);
+
+		std::vector<Volume_File_Brick> bricks(bricks_count);
+		std::vector<std::vector<uint8_t>> payloads(bricks_count);
+
+		parallelFor(int(bricks_count), threads, [&](int i) {
+			glm::ivec3 brick(i % count.x, (i / count.x) % count.y, i / (count.x * count.y));
+			auto origin = brick * brick_size;
+			auto extent = glm::min(glm::ivec3(brick_size), size - origin);
+			auto plane = size_t(extent.x) * extent.y * extent.z;
+
+			auto& entry = bricks[i];
+			entry = Volume_File_Brick{};
+
+			std::vector<float> values(plane);
+			std::vector<uint32_t> quantized(plane);
+			std::vector<uint32_t> residuals(plane);
+			std::vector<uint8_t> packed;
+			bool constant = true;
+
+			for (int c = 0; c < channels; ++c)
+			{
+				for (int z = 0; z < extent.z; ++z)
+					for (int y = 0; y < extent.y; ++y)
+						volume->readSpan(
+							origin.x,
+							origin.y + y,
+							origin.z + z,
+							extent.x,
+							values.data() + (size_t(z) * extent.y + y) * extent.x,
+							c);
+
+				auto range = std::minmax_element(values.begin(), values.end());
+				_quantize_range(
+					*range.first, *range.second, quantization_bits, component_size, entry.scale[c], entry.bias[c]);
+				constant &= entry.scale[c] == 0.0f;
+
+				long levels = long((1u << quantization_bits) - 1);
+				for (size_t v = 0; v < plane; ++v)
+				{
+					quantized[v] = 0;
+					if (entry.scale[c] > 0.0f)
+						quantized[v] =
+							uint32_t(std::clamp(std::lround((values[v] - entry.bias[c]) / entry.scale[c]), 0l, levels));
+				}
+
+				_encode_residuals(quantized.data(), extent, quantization_bits, residuals.data());
+				_pack_groups(residuals.data(), plane, packed);
+			}
+
+			if (constant)
+			{
+				entry.encoding = BRICK_CONSTANT;
+				return;
+			}
+
+			// groups of zero width left by flat regions and repeated patterns are what lz picks up
+			auto& payload = payloads[i];
+			lzCompress(packed.data(), packed.size(), payload);
+
+			entry.encoding = BRICK_LZ;
+			entry.packed_size = uint32_t(packed.size());
+			if (payload.size() >= packed.size())
+			{
+				payload = std::move(packed);
+				entry.encoding = BRICK_PACKED;
+			}
+			entry.size = uint32_t(payload.size());
+		});
+
+		uint64_t offset = sizeof(Volume_File_Header) + bricks_count * sizeof(Volume_File_Brick);
+		for (size_t i = 0; i < bricks_count; ++i)
+		{
+			bricks[i].offset = offset;
+			offset += bricks[i].size;
+		}
+
+		Volume_File_Header header{};
+		memcpy(header.magic, "GFXV", 4);
+		header.version = VOLUME_VERSION;
+		header.width = uint32_t(size.x);
+		header.height = uint32_t(size.y);
+		header.depth = uint32_t(size.z);
+		header.format = uint32_t(volume->getFormat());
+		header.brick_size = uint32_t(brick_size);
+		header.quantization_bits = uint32_t(quantization_bits);
+		header.brick_count = uint32_t(bricks_count);
+
+		std::vector<File_Chunk> chunks{
+			{0, &header, sizeof(header)},
+			{sizeof(header), bricks.data(), bricks.size() * sizeof(Volume_File_Brick)}};
+		for (size_t i = 0; i < bricks_count; ++i)
+			chunks.push_back(File_Chunk{bricks[i].offset, payloads[i].data(), payloads[i].size()});
+
+		if (!writeFileAtomically(file_name, chunks))
+		{
+			std::cout << "Cannot write volume file " << file_name << std::endl;
+			return false;
+		}
+
+		return true;
+	}
+
+	glm::ivec3
+	VolumeFile::brickExtent(int bx, int by, int bz) const
+	{
+		auto origin = glm::ivec3(bx, by, bz) * brick_size;
+		return glm::min(glm::ivec3(brick_size), glm::ivec3(width, height, depth) - origin);
+	}
+
+	bool
+	VolumeFile::decodeBrick(int bx, int by, int bz, std::vector<float>& values) const
+	{
+		if (!isOpen() || bx < 0 || by < 0 || bz < 0 || bx >= brick_count.x || by >= brick_count.y ||
+			bz >= brick_count.z)
+		{
+			std::cout << "Brick coordinates out of bounds!" << std::endl;
+			return false;
+		}
+
+		Volume_File_Brick entry;
+		auto index = (size_t(bz) * brick_count.y + by) * brick_count.x + bx;
+		memcpy(&entry, file.getData() + table_offset + index * sizeof(entry), sizeof(entry));
+
+		auto extent = brickExtent(bx, by, bz);
+		auto plane = size_t(extent.x) * extent.y * extent.z;
+		auto channels = int(textureFormatComponents(format));
+
+		values.resize(plane * channels);
+
+		if (entry.encoding == BRICK_CONSTANT)
+		{
+			for (int c = 0; c < channels; ++c)
+				std::fill_n(values.begin() + c * plane, plane, entry.bias[c]);
+			return true;
+		}
+
+		if (entry.offset > file.getSize() || entry.size > file.getSize() - entry.offset)
+			return false;
+
+		// packed bricks are read straight from the mapping, the others go through a per thread buffer
+		thread_local std::vector<uint8_t> scratch;
+		thread_local std::vector<uint32_t> quantized;
+		auto payload = file.getData() + entry.offset;
+		const uint8_t* packed = payload;
+
+		if (entry.encoding == BRICK_LZ)
+		{
+			scratch.resize(entry.packed_size);
+			if (!lzDecompress(payload, entry.size, scratch.data(), entry.packed_size))
+				return false;
+			packed = scratch.data();
+		}
+		else if (entry.encoding != BRICK_PACKED || entry.size != entry.packed_size)
+		{
+			return false;
+		}
+
+		auto packed_end = packed + entry.packed_size;
+		quantized.resize(plane);
+
+		for (int c = 0; c < channels; ++c)
+		{
+			if (!_unpack_groups(packed, packed_end, plane, quantization_bits, quantized.data()))
+				return false;
+			_decode_residuals(quantized.data(), extent, quantization_bits);
+
+			auto channel_values = values.data() + c * plane;
+			for (size_t v = 0; v < plane; ++v)
+				channel_values[v] = entry.bias[c] + float(quantized[v]) * entry.scale[c];
+		}
+
+		return true;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,101 @@
+#pragma once
+
+#include "Image3D.h"
+#include "enums.h"
+#include "gfx_mapped_file.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <vector>
+
+namespace gfx
+{
+	// compressed container for Image3D, the volume is cut in bricks and every channel of a brick is quantized to
+	// 8 or 16 bits between its own min and max, predicted slice by slice with the LOCO-I median edge detector and
+	// the zigzagged residuals lz compressed. a table at the front holds where each brick starts so bricks can be
+	// decoded on their own straight from the memory mapped file
+	class VolumeFile
+	{
+	public:
+		static constexpr int DEFAULT_BRICK_SIZE = 16;
+
+		VolumeFile();
+
+		VolumeFile(const char* file_name);
+
+		VolumeFile(const VolumeFile&) = delete;
+
+		VolumeFile&
+		operator=(const VolumeFile&) = delete;
+
+		bool
+		open(const char* file_name);
+
+		bool
+		isOpen() const;
+
+		void
+		close();
+
+		int
+		getWidth() const;
+
+		int
+		getHeight() const;
+
+		int
+		getDepth() const;
+
+		Texture_Format
+		getFormat() const;
+
+		int
+		getBrickSize() const;
+
+		glm::ivec3
+		getBrickCount() const;
+
+		int
+		getQuantizationBits() const;
+
+		// size of the whole file
+		size_t
+		getFileSize() const;
+
+		// decodes every brick, threads 0 uses one thread per hardware thread
+		Image3D
+		read(uint32_t threads = 0) const;
+
+		// decodes one brick into its place in volume, which must have the size and format of the file
+		bool
+		readBrick(int bx, int by, int bz, Image3D* volume) const;
+
+		// decodes one brick as one plane per channel, x varies fastest, bricks on the far edges can be smaller
+		bool
+		readBrick(int bx, int by, int bz, std::vector<float>& values) const;
+
+		// encodes the bricks in parallel and replaces the file once it's complete
+		static bool
+		write(
+			const char* file_name,
+			Image3D* volume,
+			int quantization_bits = 8,
+			int brick_size = DEFAULT_BRICK_SIZE,
+			uint32_t threads = 0);
+
+	private:
+		MappedFile file;
+		int width, height, depth;
+		Texture_Format format;
+		int brick_size, quantization_bits;
+		glm::ivec3 brick_count;
+		size_t table_offset;
+
+		glm::ivec3
+		brickExtent(int bx, int by, int bz) const;
+
+		bool
+		decodeBrick(int bx, int by, int bz, std::vector<float>& values) const;
+	};
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,574 @@
+#include "gfx_volume_renderer.h"
+#include "gfx.h"
+#include "gfx_formats.h"
+#include "gfx_noise.h"
+#include "gfx_parallel.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <iostream>
+
+namespace gfx
+{
+	// successive frames offset the blue noise by the golden ratio so every pixel cycles through all the offsets
+	constexpr float RAYMARCH_JITTER_STEP = 0.61803398875f;
+
+	constexpr int BLUE_NOISE_SIZE = 64;
+
+	static const char* const raymarch_vertex_shader = R"(
+		#version 450 core
+		layout (location = 0) in vec3 Position;
+
+		out vec2 v;
+
+		void main()
+		{
+			v = Position.xy;
+			gl_Position = vec4(Position, 1.0);
+		})";
+
+	// the ray runs in the unit box of the volume with t = 1 at the scene depth, or at the far plane
+	static const char* const raymarch_fragment_shader = R"(
+		#version 450 core
+		layout(binding = 0) uniform sampler3D volume;
+		layout(binding = 1) uniform sampler3D occupancy;
+		layout(binding = 2) uniform sampler2D blue_noise;
+		layout(binding = 3) uniform sampler2D scene_depth;
+
+		uniform int has_scene_depth;
+		uniform mat4 inv_view_proj;
+		uniform mat4 inv_model;
+		uniform vec3 camera_pos;
+
+		uniform vec3 volume_size;
+		uniform vec3 occupancy_count;
+		uniform vec3 cell_extent;
+		uniform int occupancy_levels;
+		uniform float density_max;
+
+		uniform float step_size;
+		uniform float max_step_scale;
+		uniform int max_steps;
+		uniform float opacity_threshold;
+		uniform float density_scale;
+		uniform vec3 color;
+		uniform float empty_threshold;
+		uniform float jitter_offset;
+
+		in vec2 v;
+
+		out vec4 FragColor;
+
+		vec2 intersectBox(vec3 ro, vec3 rd)
+		{
+			vec3 inv = 1.0 / rd;
+			vec3 t0 = (vec3(0.0) - ro) * inv;
+			vec3 t1 = (vec3(1.0) - ro) * inv;
+			vec3 tmin = min(t0, t1);
+			vec3 tmax = max(t0, t1);
+			return vec2(max(max(tmin.x, tmin.y), tmin.z), min(min(tmax.x, tmax.y), tmax.z));
+		}
+
+		// the last cell of a level also covers the cells left over by the odd sizes of the level below
+		ivec3 occupancyCell(vec3 uvw, int level, out ivec3 size)
+		{
+			ivec3 count = ivec3(occupancy_count + 0.5);
+			size = max(count >> level, ivec3(1));
+			ivec3 cell = min(ivec3(clamp(uvw, 0.0, 1.0) / cell_extent), count - 1);
+			return min(cell >> level, size - 1);
+		}
+
+		float occupancyMax(vec3 uvw, int level)
+		{
+			ivec3 size;
+			return texelFetch(occupancy, occupancyCell(uvw, level, size), level).r;
+		}
+
+		// ray distance to the far side of the occupancy cell
+		float cellExit(vec3 uvw, vec3 rd, int level)
+		{
+			ivec3 size;
+			ivec3 cell = occupancyCell(uvw, level, size);
+			vec3 low = vec3(cell << level) * cell_extent;
+			vec3 high = mix(min(vec3((cell + 1) << level) * cell_extent, 1.0), vec3(1.0), equal(cell, size - 1));
+			vec3 t = (mix(low, high, greaterThan(rd, vec3(0.0))) - uvw) / rd;
+			t = mix(t, vec3(1e30), equal(rd, vec3(0.0)));
+			return max(min(min(t.x, t.y), t.z), 0.0);
+		}
+
+		void main()
+		{
+			ivec2 pixel = ivec2(gl_FragCoord.xy);
+			vec2 uv = v * 0.5 + 0.5;
+
+			float depth = 1.0;
+			if (has_scene_depth != 0)
+			{
+				ivec2 size = textureSize(scene_depth, 0);
+				depth = texelFetch(scene_depth, min(ivec2(uv * vec2(size)), size - 1), 0).r;
+			}
+
+			vec4 end = inv_view_proj * vec4(v, depth * 2.0 - 1.0, 1.0);
+			vec3 ro = (inv_model * vec4(camera_pos, 1.0)).xyz;
+			vec3 rd = (inv_model * vec4(end.xyz / end.w, 1.0)).xyz - ro;
+
+			vec2 t = intersectBox(ro, rd);
+			t.x = max(t.x, 0.0);
+			t.y = min(t.y, 1.0);
+			if (t.x >= t.y)
+			{
+				FragColor = vec4(0.0);
+				return;
+			}
+
+			float dt = step_size / length(rd * volume_size);
+			float ray_length = length(rd);
+
+			float offset = 0.5;
+			if (jitter_offset >= 0.0)
+				offset = fract(texelFetch(blue_noise, pixel % textureSize(blue_noise, 0), 0).r + jitter_offset);
+
+			vec4 acc = vec4(0.0);
+			float s = t.x + dt * offset;
+
+			for (int i = 0; i < max_steps && s < t.y && acc.a < opacity_threshold; ++i)
+			{
+				vec3 uvw = ro + rd * s;
+
+				// empty space is crossed in one jump from the coarsest level that is still empty
+				float cell_max = occupancyMax(uvw, 0);
+				if (cell_max <= empty_threshold)
+				{
+					int level = 0;
+					while (level + 1 < occupancy_levels && occupancyMax(uvw, level + 1) <= empty_threshold)
+						++level;
+
+					s += cellExit(uvw, rd, level) + dt * max(offset, 0.01);
+					continue;
+				}
+
+				// cells that are thin everywhere take longer steps, a step adds about as much opacity as a
+				// regular step through the densest part of the volume
+				float step_length = min(dt * clamp(density_max / cell_max, 1.0, max_step_scale), t.y - s);
+
+				float density = texture(volume, uvw).r;
+				float alpha = 1.0 - exp(-density * density_scale * step_length * ray_length);
+				acc.rgb += (1.0 - acc.a) * alpha * color;
+				acc.a += (1.0 - acc.a) * alpha;
+
+				s += step_length;
+			}
+
+			FragColor = acc;
+		})";
+
+	// bilinear weights are scaled down for low resolution samples whose scene depth differs from the pixel's,
+	// so the volume doesn't bleed across the edges of the objects in front of it
+	static const char* const upsample_fragment_shader = R"(
+		#version 450 core
+		layout(binding = 0) uniform sampler2D low_res;
+		layout(binding = 1) uniform sampler2D scene_depth;
+
+		uniform int has_scene_depth;
+		uniform mat4 inv_projection;
+		uniform float depth_tolerance;
+
+		in vec2 v;
+
+		out vec4 FragColor;
+
+		float viewDepth(vec2 uv)
+		{
+			ivec2 size = textureSize(scene_depth, 0);
+			float depth = texelFetch(scene_depth, min(ivec2(uv * vec2(size)), size - 1), 0).r;
+			vec4 p = inv_projection * vec4(0.0, 0.0, depth * 2.0 - 1.0, 1.0);
+			return -p.z / p.w;
+		}
+
+		void main()
+		{
+			vec2 uv = v * 0.5 + 0.5;
+			if (has_scene_depth == 0)
+			{
+				FragColor = texture(low_res, uv);
+				return;
+			}
+
+			vec2 low_size = vec2(textureSize(low_res, 0));
+			vec2 p = uv * low_size - 0.5;
+			ivec2 base = ivec2(floor(p));
+			vec2 f = p - vec2(base);
+
+			float depth = viewDepth(uv);
+			vec4 sum = vec4(0.0);
+			float weight_sum = 0.0;
+			vec4 nearest = vec4(0.0);
+			float nearest_diff = 1e30;
+
+			for (int i = 0; i < 4; ++i)
+			{
+				ivec2 offset = ivec2(i & 1, i >> 1);
+				ivec2 texel = clamp(base + offset, ivec2(0), ivec2(low_size) - 1);
+				vec4 value = texelFetch(low_res, texel, 0);
+				float diff = abs(viewDepth((vec2(texel) + 0.5) / low_size) - depth);
+
+				vec2 bilinear = mix(1.0 - f, f, vec2(offset));
+				float weight = bilinear.x * bilinear.y * max(1.0 - diff / (depth * depth_tolerance), 0.0);
+				sum += value * weight;
+				weight_sum += weight;
+
+				if (diff < nearest_diff)
+				{
+					nearest_diff = diff;
+					nearest = value;
+				}
+			}
+
+			// every sample is across a depth edge, the closest in depth is the best guess
+			FragColor = weight_sum > 1e-4 ? sum / weight_sum : nearest;
+		})";
+
+	VolumeRenderer::VolumeRenderer(int width, int height, const Raymarch_Settings& settings)
+		: settings(settings),
+		  width(std::max(width, 1)),
+		  height(std::max(height, 1)),
+		  low_res_size(0),
+		  raymarch_program(0),
+		  upsample_program(0),
+		  vertex_buffer(0),
+		  mesh(0),
+		  blue_noise(0),
+		  occupancy(0),
+		  volume_texture(0),
+		  frame(0),
+		  volume_size(0.0f),
+		  occupancy_count(0),
+		  occupancy_levels(0),
+		  cell_size(0),
+		  density_max(0.0f)
+	{
+	}
+
+	VolumeRenderer::~VolumeRenderer()
+	{
+		glDeleteProgram(raymarch_program);
+		glDeleteProgram(upsample_program);
+		glDeleteVertexArrays(1, &mesh);
+		glDeleteBuffers(1, &vertex_buffer);
+		glDeleteTextures(1, &blue_noise);
+		glDeleteTextures(1, &occupancy);
+	}
+
+	bool
+	VolumeRenderer::init(GFX* gfx)
+	{
+		// clang-format off
+		float vertices[] = {
+			-1.0f, -1.0f, 0.0f,
+			 1.0f, -1.0f, 0.0f,
+			-1.0f,  1.0f, 0.0f,
+			 1.0f,  1.0f, 0.0f
+		};
+		// clang-format on
+
+		vertex_buffer = gfx->createVertexBuffer(vertices, sizeof(vertices), BUFFER_USAGE::STATIC);
+
+		Attributes attributes;
+		attributes.append(GPU_Attribute(GPU_Attribute::VEC3, "POSITION"));
+		mesh = gfx->createGPUMesh(vertex_buffer, attributes);
+
+		raymarch_program = gfx->createGPUProgram(raymarch_vertex_shader, raymarch_fragment_shader);
+		upsample_program = gfx->createGPUProgram(raymarch_vertex_shader, upsample_fragment_shader);
+
+		auto noise = noise::bakeBlueNoise(BLUE_NOISE_SIZE);
+		blue_noise = gfx->createTexture2D(&noise, REPEAT, NEAREST, NEAREST, false);
+		if (blue_noise == uint32_t(-1))
+		{
+			blue_noise = 0;
+			return false;
+		}
+
+		updateLowRes();
+		return true;
+	}
+
+	bool
+	VolumeRenderer::setVolume(uint32_t texture3d, Image3D* volume, int cell_size, int channel)
+	{
+		if (!volume || !volume->hasData())
+		{
+			std::cout << "Empty image check image file" << std::endl;
+			return false;
+		}
+
+		if (channel < 0 || channel >= volume->getChannels())
+		{
+			std::cout << "Volume has no channel " << channel << ", it has " << volume->getChannels() << std::endl;
+			return false;
+		}
+
+		glm::ivec3 size(volume->getWidth(), volume->getHeight(), volume->getDepth());
+		cell_size = std::max(cell_size, 1);
+		auto count = (size + cell_size - 1) / cell_size;
+
+		// cells reach one voxel into their neighbours, the filtered samples near a face read those voxels too
+		std::vector<std::vector<float>> levels(1, std::vector<float>(size_t(count.x) * count.y * count.z, 0.0f));
+		std::vector<glm::ivec3> sizes(1, count);
+
+		parallelFor(count.z, 0, [&](int cz) {
+			std::vector<float> row(cell_size + 2);
+			for (int cy = 0; cy < count.y; ++cy)
+			{
+				for (int cx = 0; cx < count.x; ++cx)
+				{
+					auto low = glm::max(glm::ivec3(cx, cy, cz) * cell_size - 1, glm::ivec3(0));
+					auto high = glm::min((glm::ivec3(cx, cy, cz) + 1) * cell_size + 1, size);
+
+					float cell_max = -FLT_MAX;
+					for (int z = low.z; z < high.z; ++z)
+					{
+						for (int y = low.y; y < high.y; ++y)
+						{
+							auto span = high.x - low.x;
+							volume->readSpan(low.x, y, z, span, row.data(), channel);
+							cell_max = std::max(cell_max, *std::max_element(row.begin(), row.begin() + span));
+						}
+					}
+
+					levels[0][(size_t(cz) * count.y + cy) * count.x + cx] = cell_max;
+				}
+			}
+		});
+
+		// sizes follow the opengl mip chain so the pyramid uploads as the mips of one texture
+		auto levels_count = mipLevelsCount(count.x, count.y, count.z);
+		for (uint32_t level = 1; level < levels_count; ++level)
+		{
+			auto prev_size = sizes.back();
+			auto level_size = glm::max(count >> int(level), glm::ivec3(1));
+
+			std::vector<float> cells(size_t(level_size.x) * level_size.y * level_size.z, -FLT_MAX);
+			auto& prev = levels.back();
+
+			for (int z = 0; z < prev_size.z; ++z)
+			{
+				int pz = std::min(z / 2, level_size.z - 1);
+				for (int y = 0; y < prev_size.y; ++y)
+				{
+					int py = std::min(y / 2, level_size.y - 1);
+					for (int x = 0; x < prev_size.x; ++x)
+					{
+						int px = std::min(x / 2, level_size.x - 1);
+						auto& cell = cells[(size_t(pz) * level_size.y + py) * level_size.x + px];
+						cell = std::max(cell, prev[(size_t(z) * prev_size.y + y) * prev_size.x + x]);
+					}
+				}
+			}
+
+			levels.push_back(std::move(cells));
+			sizes.push_back(level_size);
+		}
+
+		if (!uploadOccupancy(levels, sizes))
+			return false;
+
+		volume_texture = texture3d;
+		volume_size = glm::vec3(size);
+		occupancy_count = count;
+		occupancy_levels = int(levels.size());
+		this->cell_size = cell_size;
+		density_max = levels.back()[0];
+		return true;
+	}
+
+	void
+	VolumeRenderer::resize(int width, int height)
+	{
+		this->width = std::max(width, 1);
+		this->height = std::max(height, 1);
+		updateLowRes();
+	}
+
+	void
+	VolumeRenderer::setSettings(const Raymarch_Settings& settings)
+	{
+		bool rescale = settings.resolution_scale != this->settings.resolution_scale;
+		this->settings = settings;
+
+		if (rescale)
+			updateLowRes();
+	}
+
+	const Raymarch_Settings&
+	VolumeRenderer::getSettings() const
+	{
+		return settings;
+	}
+
+	void
+	VolumeRenderer::render(
+		GFX* gfx,
+		const glm::mat4& model,
+		const glm::mat4& view,
+		const glm::mat4& projection,
+		uint32_t scene_depth)
+	{
+		if (!low_res || volume_texture == 0 || occupancy == 0)
+			return;
+
+		// the upsampled volume goes to whatever target and viewport the caller had bound
+		GLint viewport[4], target, blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha;
+		glGetIntegerv(GL_VIEWPORT, viewport);
+		glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &target);
+		glGetIntegerv(GL_BLEND_SRC_RGB, &blend_src_rgb);
+		glGetIntegerv(GL_BLEND_DST_RGB, &blend_dst_rgb);
+		glGetIntegerv(GL_BLEND_SRC_ALPHA, &blend_src_alpha);
+		glGetIntegerv(GL_BLEND_DST_ALPHA, &blend_dst_alpha);
+		auto depth_test = glIsEnabled(GL_DEPTH_TEST);
+		auto blend = glIsEnabled(GL_BLEND);
+
+		glDisable(GL_DEPTH_TEST);
+		glDisable(GL_BLEND);
+
+		low_res->Bind();
+		glViewport(0, 0, low_res_size.x, low_res_size.y);
+
+		const float clear[] = {0.0f, 0.0f, 0.0f, 0.0f};
+		glClearBufferfv(GL_COLOR, 0, clear);
+
+		glActiveTexture(GL_TEXTURE0);
+		gfx->bindTexture3D(volume_texture);
+		glActiveTexture(GL_TEXTURE1);
+		gfx->bindTexture3D(occupancy);
+		glActiveTexture(GL_TEXTURE2);
+		gfx->bindTexture2D(blue_noise);
+		glActiveTexture(GL_TEXTURE3);
+		gfx->bindTexture2D(scene_depth);
+
+		auto camera_pos = glm::vec3(glm::inverse(view)[3]);
+		auto jitter_offset = settings.jitter ? float(std::fmod(double(frame) * RAYMARCH_JITTER_STEP, 1.0)) : -1.0f;
+
+		gfx->bindGPUProgram(raymarch_program);
+		gfx->setGPUProgramInt(raymarch_program, "has_scene_depth", scene_depth != 0);
+		gfx->setGPUProgramMat4(raymarch_program, "inv_view_proj", glm::inverse(projection * view));
+		gfx->setGPUProgramMat4(raymarch_program, "inv_model", glm::inverse(model));
+		gfx->setGPUProgramVec3(raymarch_program, "camera_pos", camera_pos);
+		gfx->setGPUProgramVec3(raymarch_program, "volume_size", volume_size);
+		gfx->setGPUProgramVec3(raymarch_program, "occupancy_count", glm::vec3(occupancy_count));
+		gfx->setGPUProgramVec3(raymarch_program, "cell_extent", float(cell_size) / volume_size);
+		gfx->setGPUProgramInt(raymarch_program, "occupancy_levels", occupancy_levels);
+		gfx->setGPUProgramFloat(raymarch_program, "density_max", density_max);
+		gfx->setGPUProgramFloat(raymarch_program, "step_size", settings.step_size);
+		gfx->setGPUProgramFloat(raymarch_program, "max_step_scale", std::max(settings.max_step_scale, 1.0f));
+		gfx->setGPUProgramInt(raymarch_program, "max_steps", settings.max_steps);
+		gfx->setGPUProgramFloat(raymarch_program, "opacity_threshold", settings.opacity_threshold);
+		gfx->setGPUProgramFloat(raymarch_program, "density_scale", settings.density_scale);
+		gfx->setGPUProgramVec3(raymarch_program, "color", settings.color);
+		gfx->setGPUProgramFloat(raymarch_program, "empty_threshold", settings.empty_threshold);
+		gfx->setGPUProgramFloat(raymarch_program, "jitter_offset", jitter_offset);
+
+		gfx->draw(GFX_Primitive::TRIANGLES_STRIP, mesh, 4);
+
+		// premultiplied color over the target
+		glBindFramebuffer(GL_FRAMEBUFFER, target);
+		glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+		glEnable(GL_BLEND);
+		glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+
+		glActiveTexture(GL_TEXTURE0);
+		gfx->bindTexture2D(low_res->GetTexture());
+		glActiveTexture(GL_TEXTURE1);
+		gfx->bindTexture2D(scene_depth);
+
+		gfx->bindGPUProgram(upsample_program);
+		gfx->setGPUProgramInt(upsample_program, "has_scene_depth", scene_depth != 0);
+		gfx->setGPUProgramMat4(upsample_program, "inv_projection", glm::inverse(projection));
+		gfx->setGPUProgramFloat(upsample_program, "depth_tolerance", std::max(settings.depth_tolerance, 1e-4f));
+
+		gfx->draw(GFX_Primitive::TRIANGLES_STRIP, mesh, 4);
+
+		glActiveTexture(GL_TEXTURE0);
+		glBlendFuncSeparate(blend_src_rgb, blend_dst_rgb, blend_src_alpha, blend_dst_alpha);
+		if (!blend)
+			glDisable(GL_BLEND);
+		if (depth_test)
+			glEnable(GL_DEPTH_TEST);
+
+		++frame;
+	}
+
+	uint32_t
+	VolumeRenderer::getLowResTexture() const
+	{
+		return low_res ? low_res->GetTexture() : 0;
+	}
+
+	glm::ivec2
+	VolumeRenderer::getLowResSize() const
+	{
+		return low_res_size;
+	}
+
+	void
+	VolumeRenderer::updateLowRes()
+	{
+		auto scale = std::clamp(settings.resolution_scale, 0.1f, 1.0f);
+		auto size = glm::max(glm::ivec2(glm::vec2(width, height) * scale + 0.5f), glm::ivec2(1));
+
+		if (!low_res)
+			low_res = std::make_unique<Framebuffer>(size.x, size.y, HDRBuffer);
+		else
+			low_res->Resize(size.x, size.y);
+
+		low_res_size = size;
+	}
+
+	bool
+	VolumeRenderer::uploadOccupancy(const std::vector<std::vector<float>>& levels, const std::vector<glm::ivec3>& sizes)
+	{
+		glDeleteTextures(1, &occupancy);
+		occupancy = 0;
+
+		GLuint id = -1;
+		glGenTextures(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate occupancy Texture3D" << std::endl;
+			return false;
+		}
+
+		glBindTexture(GL_TEXTURE_3D, id);
+		glTexStorage3D(GL_TEXTURE_3D, (GLsizei)levels.size(), GL_R32F, sizes[0].x, sizes[0].y, sizes[0].z);
+
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+		for (size_t level = 0; level < levels.size(); ++level)
+		{
+			auto size = sizes[level];
+			glTexSubImage3D(
+				GL_TEXTURE_3D,
+				(GLint)level,
+				0,
+				0,
+				0,
+				size.x,
+				size.y,
+				size.z,
+				GL_RED,
+				GL_FLOAT,
+				levels[level].data());
+		}
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, GL_NEAREST_MIPMAP_NEAREST);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAX_LEVEL, (GLint)levels.size() - 1);
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		occupancy = id;
+		return true;
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,115 @@
+#pragma once
+
+#include "Image3D.h"
+#include "gfx_fbo.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <vector>
+
+namespace gfx
+{
+	class GFX;
+
+	struct Raymarch_Settings
+	{
+		// fraction of the output size the rays are marched at
+		float resolution_scale = 0.5f;
+
+		// step length in voxels inside occupied space, and how much longer it may get where the occupancy
+		// says the medium is thin
+		float step_size = 0.5f;
+		float max_step_scale = 4.0f;
+		int max_steps = 512;
+
+		// rays stop once their opacity reaches it
+		float opacity_threshold = 0.98f;
+
+		// extinction of a density of 1 over the length of the volume box
+		float density_scale = 60.0f;
+		glm::vec3 color = glm::vec3(1.0f);
+
+		// occupancy cells that never go above it are skipped over
+		float empty_threshold = 0.0f;
+
+		// offsets the first step of every pixel with blue noise, changing every frame
+		bool jitter = true;
+
+		// relative depth difference past which a low resolution sample is left out of the upsampling
+		float depth_tolerance = 0.1f;
+	};
+
+	// raymarches a 3D texture in the unit box placed by a model matrix. rays are clipped to the box and to the
+	// scene depth, skip the empty space using an occupancy mip built from the volume, and stop once opaque.
+	// the pass runs at a reduced resolution and is upsampled with a depth aware bilateral filter, then blended
+	// with premultiplied alpha over the framebuffer bound when render is called
+	class VolumeRenderer
+	{
+	public:
+		VolumeRenderer(int width, int height, const Raymarch_Settings& settings = Raymarch_Settings{});
+
+		VolumeRenderer(const VolumeRenderer&) = delete;
+
+		VolumeRenderer&
+		operator=(const VolumeRenderer&) = delete;
+
+		~VolumeRenderer();
+
+		// compiles the programs and creates the blue noise, call once the context is up
+		bool
+		init(GFX* gfx);
+
+		// texture3d holds the volume, the occupancy is built from channel with cells of cell_size voxels
+		bool
+		setVolume(uint32_t texture3d, Image3D* volume, int cell_size = 8, int channel = 0);
+
+		// size of the output, the low resolution target follows it
+		void
+		resize(int width, int height);
+
+		void
+		setSettings(const Raymarch_Settings& settings);
+
+		const Raymarch_Settings&
+		getSettings() const;
+
+		// scene_depth is the depth texture of the opaque scene at the output size, 0 when there's none
+		void
+		render(
+			GFX* gfx,
+			const glm::mat4& model,
+			const glm::mat4& view,
+			const glm::mat4& projection,
+			uint32_t scene_depth = 0);
+
+		// premultiplied color and opacity of the last pass at the low resolution
+		uint32_t
+		getLowResTexture() const;
+
+		glm::ivec2
+		getLowResSize() const;
+
+	private:
+		Raymarch_Settings settings;
+		int width, height;
+		glm::ivec2 low_res_size;
+		std::unique_ptr<Framebuffer> low_res;
+
+		uint32_t raymarch_program, upsample_program;
+		uint32_t vertex_buffer, mesh;
+		uint32_t blue_noise, occupancy, volume_texture;
+		uint32_t frame;
+
+		glm::vec3 volume_size;
+		glm::ivec3 occupancy_count;
+		int occupancy_levels, cell_size;
+		float density_max;
+
+		void
+		updateLowRes();
+
+		bool
+		uploadOccupancy(const std::vector<std::vector<float>>& levels, const std::vector<glm::ivec3>& sizes);
+	};
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "gfx_volume_streamer.h"
+#include "gfx_formats.h"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace gfx
+{
+	// a second per wait keeps the loop responsive if the driver is slow to signal
+	constexpr GLuint64 STREAMER_WAIT_TIMEOUT = 1000000000;
+
+	VolumeStreamer::VolumeStreamer(uint32_t slab_depth, uint32_t ring_size)
+		: slab_depth(std::max(slab_depth, 1u)),
+		  ring_size(std::max(ring_size, 1u)),
+		  ring_index(0),
+		  source(nullptr),
+		  width(0),
+		  height(0),
+		  depth(0),
+		  next_slice(0),
+		  format(Texture_Format::R8),
+		  mipmaps(false),
+		  slice_size(0),
+		  texture(0)
+	{
+	}
+
+	VolumeStreamer::~VolumeStreamer()
+	{
+		release();
+	}
+
+	bool
+	VolumeStreamer::open(const char* file_name, int width, int height, int depth, Texture_Format format, size_t offset)
+	{
+		release();
+
+		file = MappedFile(file_name);
+		if (!file.isOpen())
+		{
+			std::cout << "Cannot open volume file " << file_name << std::endl;
+			return false;
+		}
+
+		if (offset > file.getSize())
+		{
+			std::cout << "Volume file is smaller than its header" << std::endl;
+			file.close();
+			return false;
+		}
+
+		if (!setSource(file.getData() + offset, file.getSize() - offset, width, height, depth, format))
+		{
+			file.close();
+			return false;
+		}
+
+		// the first slabs are needed right away
+		file.prefetch(offset, slice_size * slab_depth * ring_size);
+		return true;
+	}
+
+	bool
+	VolumeStreamer::open(Image3D* volume)
+	{
+		release();
+
+		if (!volume || !volume->hasData())
+		{
+			std::cout << "Empty image check image file" << std::endl;
+			return false;
+		}
+
+		return setSource(
+			volume->getData(),
+			volume->getSizeInBytes(),
+			volume->getWidth(),
+			volume->getHeight(),
+			volume->getDepth(),
+			volume->getFormat());
+	}
+
+	uint32_t
+	VolumeStreamer::createTexture(
+		Wrapping_Mode wrap_mode,
+		Filtering_Mode minifying_mode,
+		Filtering_Mode magnifying_mode,
+		bool enable_mipmaps)
+	{
+		GLuint id = -1;
+
+		if (source == nullptr)
+		{
+			std::cout << "Volume streamer has no source, open a volume first" << std::endl;
+			return id;
+		}
+
+		glGenTextures(1, &id);
+
+		if (id == -1)
+		{
+			std::cout << "Cannot generate Texture3D" << std::endl;
+			return id;
+		}
+
+		glBindTexture(GL_TEXTURE_3D, id);
+
+		auto levels = enable_mipmaps ? mipLevelsCount(width, height, depth) : 1;
+		glTexStorage3D(GL_TEXTURE_3D, levels, textureInternalFormat(format), width, height, depth);
+
+		auto res = wrappingMode(wrap_mode);
+
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_S, res);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_T, res);
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_WRAP_R, res);
+
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MIN_FILTER, filteringMode(minifying_mode));
+		glTexParameteri(GL_TEXTURE_3D, GL_TEXTURE_MAG_FILTER, filteringMode(magnifying_mode));
+
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		// a second call starts the streaming over into the new texture, the one before stays with the caller but
+		// its staging buffers would leak
+		releaseRing();
+
+		// persistent coherent mappings are written once per slab and never unmapped while streaming
+		auto slab_size = slice_size * std::min<size_t>(slab_depth, depth);
+		GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+		ring.resize(ring_size);
+		for (auto& pixel_buffer : ring)
+		{
+			glGenBuffers(1, &pixel_buffer.buffer);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer.buffer);
+			glBufferStorage(GL_PIXEL_UNPACK_BUFFER, slab_size, nullptr, flags);
+			pixel_buffer.mapped = (unsigned char*)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, slab_size, flags);
+			pixel_buffer.fence = nullptr;
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+		texture = id;
+		mipmaps = enable_mipmaps;
+		next_slice = 0;
+		ring_index = 0;
+
+		return id;
+	}
+
+	float
+	VolumeStreamer::update(uint32_t max_slabs)
+	{
+		if (texture == 0 || isDone())
+			return getProgress();
+
+		auto pixel_format = pixelFormat(textureFormatComponents(format));
+		auto pixel_type = textureTransferType(format);
+
+		glBindTexture(GL_TEXTURE_3D, texture);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+		for (uint32_t i = 0; i < max_slabs && next_slice < depth; ++i)
+		{
+			auto& pixel_buffer = ring[ring_index];
+
+			// the buffer is reused only once the gpu is done reading the slab it held
+			if (pixel_buffer.fence)
+			{
+				auto fence = (GLsync)pixel_buffer.fence;
+				while (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, STREAMER_WAIT_TIMEOUT) == GL_TIMEOUT_EXPIRED)
+					;
+				glDeleteSync(fence);
+				pixel_buffer.fence = nullptr;
+			}
+
+			int slices = std::min<int>(slab_depth, depth - next_slice);
+			auto offset = size_t(next_slice) * slice_size;
+			auto size = size_t(slices) * slice_size;
+
+			memcpy(pixel_buffer.mapped, source + offset, size);
+
+			// page in the next slab while the current one is transferred
+			if (file.isOpen())
+				file.prefetch(size_t(source - file.getData()) + offset + size, size_t(slab_depth) * slice_size);
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer.buffer);
+			glTexSubImage3D(
+				GL_TEXTURE_3D,
+				0,
+				0,
+				0,
+				next_slice,
+				width,
+				height,
+				slices,
+				pixel_format,
+				pixel_type,
+				nullptr);
+			pixel_buffer.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+			next_slice += slices;
+			ring_index = (ring_index + 1) % ring_size;
+		}
+
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+		if (isDone() && mipmaps)
+			glGenerateMipmap(GL_TEXTURE_3D);
+
+		glBindTexture(GL_TEXTURE_3D, 0);
+
+		// the texture stays with the caller, the staging buffers and the file are no longer needed
+		if (isDone())
+		{
+			auto id = texture;
+			auto volume_depth = depth;
+			release();
+			texture = id;
+			depth = next_slice = volume_depth;
+		}
+
+		return getProgress();
+	}
+
+	float
+	VolumeStreamer::getProgress() const
+	{
+		return depth > 0 ? float(next_slice) / float(depth) : 0.0f;
+	}
+
+	bool
+	VolumeStreamer::isDone() const
+	{
+		return depth > 0 && next_slice >= depth;
+	}
+
+	uint32_t
+	VolumeStreamer::getTexture() const
+	{
+		return texture;
+	}
+
+	bool
+	VolumeStreamer::setSource(
+		const unsigned char* data,
+		size_t size,
+		int width,
+		int height,
+		int depth,
+		Texture_Format format)
+	{
+		if (width <= 0 || height <= 0 || depth <= 0 || !Image3D::isSupportedFormat(format))
+		{
+			std::cout << "Unsupported volume size or format" << std::endl;
+			return false;
+		}
+
+		auto slice = size_t(width) * height * textureFormatPixelSize(format);
+		if (size < slice * depth)
+		{
+			std::cout << "Volume data is smaller than the volume size" << std::endl;
+			return false;
+		}
+
+		source = data;
+		slice_size = slice;
+		this->width = width;
+		this->height = height;
+		this->depth = depth;
+		this->format = format;
+		next_slice = 0;
+		return true;
+	}
+
+	void
+	VolumeStreamer::release()
+	{
+		releaseRing();
+
+		file.close();
+		source = nullptr;
+		texture = 0;
+		width = height = depth = next_slice = 0;
+	}
+
+	void
+	VolumeStreamer::releaseRing()
+	{
+		for (auto& pixel_buffer : ring)
+		{
+			if (pixel_buffer.fence)
+				glDeleteSync((GLsync)pixel_buffer.fence);
+
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixel_buffer.buffer);
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+			glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+			glDeleteBuffers(1, &pixel_buffer.buffer);
+		}
+		ring.clear();
+	}
+} // namespace gfx
\ No newline at end of file
@@ -0,0 +1,84 @@
+#pragma once
+
+#include "Image3D.h"
+#include "enums.h"
+#include "gfx_mapped_file.h"
+
+#include <cstdint>
+#include <vector>
+
+namespace gfx
+{
+	// fills an immutable 3D texture a slab of z slices at a time over several frames, slabs go through a ring of
+	// persistently mapped pixel buffers so the cpu never waits on a transfer still in flight, and they're read
+	// straight from a memory mapped file so the whole volume never sits in memory
+	class VolumeStreamer
+	{
+	public:
+		VolumeStreamer(uint32_t slab_depth = 16, uint32_t ring_size = 3);
+
+		VolumeStreamer(const VolumeStreamer&) = delete;
+
+		VolumeStreamer&
+		operator=(const VolumeStreamer&) = delete;
+
+		~VolumeStreamer();
+
+		// raw voxels in the Image3D layout, x varies fastest then y then z, offset skips a file header
+		bool
+		open(const char* file_name, int width, int height, int depth, Texture_Format format, size_t offset = 0);
+
+		// streams a volume already in memory, the volume has to outlive the streaming
+		bool
+		open(Image3D* volume);
+
+		// allocates the texture storage, the texture can be bound right away and fills up as update is called
+		uint32_t
+		createTexture(
+			Wrapping_Mode wrap_mode,
+			Filtering_Mode minifying_mode,
+			Filtering_Mode magnifying_mode,
+			bool enable_mipmaps);
+
+		// uploads at most max_slabs slabs, call once a frame, returns the progress in [0, 1]
+		float
+		update(uint32_t max_slabs = 1);
+
+		float
+		getProgress() const;
+
+		bool
+		isDone() const;
+
+		uint32_t
+		getTexture() const;
+
+	private:
+		struct Pixel_Buffer
+		{
+			uint32_t buffer;
+			unsigned char* mapped;
+			void* fence;
+		};
+
+		uint32_t slab_depth, ring_size, ring_index;
+		MappedFile file;
+		const unsigned char* source;
+		int width, height, depth, next_slice;
+		Texture_Format format;
+		bool mipmaps;
+		size_t slice_size;
+
+		uint32_t texture;
+		std::vector<Pixel_Buffer> ring;
+
+		bool
+		setSource(const unsigned char* data, size_t size, int width, int height, int depth, Texture_Format format);
+
+		void
+		release();
+
+		void
+		releaseRing();
+	};
+} // namespace gfx
\ No newline at end of file